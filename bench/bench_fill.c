@@ -0,0 +1,82 @@
+/*
+ * @file bench_fill.c
+ * @brief Fill-rate benchmark for the fbDraw span primitives.
+ *
+ * Measures Mpixel/s of full-screen clears, large boxes and outlines on
+ * off-screen 16bpp and 32bpp framebuffers, next to the per-pixel
+ * fb_drawPixel loop the primitives used to be built on.
+ *
+ * usage: bench_fill [iterations]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "fbDraw.h"
+#include "util.h"
+
+#define PANEL_W 1920
+#define PANEL_H 1080
+
+static void report(const char *name, int bpp, double ms, double pixels)
+{
+  printf("%-22s %4d %12.3f %12.1f\n", name, bpp, ms, pixels / (ms * 1e3));
+}
+
+int main(int argc, char **argv)
+{
+  int iters = (argc > 1) ? atoi(argv[1]) : 100;
+  if (iters < 1)
+    iters = 1;
+
+  printf("# panel %dx%d, %d iterations\n", PANEL_W, PANEL_H, iters);
+  printf("%-22s %4s %12s %12s\n", "primitive", "bpp", "ms/op", "Mpix/s");
+
+  const int bpps[] = {16, 32};
+  for (size_t k = 0; k < sizeof(bpps) / sizeof(bpps[0]); ++k)
+  {
+    dev_fb fb;
+    if (fb_initMemory(&fb, PANEL_W, PANEL_H, bpps[k]) != 0)
+    {
+      fprintf(stderr, "fb_initMemory %dbpp failed\n", bpps[k]);
+      continue;
+    }
+    double t0, ms;
+
+    // 기준: 예전 구현과 같은 fb_drawPixel 반복
+    t0 = now_ms();
+    for (int i = 0; i < iters; ++i)
+      for (int y = 0; y < PANEL_H; y++)
+        for (int x = 0; x < PANEL_W; x++)
+          fb_drawPixel(&fb, x, y, (char)i, 64, (char)200);
+    ms = (now_ms() - t0) / iters;
+    report("drawPixel full screen", bpps[k], ms, (double)PANEL_W * PANEL_H);
+
+    t0 = now_ms();
+    for (int i = 0; i < iters; ++i)
+      fb_fillScr(&fb, 0, 0, 0);
+    ms = (now_ms() - t0) / iters;
+    report("fillScr black", bpps[k], ms, (double)PANEL_W * PANEL_H);
+
+    t0 = now_ms();
+    for (int i = 0; i < iters; ++i)
+      fb_fillScr(&fb, (char)i, 64, (char)200);
+    ms = (now_ms() - t0) / iters;
+    report("fillScr color", bpps[k], ms, (double)PANEL_W * PANEL_H);
+
+    t0 = now_ms();
+    for (int i = 0; i < iters; ++i)
+      fb_fillBox(&fb, fb_toPixel(101, 77), 1200, 700, (char)i, 64, (char)200);
+    ms = (now_ms() - t0) / iters;
+    report("fillBox 1200x700", bpps[k], ms, 1200.0 * 700);
+
+    t0 = now_ms();
+    for (int i = 0; i < iters; ++i)
+      fb_drawBox(&fb, fb_toPixel(-50, 10), 2000, 900, (char)i, 64, (char)200);
+    ms = (now_ms() - t0) / iters;
+    report("drawBox 2000x900 clip", bpps[k], ms, 2.0 * (1920 + 900));
+
+    fb_close(&fb);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+/*
+ * @file bench_io.c
+ * @brief Page cache footprint and write cost of the .tbb data paths.
+ *
+ * Appends a recording of fixed-size records with the recorder's sync policy
+ * through buffered writes (one writev per record, or coalesced in batches
+ * of 8 as the recorder does when frames queue up), buffered writes with
+ * POSIX_FADV_DONTNEED after each sync, and O_DIRECT with several write
+ * sizes. Reports throughput, append latency and how much of the file is
+ * still in the page cache at the end (mincore), i.e. how much of everything
+ * else a long recording evicts.
+ *
+ * usage: bench_io [records] [record KB] [path]
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "container.h"
+#include "util.h"
+
+typedef struct Mode
+{
+  const char *name;
+  TbbIoMode io;
+  size_t write_size;
+  int batch; // records per tbb_writer_begin_batch() .. end_batch()
+} Mode;
+
+// 파일 중 page cache 에 올라 있는 byte 수
+static double cached_mb(const char *path)
+{
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) < 0 || st.st_size == 0)
+  {
+    if (fd >= 0)
+      close(fd);
+    return 0;
+  }
+  long page = sysconf(_SC_PAGESIZE);
+  size_t pages = ((size_t)st.st_size + page - 1) / page;
+  void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  unsigned char *vec = malloc(pages);
+  size_t resident = 0;
+  if (map != MAP_FAILED && vec && mincore(map, (size_t)st.st_size, vec) == 0)
+    for (size_t i = 0; i < pages; i++)
+      resident += vec[i] & 1;
+  free(vec);
+  if (map != MAP_FAILED)
+    munmap(map, (size_t)st.st_size);
+  close(fd);
+  return resident * (double)page / 1e6;
+}
+
+static int run(const Mode *m, int records, const uint8_t *payload, uint32_t size, const char *path,
+               uint64_t *lat)
+{
+  // 이전 실행이 남긴 cache 를 비우고 시작
+  unlink(path);
+  TbbWriter wr;
+  if (tbb_writer_open(&wr, path, 1920, 1080, 1, 33333) < 0)
+  {
+    perror("tbb_writer_open");
+    return -1;
+  }
+  if (tbb_writer_set_io(&wr, m->io, m->write_size) < 0)
+  {
+    printf("%-18s unsupported here (%s)\n", m->name, strerror(errno));
+    tbb_writer_close(&wr);
+    return 0;
+  }
+  TbbSyncPolicy policy = {.every_frames = 30, .every_ms = 1000, .background = true};
+  tbb_writer_set_sync(&wr, &policy);
+
+  uint64_t t0 = now_ns();
+  for (int i = 0; i < records; i++)
+  {
+    uint64_t t = now_ns();
+    if (m->batch > 1 && i % m->batch == 0)
+      tbb_writer_begin_batch(&wr);
+    int ret = tbb_writer_append(&wr, (uint64_t)i, TBB_CODEC_RAW, 0, 0, payload, size);
+    if (ret == 0 && m->batch > 1 && (i % m->batch == m->batch - 1 || i == records - 1))
+      ret = tbb_writer_end_batch(&wr);
+    if (ret < 0)
+    {
+      perror("tbb_writer_append");
+      tbb_writer_close(&wr);
+      return -1;
+    }
+    lat[i] = now_ns() - t;
+  }
+  tbb_writer_close(&wr);
+  double sec = (now_ns() - t0) / 1e9;
+
+  qsort(lat, (size_t)records, sizeof(*lat), cmp_u64);
+  printf("%-18s %9.1f %9.3f %9.3f %9.3f %10.1f\n", m->name, (double)records * size / 1e6 / sec,
+         lat[records / 2] / 1e6, lat[(size_t)records * 99 / 100] / 1e6, lat[records - 1] / 1e6,
+         cached_mb(path));
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  int records = (argc > 1) ? atoi(argv[1]) : 600;
+  uint32_t size = (uint32_t)((argc > 2) ? atoi(argv[2]) : 300) * 1024u;
+  const char *path = (argc > 3) ? argv[3] : "/var/tmp/bench_io.tbb";
+  if (records < 1)
+    records = 1;
+
+  uint8_t *payload = malloc(size ? size : 1);
+  uint64_t *lat = malloc((size_t)records * sizeof(*lat));
+  if (!payload || !lat)
+  {
+    perror("malloc");
+    return EXIT_FAILURE;
+  }
+  for (uint32_t i = 0; i < size; i++)
+    payload[i] = (uint8_t)(i * 131u >> 3);
+
+  const Mode modes[] = {
+      {"buffered", TBB_IO_BUFFERED, 0, 1},
+      {"buffered batch 8", TBB_IO_BUFFERED, 0, 8},
+      {"fadvise dontneed", TBB_IO_DONTNEED, 0, 1},
+      {"dontneed batch 8", TBB_IO_DONTNEED, 0, 8},
+      {"direct 256K", TBB_IO_DIRECT, 256u << 10, 1},
+      {"direct 1M", TBB_IO_DIRECT, 1u << 20, 1},
+      {"direct 4M", TBB_IO_DIRECT, 4u << 20, 1},
+  };
+
+  printf("# %d records of %u KB (%.0f MB), sync every 30 records in background, %s\n", records,
+         size / 1024, (double)records * size / 1e6, path);
+  printf("%-18s %9s %9s %9s %9s %10s\n", "mode", "MB/s", "p50 ms", "p99 ms", "max ms",
+         "cached MB");
+  for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+    if (run(&modes[i], records, payload, size, path, lat) < 0)
+      return EXIT_FAILURE;
+
+  unlink(path);
+  char idx[4096];
+  snprintf(idx, sizeof(idx), "%s%s", path, TBB_INDEX_SUFFIX);
+  unlink(idx);
+  free(lat);
+  free(payload);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,548 @@
+/*
+ * @file bench_micro.c
+ * @brief Micro-benchmarks for the Queue, FramePool, MemoryPool and fbDraw primitives.
+ *
+ * Every case runs a calibrated number of operations per repetition: the
+ * warm-up doubles the count until one repetition takes at least the minimum
+ * time, then that count is timed for each repetition. The result of a case
+ * is the per-operation time over the repetitions (min, median, mean, p90,
+ * max, standard deviation), written as CSV or JSON on stdout so two builds
+ * can be compared before pool or queue changes go in.
+ *
+ * Cases:
+ *   queue_pingpong  one item bounced between two threads (round trip)
+ *   queue_stream    producer → consumer through one queue, per item
+ *   fp_contention   fp_alloc + fp_release from 1..N threads, per pair
+ *   mp_alloc        mp_alloc + mp_release, per pair
+ *   malloc          malloc + free of the same size, per pair
+ *   fb_drawGray     one gray frame scaled onto an off-screen panel
+ *   fb_printStr     one overlay line of text
+ *   fb_drawBox      a motion box outline
+ *   fb_fillBox      a filled menu box
+ *
+ * usage: bench_micro [-f csv|json] [-r reps] [-w warmup] [-m min_ms] [-t max_threads] [filter]
+ */
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fbDraw.h"
+#include "frame_pool.h"
+#include "memory_pool.h"
+#include "queue.h"
+#include "thread_arg.h"
+#include "util.h"
+
+#define MAX_REPS 1000
+#define MAX_ITERS (1l << 30)
+
+typedef struct Options
+{
+  bool json;
+  int reps;
+  int warmup;
+  double min_ms;
+  int max_threads;
+  const char *filter;
+} Options;
+
+/**
+ * 한 case: @c run 이 op 을 iters 번 하고 걸린 ns 를 돌려준다 (-1: 실패).
+ * 준비가 필요한 case 는 ctx 에 미리 만들어 두고 시간 밖에서 정리한다.
+ */
+typedef struct Case
+{
+  const char *name;
+  char params[64];
+  int threads;
+  double (*run)(void *ctx, long iters);
+  void *ctx;
+} Case;
+
+static const Options *g_opt;
+static int g_printed;
+
+static int cmp_double(const void *a, const void *b)
+{
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/* ─── Queue ───────────────────────────────────────────── */
+
+typedef struct QueueCtx
+{
+  size_t capacity;
+  Queue *in;  // 측정 thread → 상대 thread
+  Queue *out; // 상대 thread → 측정 thread (ping-pong 에서만)
+} QueueCtx;
+
+static void *echo_thread(void *arg)
+{
+  QueueCtx *q = arg;
+  void *item;
+  while ((item = dequeue_wait(q->in, QUEUE_WAIT_FOREVER)) != NULL)
+    enqueue_wait(q->out, item, QUEUE_WAIT_FOREVER);
+  return NULL;
+}
+
+static void *sink_thread(void *arg)
+{
+  QueueCtx *q = arg;
+  void *items[QUEUE_SIZE];
+  size_t max = q->capacity < QUEUE_SIZE ? q->capacity : QUEUE_SIZE;
+  while (dequeue_n(q->in, items, max, QUEUE_WAIT_FOREVER) > 0)
+    ;
+  return NULL;
+}
+
+static double run_pingpong(void *arg, long iters)
+{
+  QueueCtx *q = arg;
+  void *token = q;
+  q->in = queue_init(q->capacity);
+  q->out = queue_init(q->capacity);
+  if (!q->in || !q->out)
+    return -1;
+
+  pthread_t tid;
+  pthread_create(&tid, NULL, echo_thread, q);
+  // 첫 왕복으로 상대 thread 가 돌기 시작한 뒤부터 잰다
+  enqueue_wait(q->in, token, QUEUE_WAIT_FOREVER);
+  dequeue_wait(q->out, QUEUE_WAIT_FOREVER);
+
+  uint64_t t0 = now_ns();
+  for (long i = 0; i < iters; i++)
+  {
+    enqueue_wait(q->in, token, QUEUE_WAIT_FOREVER);
+    dequeue_wait(q->out, QUEUE_WAIT_FOREVER);
+  }
+  uint64_t t1 = now_ns();
+
+  queue_set_done(q->in);
+  pthread_join(tid, NULL);
+  queue_destroy(q->in);
+  queue_destroy(q->out);
+  return (double)(t1 - t0);
+}
+
+static double run_stream(void *arg, long iters)
+{
+  QueueCtx *q = arg;
+  void *token = q;
+  q->in = queue_init(q->capacity);
+  if (!q->in)
+    return -1;
+
+  pthread_t tid;
+  pthread_create(&tid, NULL, sink_thread, q);
+  uint64_t t0 = now_ns();
+  for (long i = 0; i < iters; i++)
+    enqueue_wait(q->in, token, QUEUE_WAIT_FOREVER);
+  queue_set_done(q->in);
+  pthread_join(tid, NULL); // 소비자가 다 받을 때까지 포함
+  uint64_t t1 = now_ns();
+
+  queue_destroy(q->in);
+  return (double)(t1 - t0);
+}
+
+/* ─── FramePool ───────────────────────────────────────── */
+
+typedef struct PoolCtx
+{
+  FramePool *fp;
+  int threads;
+  long per_thread;
+  pthread_barrier_t start;
+  atomic_int failed;
+} PoolCtx;
+
+static void *pool_worker(void *arg)
+{
+  PoolCtx *p = arg;
+  pthread_barrier_wait(&p->start);
+  for (long i = 0; i < p->per_thread; i++)
+  {
+    FrameBlock *blk = fp_alloc(p->fp, 1);
+    if (!blk)
+    {
+      atomic_store(&p->failed, 1);
+      break;
+    }
+    fp_release(p->fp, blk);
+  }
+  return NULL;
+}
+
+static double run_fp_contention(void *arg, long iters)
+{
+  PoolCtx *p = arg;
+  pthread_t tid[64];
+  p->per_thread = iters / p->threads > 0 ? iters / p->threads : 1;
+  atomic_store(&p->failed, 0);
+  pthread_barrier_init(&p->start, NULL, (unsigned)p->threads + 1);
+  for (int i = 0; i < p->threads; i++)
+    pthread_create(&tid[i], NULL, pool_worker, p);
+
+  pthread_barrier_wait(&p->start);
+  uint64_t t0 = now_ns();
+  for (int i = 0; i < p->threads; i++)
+    pthread_join(tid[i], NULL);
+  uint64_t t1 = now_ns();
+  pthread_barrier_destroy(&p->start);
+  if (atomic_load(&p->failed))
+    return -1;
+  // 전체 op 수가 iters 와 다를 수 있으므로 iters 기준으로 환산
+  return (double)(t1 - t0) * (double)iters / (double)(p->per_thread * p->threads);
+}
+
+/* ─── MemoryPool / malloc ─────────────────────────────── */
+
+typedef struct AllocCtx
+{
+  MemoryPool *mp;
+  size_t size;
+} AllocCtx;
+
+static double run_mp_alloc(void *arg, long iters)
+{
+  AllocCtx *a = arg;
+  uint64_t t0 = now_ns();
+  for (long i = 0; i < iters; i++)
+  {
+    MemoryBlock *blk = mp_alloc(a->mp, 1);
+    if (!blk)
+      return -1;
+    ((volatile unsigned char *)blk->data)[0] = (unsigned char)i;
+    mp_release(a->mp, blk);
+  }
+  return (double)(now_ns() - t0);
+}
+
+static double run_malloc(void *arg, long iters)
+{
+  AllocCtx *a = arg;
+  uint64_t t0 = now_ns();
+  for (long i = 0; i < iters; i++)
+  {
+    // 첫 byte 를 써서 컴파일러가 malloc/free 쌍을 없애지 못하게 한다
+    unsigned char *volatile p = malloc(a->size);
+    if (!p)
+      return -1;
+    p[0] = (unsigned char)i;
+    free(p);
+  }
+  return (double)(now_ns() - t0);
+}
+
+/* ─── fbDraw ──────────────────────────────────────────── */
+
+typedef struct DrawCtx
+{
+  dev_fb fb;
+  ubyte *gray;
+  int src_w;
+  int src_h;
+} DrawCtx;
+
+static double run_draw_gray(void *arg, long iters)
+{
+  DrawCtx *d = arg;
+  uint64_t t0 = now_ns();
+  for (long i = 0; i < iters; i++)
+    if (fb_drawGray(&d->fb, d->gray, d->src_w, d->src_h) != 0)
+      return -1;
+  return (double)(now_ns() - t0);
+}
+
+static double run_print_str(void *arg, long iters)
+{
+  DrawCtx *d = arg;
+  uint64_t t0 = now_ns();
+  for (long i = 0; i < iters; i++)
+  {
+    pixel cursor = {10, 10};
+    fb_printStr(&d->fb, "REC 2025-04-07 12:34:56 CAM0", &cursor, (short)d->src_h, 255, 255, 255);
+  }
+  return (double)(now_ns() - t0);
+}
+
+static double run_draw_box(void *arg, long iters)
+{
+  DrawCtx *d = arg;
+  uint64_t t0 = now_ns();
+  for (long i = 0; i < iters; i++)
+    fb_drawBox(&d->fb, (pixel){40, 40}, d->src_w, d->src_h, 255, 0, 0);
+  return (double)(now_ns() - t0);
+}
+
+static double run_fill_box(void *arg, long iters)
+{
+  DrawCtx *d = arg;
+  uint64_t t0 = now_ns();
+  for (long i = 0; i < iters; i++)
+    fb_fillBox(&d->fb, (pixel){40, 40}, d->src_w, d->src_h, 0, 0, 64);
+  return (double)(now_ns() - t0);
+}
+
+/* ─── Harness ─────────────────────────────────────────── */
+
+static void print_header(void)
+{
+  if (g_opt->json)
+    printf("{\"bench\":\"micro\",\"reps\":%d,\"min_ms\":%.1f,\"results\":[", g_opt->reps,
+           g_opt->min_ms);
+  else
+    printf("case,params,threads,iters,reps,min_ns,median_ns,mean_ns,p90_ns,max_ns,stddev_ns\n");
+}
+
+static void print_footer(void)
+{
+  if (g_opt->json)
+    printf("\n]}\n");
+}
+
+static int run_case(Case *c)
+{
+  if (g_opt->filter && !strstr(c->name, g_opt->filter))
+    return 0;
+  fprintf(stderr, "bench_micro: %s %s x%d\n", c->name, c->params, c->threads);
+
+  // warm-up: 한 repetition 이 min_ms 를 넘을 때까지 op 수를 두 배로
+  long iters = 1;
+  for (int w = 0;; w++)
+  {
+    double ns = c->run(c->ctx, iters);
+    if (ns < 0)
+    {
+      fprintf(stderr, "%s:%d in %s() → %s %s failed\n", __FILE__, __LINE__, __func__, c->name,
+              c->params);
+      return -1;
+    }
+    if (ns >= g_opt->min_ms * 1e6 || iters >= MAX_ITERS)
+    {
+      if (w + 1 >= g_opt->warmup)
+        break;
+    }
+    else
+      iters *= 2;
+  }
+
+  double sample[MAX_REPS];
+  double sum = 0;
+  for (int r = 0; r < g_opt->reps; r++)
+  {
+    double ns = c->run(c->ctx, iters);
+    if (ns < 0)
+      return -1;
+    sample[r] = ns / (double)iters;
+    sum += sample[r];
+  }
+  int n = g_opt->reps;
+  double mean = sum / n, var = 0;
+  for (int r = 0; r < n; r++)
+    var += (sample[r] - mean) * (sample[r] - mean);
+  double stddev = n > 1 ? sqrt(var / (n - 1)) : 0;
+  qsort(sample, (size_t)n, sizeof(double), cmp_double);
+  double median = (n % 2) ? sample[n / 2] : (sample[n / 2 - 1] + sample[n / 2]) / 2;
+  double p90 = sample[(n * 9 + 9) / 10 - 1];
+
+  if (g_opt->json)
+    printf("%s\n{\"case\":\"%s\",\"params\":\"%s\",\"threads\":%d,\"iters\":%ld,\"reps\":%d,"
+           "\"min_ns\":%.1f,\"median_ns\":%.1f,\"mean_ns\":%.1f,\"p90_ns\":%.1f,\"max_ns\":%.1f,"
+           "\"stddev_ns\":%.1f}",
+           g_printed ? "," : "", c->name, c->params, c->threads, iters, n, sample[0], median,
+           mean, p90, sample[n - 1], stddev);
+  else
+    printf("%s,%s,%d,%ld,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n", c->name, c->params, c->threads,
+           iters, n, sample[0], median, mean, p90, sample[n - 1], stddev);
+  fflush(stdout);
+  g_printed++;
+  return 0;
+}
+
+static int bench_queue(void)
+{
+  const size_t caps[] = {1, QUEUE_SIZE};
+  for (size_t i = 0; i < sizeof(caps) / sizeof(caps[0]); i++)
+  {
+    QueueCtx q = {.capacity = caps[i]};
+    Case pp = {.name = "queue_pingpong", .threads = 2, .run = run_pingpong, .ctx = &q};
+    Case st = {.name = "queue_stream", .threads = 2, .run = run_stream, .ctx = &q};
+    snprintf(pp.params, sizeof(pp.params), "capacity=%zu", caps[i]);
+    snprintf(st.params, sizeof(st.params), "capacity=%zu", caps[i]);
+    if (run_case(&pp) < 0 || run_case(&st) < 0)
+      return -1;
+  }
+  return 0;
+}
+
+static int bench_frame_pool(void)
+{
+  // 각 thread 는 block 을 하나씩만 잡으므로 pool 이 바닥나지는 않는다: lock 경합만 잰다
+  FramePool *fp = frame_pool_create(POOL_SIZE > 64 ? POOL_SIZE : 64, 640, 480, GRAY);
+  if (!fp)
+  {
+    perror("frame_pool_create");
+    return -1;
+  }
+  int ret = 0;
+  for (int t = 1; t <= g_opt->max_threads && ret == 0; t *= 2)
+  {
+    PoolCtx p = {.fp = fp, .threads = t};
+    Case c = {.name = "fp_contention", .threads = t, .run = run_fp_contention, .ctx = &p};
+    snprintf(c.params, sizeof(c.params), "blocks=%zu", fp->pool_size);
+    ret = run_case(&c);
+  }
+  frame_pool_free(fp);
+  return ret;
+}
+
+static int bench_alloc(void)
+{
+  const size_t sizes[] = {64, 4096, (size_t)640 * 480, (size_t)1920 * 1080};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+  {
+    AllocCtx a = {.mp = mp_create(POOL_SIZE, sizes[i]), .size = sizes[i]};
+    if (!a.mp)
+    {
+      perror("mp_create");
+      return -1;
+    }
+    Case mp = {.name = "mp_alloc", .threads = 1, .run = run_mp_alloc, .ctx = &a};
+    Case ma = {.name = "malloc", .threads = 1, .run = run_malloc, .ctx = &a};
+    snprintf(mp.params, sizeof(mp.params), "size=%zu", sizes[i]);
+    snprintf(ma.params, sizeof(ma.params), "size=%zu", sizes[i]);
+    int ret = (run_case(&mp) < 0 || run_case(&ma) < 0) ? -1 : 0;
+    mp_free(a.mp);
+    if (ret < 0)
+      return -1;
+  }
+  return 0;
+}
+
+static int bench_draw(void)
+{
+  const struct
+  {
+    int w, h, bpp;
+  } panels[] = {{800, 480, 16}, {1280, 720, 32}, {1920, 1080, 32}};
+  const struct
+  {
+    int w, h;
+  } sources[] = {{640, 480}, {1920, 1080}};
+
+  ubyte *gray = malloc((size_t)1920 * 1080);
+  if (!gray)
+  {
+    perror("malloc");
+    return -1;
+  }
+  for (int y = 0; y < 1080; y++)
+    for (int x = 0; x < 1920; x++)
+      gray[(size_t)y * 1920 + x] = (ubyte)(x + y);
+
+  int ret = 0;
+  for (size_t p = 0; p < sizeof(panels) / sizeof(panels[0]) && ret == 0; p++)
+  {
+    DrawCtx d = {.gray = gray};
+    if (fb_initMemory(&d.fb, panels[p].w, panels[p].h, panels[p].bpp) != 0)
+    {
+      perror("fb_initMemory");
+      ret = -1;
+      break;
+    }
+    for (size_t s = 0; s < sizeof(sources) / sizeof(sources[0]) && ret == 0; s++)
+    {
+      d.src_w = sources[s].w;
+      d.src_h = sources[s].h;
+      Case c = {.name = "fb_drawGray", .threads = 1, .run = run_draw_gray, .ctx = &d};
+      snprintf(c.params, sizeof(c.params), "%dx%d->%dx%dx%d", d.src_w, d.src_h, panels[p].w,
+               panels[p].h, panels[p].bpp);
+      ret = run_case(&c);
+    }
+
+    const short heights[] = {16, 32};
+    for (size_t h = 0; h < sizeof(heights) / sizeof(heights[0]) && ret == 0; h++)
+    {
+      d.src_h = heights[h];
+      Case c = {.name = "fb_printStr", .threads = 1, .run = run_print_str, .ctx = &d};
+      snprintf(c.params, sizeof(c.params), "h=%d,28ch,%dbpp", heights[h], panels[p].bpp);
+      ret = run_case(&c);
+    }
+
+    d.src_w = 200;
+    d.src_h = 120;
+    Case box = {.name = "fb_drawBox", .threads = 1, .run = run_draw_box, .ctx = &d};
+    Case fill = {.name = "fb_fillBox", .threads = 1, .run = run_fill_box, .ctx = &d};
+    snprintf(box.params, sizeof(box.params), "200x120,%dbpp", panels[p].bpp);
+    snprintf(fill.params, sizeof(fill.params), "200x120,%dbpp", panels[p].bpp);
+    if (ret == 0 && (run_case(&box) < 0 || run_case(&fill) < 0))
+      ret = -1;
+    fb_close(&d.fb);
+  }
+  free(gray);
+  return ret;
+}
+
+int main(int argc, char **argv)
+{
+  long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+  Options opt = {
+      .reps = 15,
+      .warmup = 2,
+      .min_ms = 10,
+      .max_threads = ncpu > 4 ? (int)ncpu : 4, // 1 CPU 에서도 경합은 보이게
+  };
+  int c;
+  while ((c = getopt(argc, argv, "f:r:w:m:t:")) != -1)
+  {
+    switch (c)
+    {
+    case 'f':
+      opt.json = !strcmp(optarg, "json");
+      break;
+    case 'r':
+      opt.reps = atoi(optarg);
+      break;
+    case 'w':
+      opt.warmup = atoi(optarg);
+      break;
+    case 'm':
+      opt.min_ms = atof(optarg);
+      break;
+    case 't':
+      opt.max_threads = atoi(optarg);
+      break;
+    default:
+      fprintf(stderr,
+              "usage: %s [-f csv|json] [-r reps] [-w warmup] [-m min_ms] [-t max_threads] "
+              "[filter]\n",
+              argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (optind < argc)
+    opt.filter = argv[optind];
+  if (opt.reps < 1 || opt.reps > MAX_REPS)
+    opt.reps = 15;
+  if (opt.warmup < 1)
+    opt.warmup = 1;
+  if (opt.min_ms <= 0)
+    opt.min_ms = 10;
+  if (opt.max_threads < 1 || opt.max_threads > 64)
+    opt.max_threads = 4;
+  g_opt = &opt;
+
+  print_header();
+  int ret = bench_queue() == 0 && bench_frame_pool() == 0 && bench_alloc() == 0 &&
+            bench_draw() == 0;
+  print_footer();
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,124 @@
+/*
+ * @file bench_mosaic.c
+ * @brief Mosaic refresh cost for N 1080p streams on a 1080p panel.
+ *
+ * Composes N synthetic 1920x1080 streams into a two-page off-screen
+ * 1920x1080 XRGB panel, with every tile getting a new frame each refresh
+ * (worst case) and with only one tile changing, for 1..max worker threads
+ * and each scaling filter. Reports ms per refresh and the refresh rate that
+ * leaves; 30 FPS needs less than 33.3 ms.
+ *
+ * usage: bench_mosaic [streams] [max_threads] [refreshes]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mosaic.h"
+#include "util.h"
+
+#define SRC_W 1920
+#define SRC_H 1080
+#define PANEL_W 1920
+#define PANEL_H 1080
+
+// changing: 매 refresh 새 frame 을 받는 tile 수
+static double run(dev_fb *panel, int streams, ThreadPool *pool, ScaleMode mode, int changing,
+                  uint8_t *const *frames, int refreshes)
+{
+  Mosaic *m = mosaic_create(panel, streams, mode, pool);
+  if (!m)
+  {
+    perror("mosaic_create");
+    return -1;
+  }
+  // 첫 refresh 는 scaler table 을 만들므로 재지 않는다
+  for (int s = 0; s < streams; s++)
+    mosaic_set_frame(m, s, frames[s], SRC_W, SRC_H);
+  mosaic_compose(m, panel);
+
+  double t0 = now_ms();
+  for (int r = 0; r < refreshes; r++)
+  {
+    for (int s = 0; s < changing; s++)
+      mosaic_set_frame(m, (r + s) % streams, frames[(r + s) % streams], SRC_W, SRC_H);
+    if (mosaic_compose(m, panel) < 0 || mosaic_present(m, panel) < 0)
+    {
+      perror("mosaic_compose");
+      mosaic_destroy(m);
+      return -1;
+    }
+  }
+  double ms = (now_ms() - t0) / refreshes;
+  mosaic_destroy(m);
+  return ms;
+}
+
+int main(int argc, char **argv)
+{
+  long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+  int streams = (argc > 1) ? atoi(argv[1]) : 4;
+  int max_threads = (argc > 2) ? atoi(argv[2]) : (int)(ncpu > 0 ? ncpu : 1);
+  int refreshes = (argc > 3) ? atoi(argv[3]) : 60;
+  if (streams < 1 || streams > MOSAIC_MAX_TILES)
+    streams = 4;
+  if (max_threads < 1)
+    max_threads = 1;
+  if (refreshes < 1)
+    refreshes = 1;
+
+  uint8_t *frames[MOSAIC_MAX_TILES];
+  for (int s = 0; s < streams; s++)
+  {
+    frames[s] = malloc((size_t)SRC_W * SRC_H);
+    if (!frames[s])
+    {
+      perror("malloc");
+      return EXIT_FAILURE;
+    }
+    for (int y = 0; y < SRC_H; y++)
+      for (int x = 0; x < SRC_W; x++)
+        frames[s][(size_t)y * SRC_W + x] = (uint8_t)(x + y + 40 * s);
+  }
+
+  // pan 가능한 panel 처럼 page 두 장
+  dev_fb panel;
+  if (fb_initMemory(&panel, PANEL_W, 2 * PANEL_H, 32) != 0)
+  {
+    perror("fb_initMemory");
+    return EXIT_FAILURE;
+  }
+  panel.vinfo.yres = PANEL_H;
+
+  const struct
+  {
+    const char *name;
+    ScaleMode mode;
+  } modes[] = {{"nearest", SCALE_NEAREST}, {"bilinear", SCALE_BILINEAR}, {"area", SCALE_AREA}};
+
+  printf("# %d x %dx%d streams → %dx%d panel, %d refreshes\n", streams, SRC_W, SRC_H, PANEL_W,
+         PANEL_H, refreshes);
+  printf("%-9s %7s %14s %9s %14s %9s\n", "filter", "threads", "all tiles ms", "max fps",
+         "one tile ms", "max fps");
+  for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+  {
+    for (int t = 1; t <= max_threads; t *= 2)
+    {
+      // 호출자도 chunk 를 돌리므로 worker 는 t - 1 개
+      ThreadPool *pool = (t > 1) ? tp_create((size_t)(t - 1)) : NULL;
+      double all = run(&panel, streams, pool, modes[i].mode, streams, frames, refreshes);
+      double one = run(&panel, streams, pool, modes[i].mode, 1, frames, refreshes);
+      tp_destroy(pool);
+      if (all < 0 || one < 0)
+        return EXIT_FAILURE;
+      printf("%-9s %7d %14.2f %9.0f %14.2f %9.0f\n", modes[i].name, t, all, 1e3 / all, one,
+             1e3 / one);
+    }
+  }
+
+  fb_close(&panel);
+  for (int s = 0; s < streams; s++)
+    free(frames[s]);
+  return EXIT_SUCCESS;
+}
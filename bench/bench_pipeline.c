@@ -0,0 +1,323 @@
+/*
+ * @file bench_pipeline.c
+ * @brief End-to-end capture → queue → display / record throughput and latency.
+ *
+ * Runs the pipeline stages on their own threads the way the application
+ * wires them: an unthrottled synthetic capture source fills FramePool
+ * blocks and hands each one to a display queue and a record queue; the
+ * display stage scales it into an off-screen 1920x1080 panel with the band
+ * renderer, the record stage drains its queue in batches into the slice
+ * encoder and a .tbb writer with the recorder's sync and I/O settings. Every
+ * frame is stored (no change gate), so the record side sees the worst case.
+ *
+ * For each resolution, pool size and queue depth the run reports frames/s,
+ * CPU time per stage thread (encoder and sync workers under "other"),
+ * latency from the moment capture starts a frame until both consumers are
+ * done with it (p50/p99/max), pool stalls, bytes written and the per-frame
+ * perf_event_open counters of each stage thread (perfctr.h), as one JSON
+ * document on stdout so two versions can be diffed.
+ *
+ * usage: bench_pipeline [frames] [path]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "display.h"
+#include "record.h"
+#include "synth.h"
+#include "util.h"
+
+#define PANEL_W 1920
+#define PANEL_H 1080
+
+typedef struct Config
+{
+  int width;
+  int height;
+  size_t pool;
+  size_t queue;
+} Config;
+
+typedef struct Run
+{
+  const Config *cfg;
+  int frames;
+  const char *path;
+  FramePool *pool;
+  Queue *display_q;
+  Queue *record_q;
+  SynthSource *src;
+  dev_fb panel;
+  BandRenderer *renderer;
+  uint64_t *t_cap;  // capture 가 frame 을 시작한 시각
+  uint64_t *t_disp; // display 가 그린 시각
+  uint64_t *t_rec;  // record 가 writer 에 넘긴 시각
+  uint64_t cpu_ns[3];
+  PerfStage perf[3]; // stage thread 별 counter (perfctr.h)
+  uint64_t bytes;
+  int failed;
+} Run;
+
+enum
+{
+  STAGE_CAPTURE,
+  STAGE_DISPLAY,
+  STAGE_RECORD
+};
+
+static void *capture_stage(void *arg)
+{
+  Run *run = arg;
+  PerfStage *perf = &run->perf[STAGE_CAPTURE];
+  perf_stage_open(perf, "capture");
+  for (int seq = 0; seq < run->frames; seq++)
+  {
+    run->t_cap[seq] = now_ns();
+    FrameBlock *fb = fp_alloc(run->pool, 2);
+    if (!fb)
+    {
+      run->failed = 1;
+      break;
+    }
+    perf_stage_begin(perf);
+    synth_render(run->src, (uint64_t)seq, fb->frame.data);
+    perf_stage_end(perf, 1);
+    fb->frame.seq = (size_t)seq;
+    if (enqueue_wait(run->display_q, fb, QUEUE_WAIT_FOREVER) < 0)
+      fp_release(run->pool, fb);
+    if (enqueue_wait(run->record_q, fb, QUEUE_WAIT_FOREVER) < 0)
+      fp_release(run->pool, fb);
+  }
+  queue_set_done(run->display_q);
+  queue_set_done(run->record_q);
+  perf_stage_close(perf);
+  run->cpu_ns[STAGE_CAPTURE] = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+  return NULL;
+}
+
+static void *display_stage(void *arg)
+{
+  Run *run = arg;
+  PerfStage *perf = &run->perf[STAGE_DISPLAY];
+  FrameBlock *fb;
+  perf_stage_open(perf, "display");
+  while ((fb = dequeue_wait(run->display_q, QUEUE_WAIT_FOREVER)) != NULL)
+  {
+    perf_stage_begin(perf);
+    if (br_draw_gray(run->renderer, &run->panel, fb->frame.data, (int)fb->frame.width,
+                     (int)fb->frame.height) < 0)
+      run->failed = 1;
+    perf_stage_end(perf, 1);
+    run->t_disp[fb->frame.seq] = now_ns();
+    fp_release(run->pool, fb);
+  }
+  perf_stage_close(perf);
+  run->cpu_ns[STAGE_DISPLAY] = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+  return NULL;
+}
+
+static void *record_stage(void *arg)
+{
+  Run *run = arg;
+  const Config *cfg = run->cfg;
+  PerfStage *perf = &run->perf[STAGE_RECORD];
+  TbbWriter writer;
+  FrameEncoder *enc = NULL;
+  FrameBlock *blocks[RECORD_BATCH_MAX];
+  size_t seqs[RECORD_BATCH_MAX];
+
+  unlink(run->path);
+  if (tbb_writer_open(&writer, run->path, (uint32_t)cfg->width, (uint32_t)cfg->height, 1,
+                      RECORD_FRAME_INTERVAL_US) < 0)
+  {
+    perror("tbb_writer_open");
+    run->failed = 1;
+    goto drain;
+  }
+  if (tbb_writer_set_io(&writer, RECORD_IO_MODE, RECORD_IO_WRITE_SIZE) < 0 &&
+      RECORD_IO_MODE == TBB_IO_DIRECT)
+    tbb_writer_set_io(&writer, TBB_IO_DONTNEED, 0);
+  TbbSyncPolicy policy = {
+      .every_frames = RECORD_SYNC_FRAMES,
+      .every_ms = RECORD_SYNC_MS,
+      .writeback = RECORD_SYNC_WRITEBACK,
+      .background = RECORD_SYNC_BACKGROUND,
+  };
+  tbb_writer_set_sync(&writer, &policy);
+  enc = fe_create((size_t)cfg->width, (size_t)cfg->height, RECORD_CODEC ? RECORD_CODEC_SLICES : 0,
+                  RECORD_ENCODE_THREADS, RECORD_ENCODE_INFLIGHT);
+  if (!enc)
+  {
+    perror("fe_create");
+    run->failed = 1;
+    tbb_writer_close(&writer);
+    goto drain;
+  }
+
+  size_t n;
+  perf_stage_open(perf, "record");
+  while ((n = dequeue_n(run->record_q, (void **)blocks, RECORD_BATCH_MAX, QUEUE_WAIT_FOREVER)) > 0)
+  {
+    perf_stage_begin(perf);
+    for (size_t i = 0; i < n; i++)
+    {
+      // release 뒤에는 block 을 읽지 않는다: seq 는 t_rec 기록용으로 남긴다
+      seqs[i] = blocks[i]->frame.seq;
+      bool key = seqs[i] % RECORD_KEY_INTERVAL == 0;
+      if (fe_submit(enc, &writer, blocks[i]->frame.data, seqs[i], 0, 0, key) < 0)
+        run->failed = 1;
+      fp_release(run->pool, blocks[i]);
+    }
+    if (fe_flush(enc, &writer, false) < 0)
+      run->failed = 1;
+    perf_stage_end(perf, (unsigned)n);
+    uint64_t t = now_ns();
+    for (size_t i = 0; i < n; i++)
+      run->t_rec[seqs[i]] = t;
+  }
+  perf_stage_close(perf);
+  fe_flush(enc, &writer, true);
+  fe_destroy(enc);
+  tbb_writer_close(&writer);
+  run->bytes = writer.bytes;
+  run->cpu_ns[STAGE_RECORD] = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+  return NULL;
+
+drain:
+  // capture 가 막히지 않도록 남은 block 은 돌려준다
+  while ((n = dequeue_n(run->record_q, (void **)blocks, RECORD_BATCH_MAX, QUEUE_WAIT_FOREVER)) > 0)
+    for (size_t i = 0; i < n; i++)
+      fp_release(run->pool, blocks[i]);
+  return NULL;
+}
+
+static int run_one(const Config *cfg, int frames, const char *path, bool first)
+{
+  Run run = {.cfg = cfg, .frames = frames, .path = path, .panel = {.fbfd = -1}};
+  int ret = -1;
+  for (int i = 0; i < 3; i++)
+    perf_stage_init(&run.perf[i], NULL);
+
+  SynthConfig sc;
+  synth_config_default(&sc, cfg->width, cfg->height);
+  sc.fps = 0; // 파이프라인이 받는 만큼 빠르게
+  run.src = synth_create(&sc);
+  run.pool = frame_pool_create(cfg->pool, (size_t)cfg->width, (size_t)cfg->height, GRAY);
+  run.display_q = queue_init(cfg->queue);
+  run.record_q = queue_init(cfg->queue);
+  run.renderer = br_create(DISPLAY_RENDER_THREADS, RENDER_MT_MIN_PIXELS);
+  run.t_cap = calloc((size_t)frames, sizeof(uint64_t));
+  run.t_disp = calloc((size_t)frames, sizeof(uint64_t));
+  run.t_rec = calloc((size_t)frames, sizeof(uint64_t));
+  uint64_t *lat = calloc((size_t)frames, sizeof(uint64_t));
+  if (!run.src || !run.pool || !run.display_q || !run.record_q || !run.renderer || !run.t_cap ||
+      !run.t_disp || !run.t_rec || !lat || fb_initMemory(&run.panel, PANEL_W, PANEL_H, 32) != 0)
+  {
+    perror("bench_pipeline setup");
+    goto out;
+  }
+  br_set_scale_mode(run.renderer, DISPLAY_SCALE_MODE);
+
+  uint64_t cpu0 = clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+  uint64_t t0 = now_ns();
+  pthread_t tid[3];
+  pthread_create(&tid[STAGE_RECORD], NULL, record_stage, &run);
+  pthread_create(&tid[STAGE_DISPLAY], NULL, display_stage, &run);
+  pthread_create(&tid[STAGE_CAPTURE], NULL, capture_stage, &run);
+  for (int i = 0; i < 3; i++)
+    pthread_join(tid[i], NULL);
+  double wall_ms = (now_ns() - t0) / 1e6;
+  double cpu_ms = (clock_ns(CLOCK_PROCESS_CPUTIME_ID) - cpu0) / 1e6;
+  if (run.failed)
+  {
+    fprintf(stderr, "bench_pipeline: %dx%d run failed\n", cfg->width, cfg->height);
+    goto out;
+  }
+
+  // frame 하나의 latency: capture 시작 → 두 소비자가 모두 끝낸 때
+  for (int i = 0; i < frames; i++)
+  {
+    uint64_t done = run.t_disp[i] > run.t_rec[i] ? run.t_disp[i] : run.t_rec[i];
+    lat[i] = done - run.t_cap[i];
+  }
+  qsort(lat, (size_t)frames, sizeof(*lat), cmp_u64);
+
+  double stage_ms[3];
+  for (int i = 0; i < 3; i++)
+    stage_ms[i] = run.cpu_ns[i] / 1e6;
+  double other_ms = cpu_ms - stage_ms[0] - stage_ms[1] - stage_ms[2];
+
+  printf("%s\n    {\"width\": %d, \"height\": %d, \"pool\": %zu, \"queue\": %zu, \"frames\": %d, "
+         "\"wall_ms\": %.1f, \"fps\": %.1f,\n"
+         "     \"cpu_ms\": {\"capture\": %.1f, \"display\": %.1f, \"record\": %.1f, "
+         "\"other\": %.1f, \"total\": %.1f},\n"
+         "     \"latency_ms\": {\"p50\": %.2f, \"p99\": %.2f, \"max\": %.2f},\n"
+         "     \"pool_stalls\": %zu, \"bytes_written\": %llu,\n"
+         "     \"counters\": {",
+         first ? "" : ",", cfg->width, cfg->height, cfg->pool, cfg->queue, frames, wall_ms,
+         frames / (wall_ms / 1e3), stage_ms[0], stage_ms[1], stage_ms[2],
+         other_ms > 0 ? other_ms : 0.0, cpu_ms, lat[frames / 2] / 1e6,
+         lat[(size_t)frames * 99 / 100] / 1e6, lat[frames - 1] / 1e6, run.pool->stalls,
+         (unsigned long long)run.bytes);
+  // hardware counter 가 없는 환경에서는 있는 event 만 (아무 것도 없으면 null)
+  const char *stage_names[3] = {"capture", "display", "record"};
+  for (int i = 0; i < 3; i++)
+  {
+    printf("%s\"%s\": ", i ? ", " : "", stage_names[i]);
+    perf_stage_write_json(&run.perf[i], stdout);
+  }
+  printf("}}");
+  fflush(stdout);
+  ret = 0;
+
+out:
+  free(lat);
+  free(run.t_rec);
+  free(run.t_disp);
+  free(run.t_cap);
+  fb_close(&run.panel);
+  br_destroy(run.renderer);
+  queue_destroy(run.record_q);
+  queue_destroy(run.display_q);
+  frame_pool_destroy(run.pool);
+  synth_destroy(run.src);
+  return ret;
+}
+
+int main(int argc, char **argv)
+{
+  int frames = (argc > 1) ? atoi(argv[1]) : 200;
+  const char *path = (argc > 2) ? argv[2] : "/var/tmp/bench_pipeline.tbb";
+  if (frames < 1)
+    frames = 1;
+
+  const int res[][2] = {{640, 480}, {1280, 720}, {1920, 1080}};
+  const size_t pools[] = {4, POOL_SIZE};
+  const size_t queues[] = {2, QUEUE_SIZE};
+  long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+  printf("{\"bench\": \"pipeline\", \"frames\": %d, \"cpus\": %ld, \"panel\": \"%dx%d\", "
+         "\"codec\": %d, \"runs\": [",
+         frames, ncpu, PANEL_W, PANEL_H, RECORD_CODEC);
+  bool first = true;
+  for (size_t r = 0; r < sizeof(res) / sizeof(res[0]); r++)
+    for (size_t p = 0; p < sizeof(pools) / sizeof(pools[0]); p++)
+      for (size_t q = 0; q < sizeof(queues) / sizeof(queues[0]); q++)
+      {
+        Config cfg = {.width = res[r][0], .height = res[r][1], .pool = pools[p], .queue = queues[q]};
+        fprintf(stderr, "bench_pipeline: %dx%d pool %zu queue %zu\n", cfg.width, cfg.height,
+                cfg.pool, cfg.queue);
+        if (run_one(&cfg, frames, path, first) < 0)
+          return EXIT_FAILURE;
+        first = false;
+      }
+  printf("\n]}\n");
+
+  unlink(path);
+  char idx[4096];
+  snprintf(idx, sizeof(idx), "%s%s", path, TBB_INDEX_SUFFIX);
+  unlink(idx);
+  return EXIT_SUCCESS;
+}
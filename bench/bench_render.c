@@ -0,0 +1,105 @@
+/*
+ * @file bench_render.c
+ * @brief Scaling benchmark for banded fb_drawGray across 1..N threads.
+ *
+ * Renders a synthetic 1920x1080 gray frame into off-screen framebuffers of
+ * several panel geometries and reports ms/frame and speedup per thread count
+ * for each scaling filter.
+ *
+ * usage: bench_render [max_threads] [iterations]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "render.h"
+#include "util.h"
+
+#define SRC_W 1920
+#define SRC_H 1080
+
+typedef struct
+{
+  int w;
+  int h;
+  int bpp;
+} Geometry;
+
+int main(int argc, char **argv)
+{
+  long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+  int max_threads = (argc > 1) ? atoi(argv[1]) : (int)(ncpu > 0 ? ncpu : 1);
+  int iters = (argc > 2) ? atoi(argv[2]) : 50;
+  if (max_threads < 1)
+    max_threads = 1;
+  if (max_threads > RENDER_MAX_THREADS)
+    max_threads = RENDER_MAX_THREADS;
+  if (iters < 1)
+    iters = 1;
+
+  const Geometry geoms[] = {
+      {800, 480, 32}, {1280, 720, 16}, {1920, 1080, 32}, {2560, 1440, 32}, {3840, 2160, 32},
+  };
+
+  ubyte *gray = malloc(SRC_W * SRC_H);
+  if (!gray)
+  {
+    perror("malloc");
+    return EXIT_FAILURE;
+  }
+  for (int y = 0; y < SRC_H; y++)
+    for (int x = 0; x < SRC_W; x++)
+      gray[y * SRC_W + x] = (ubyte)(x + y);
+
+  printf("# source %dx%d gray, %d iterations, %ld online CPUs\n", SRC_W, SRC_H, iters, ncpu);
+  printf("%-9s %-12s %4s %8s %12s %10s %10s\n", "filter", "panel", "bpp", "threads", "ms/frame",
+         "Mpix/s", "speedup");
+
+  const ScaleMode modes[] = {SCALE_NEAREST, SCALE_BILINEAR, SCALE_AREA};
+  const char *mode_names[] = {"nearest", "bilinear", "area"};
+
+  for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m)
+  {
+    for (size_t g = 0; g < sizeof(geoms) / sizeof(geoms[0]); ++g)
+    {
+      dev_fb fb;
+      if (fb_initMemory(&fb, geoms[g].w, geoms[g].h, geoms[g].bpp) != 0)
+      {
+        fprintf(stderr, "fb_initMemory %dx%d failed\n", geoms[g].w, geoms[g].h);
+        continue;
+      }
+
+      double base = 0.0;
+      for (int t = 1; t <= max_threads; ++t)
+      {
+        // min_pixels = 0: 작은 패널도 강제로 band 분할해서 측정
+        BandRenderer *br = br_create(t, 0);
+        if (!br)
+        {
+          perror("br_create");
+          break;
+        }
+        br_set_scale_mode(br, modes[m]);
+
+        br_draw_gray(br, &fb, gray, SRC_W, SRC_H); // warm-up
+        double t0 = now_ms();
+        for (int i = 0; i < iters; ++i)
+          br_draw_gray(br, &fb, gray, SRC_W, SRC_H);
+        double ms = (now_ms() - t0) / iters;
+        if (t == 1)
+          base = ms;
+
+        char name[16];
+        snprintf(name, sizeof(name), "%dx%d", geoms[g].w, geoms[g].h);
+        printf("%-9s %-12s %4d %8d %12.3f %10.1f %9.2fx\n", mode_names[m], name, geoms[g].bpp,
+               br_thread_count(br), ms, (double)geoms[g].w * geoms[g].h / (ms * 1e3), base / ms);
+        br_destroy(br);
+      }
+      fb_close(&fb);
+    }
+  }
+
+  free(gray);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+/*
+ * @file adapt.h
+ * @brief Run-time sizing of frame pools and record queues
+ *
+ * Pools are created with room for ADAPT_POOL_MAX blocks per stream but only
+ * a limit of them may be in use (fp_set_limit()); pages of blocks never used
+ * are never touched, so memory follows the limit, not the reservation. A
+ * controller thread looks at each pool every ADAPT_PERIOD_MS:
+ *
+ *  - capture waited for a block, or a record queue reached its share of the
+ *    pool → the limit grows by a quarter at once (recorder write stalls are
+ *    absorbed instead of stalling capture);
+ *  - ADAPT_SHRINK_TICKS quiet periods in a row with the peak use plus
+ *    ADAPT_HEADROOM below the limit → the limit drops by one block and the
+ *    pages of free blocks above it are given back (fp_trim()).
+ *
+ * Each record queue is limited to its stream's share of the pool above a
+ * reserve kept for capture, display and analysis, so a stalled recorder
+ * fills its own queue (and drops, under RECORD_QUEUE_POLICY) before it can
+ * take the blocks the live path needs. Decisions are logged, and a summary is printed on exit.
+ */
+#ifndef ADAPT_H
+#define ADAPT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "frame_pool.h"
+#include "queue.h"
+#include "thread_arg.h"
+
+  /**
+   * @struct AdaptLane
+   * @brief One pool and the record queues that hold its blocks.
+   */
+  typedef struct AdaptLane
+  {
+    FramePool *pool;               /**< Controlled pool */
+    Queue *queues[STREAM_MAX];     /**< Record queues fed from it */
+    size_t last_drops[STREAM_MAX]; /**< queue_drop_count() at the previous tick */
+    int nqueues;                   /**< Entries in @c queues */
+    size_t reserve;                /**< Blocks the queues leave to the rest of the pipeline */
+    size_t min_blocks;             /**< Lowest limit */
+    size_t max_blocks;             /**< Highest limit (reservation and memory budget) */
+    size_t last_stalls;            /**< fp_stall_count() at the previous tick */
+    int calm;                      /**< Quiet ticks in a row */
+    size_t grows;                  /**< Times the limit was raised */
+    size_t shrinks;                /**< Times the limit was lowered */
+    size_t low;                    /**< Lowest limit reached */
+    size_t high;                   /**< Highest limit reached */
+    size_t trimmed;                /**< Bytes given back by fp_trim() */
+  } AdaptLane;
+
+  /**
+   * @struct PoolAdapter
+   * @brief Controller state for every pool of the pipeline.
+   */
+  typedef struct PoolAdapter
+  {
+    AdaptLane lanes[STREAM_MAX]; /**< One per pool */
+    int nlanes;                  /**< Lanes in use */
+    int shrink_ticks;            /**< Quiet ticks before a shrink */
+    size_t headroom;             /**< Blocks kept above the peak use */
+    uint64_t ticks;              /**< adapt_tick() calls */
+  } PoolAdapter;
+
+  /**
+   * @brief Set up an empty controller.
+   * @param[out] ad           Controller.
+   * @param[in]  shrink_ticks Quiet ticks before a shrink (>0).
+   * @param[in]  headroom     Blocks kept above the peak use.
+   */
+  void adapt_init(PoolAdapter *ad, int shrink_ticks, size_t headroom);
+
+  /**
+   * @brief Put a pool under control; its current limit is the starting point.
+   * @param[in,out] ad         Controller.
+   * @param[in]     pool       Pool.
+   * @param[in]     min_blocks Lowest limit (>0).
+   * @param[in]     max_blocks Highest limit (clamped to the pool size).
+   * @param[in]     reserve    Blocks of the limit the record queues leave free.
+   * @return Lane index; -1 when full or on bad arguments (errno set).
+   */
+  int adapt_add_pool(PoolAdapter *ad, FramePool *pool, size_t min_blocks, size_t max_blocks,
+                     size_t reserve);
+
+  /**
+   * @brief Attach a record queue to a lane; it gets an equal share of the pool limit above the reserve.
+   * @param[in,out] ad    Controller.
+   * @param[in]     lane  Lane index from adapt_add_pool().
+   * @param[in]     queue Queue.
+   * @return 0 on success; -1 on bad arguments (errno set).
+   */
+  int adapt_add_queue(PoolAdapter *ad, int lane, Queue *queue);
+
+  /**
+   * @brief Look at every lane once and resize where needed.
+   * @param[in,out] ad Controller.
+   * @return Number of limits changed.
+   */
+  int adapt_tick(PoolAdapter *ad);
+
+  /**
+   * @brief Print the decisions taken per lane.
+   * @param[in] ad  Controller.
+   * @param[in] out Stream (NULL: stderr).
+   */
+  void adapt_report(const PoolAdapter *ad, FILE *out);
+
+  /**
+   * @brief Start the controller thread over the pools and record queues of @p arg.
+   * @param[in]  arg Shared context.
+   * @param[out] tid Thread identifier output.
+   * @return true if thread created; false on error.
+   */
+  bool adapt_run(SharedCtx *arg, pthread_t *tid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADAPT_H
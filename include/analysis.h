@@ -0,0 +1,36 @@
+/*
+ * @file analysis.h
+ * @brief Motion analysis thread subscribed to the capture stream
+ */
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "motion.h"
+#include "thread_arg.h"
+
+  /**
+   * @brief Start the analysis thread.
+   *
+   * The thread runs the motion detector on every frame capture hands to
+   * motion_q and publishes each result on the shared MotionBoard. Capture
+   * never waits for it: when motion_q is full the frame is skipped.
+   * @param[in] arg Shared context pointer.
+   * @param[out] tid Thread identifier output.
+   * @return true if thread created; false on error.
+   */
+  bool analysis_run(SharedCtx *arg, pthread_t *tid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ANALYSIS_H
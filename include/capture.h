@@ -21,15 +21,17 @@ extern "C"
 #include <sys/types.h>
 #include <unistd.h> // for usleep
 
+#include "container.h"
+#include "synth.h"
 #include "thread_arg.h"
 
   /**
    * @brief Start the capture thread.
-   * @param[in] arg Shared context pointer.
+   * @param[in] arg Stream context of the source to read.
    * @param[out] tid Thread identifier output.
    * @return true if thread created; false on error.
    */
-  bool capture_run(SharedCtx *arg, pthread_t *tid);
+  bool capture_run(StreamCtx *arg, pthread_t *tid);
 
   /**
    * @brief Open raw video file and read header dimensions.
@@ -0,0 +1,154 @@
+/*
+ * @file codec.h
+ * @brief Lossless frame codec: XOR temporal delta + byte run-length coding
+ *
+ * A key frame is run-length coded as is. A delta frame is first XORed with
+ * the previous decoded frame, which turns every unchanged pixel into 0, and
+ * the residual is then run-length coded. No entropy stage: both directions
+ * are a single pass of SIMD compares, memset and memcpy.
+ *
+ * Payload layout:
+ *
+ *   CodecHeader                 slice count and frame size
+ *   uint32_t size[nslices]      encoded bytes of each slice
+ *   slice 0 .. nslices-1        RLE streams, back to back
+ *
+ * Slice i covers rows [height*i/n, height*(i+1)/n) and is coded on its own,
+ * so slices can be encoded and decoded independently.
+ *
+ * RLE stream: a sequence of tokens, each starting with a LEB128 varint
+ * v = (len << 1) | run. A run token (run = 1) is followed by one byte that
+ * repeats len times; a literal token (run = 0) by len bytes to copy.
+ */
+#ifndef CODEC_H
+#define CODEC_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#define CODEC_MAX_SLICES 64 /**< Upper bound of slices per frame */
+#define CODEC_MIN_RUN 8     /**< Shorter repeats are coded as literals */
+
+  /**
+   * @struct CodecHeader
+   * @brief Head of an encoded frame payload (8 bytes).
+   */
+  typedef struct CodecHeader
+  {
+    uint16_t nslices;  /**< Slices that follow (1..CODEC_MAX_SLICES) */
+    uint16_t reserved; /**< Reserved, 0 */
+    uint32_t bytes;    /**< Decoded frame size (width * height) */
+  } CodecHeader;
+
+  _Static_assert(sizeof(CodecHeader) == 8, "CodecHeader layout");
+
+  /**
+   * @brief Worst-case payload size of an encoded frame.
+   * @param[in] bytes   Decoded frame size.
+   * @param[in] nslices Slice count.
+   * @return Bytes the destination of codec_encode_frame() must hold.
+   */
+  size_t codec_bound(size_t bytes, int nslices);
+
+  /**
+   * @brief dst = a ^ b over @p n bytes (SSE2 / NEON when available).
+   *
+   * @p dst may alias @p a or @p b.
+   */
+  void codec_xor(uint8_t *dst, const uint8_t *a, const uint8_t *b, size_t n);
+
+  /**
+   * @brief Run-length code @p n bytes.
+   * @param[out] dst Destination of at least codec_bound(n, 1) bytes.
+   * @param[in]  src Input bytes.
+   * @param[in]  n   Input size.
+   * @return Encoded size.
+   */
+  size_t codec_rle_encode(uint8_t *dst, const uint8_t *src, size_t n);
+
+  /**
+   * @brief Decode a run-length stream that must produce exactly @p n bytes.
+   * @param[out] dst  Destination of @p n bytes.
+   * @param[in]  n    Expected decoded size.
+   * @param[in]  src  Encoded stream.
+   * @param[in]  size Encoded size.
+   * @return 0 on success; -1 if the stream is malformed (errno = EPROTO).
+   */
+  int codec_rle_decode(uint8_t *dst, size_t n, const uint8_t *src, size_t size);
+
+  /**
+   * @brief Encode one slice: XOR with @p ref (if any), then run-length code.
+   * @param[out] dst     Destination of at least codec_bound(n, 1) bytes.
+   * @param[in]  cur     Slice pixels.
+   * @param[in]  ref     Same slice of the reference frame, NULL for a key slice.
+   * @param[out] scratch Residual buffer of @p n bytes (unused when @p ref is NULL).
+   * @param[in]  n       Slice size.
+   * @return Encoded size.
+   */
+  size_t codec_encode_slice(uint8_t *dst, const uint8_t *cur, const uint8_t *ref,
+                            uint8_t *scratch, size_t n);
+
+  /**
+   * @brief Byte range of slice @p i.
+   * @param[in]  width   Frame width.
+   * @param[in]  height  Frame height.
+   * @param[in]  nslices Slice count.
+   * @param[in]  i       Slice index (0..nslices-1).
+   * @param[out] off     Offset of the slice in the frame.
+   * @param[out] len     Slice bytes.
+   */
+  void codec_slice_range(size_t width, size_t height, int nslices, int i, size_t *off,
+                         size_t *len);
+
+  /**
+   * @brief Write the CodecHeader and slice table in front of separately coded slices.
+   * @param[out] dst     Destination of sizeof(CodecHeader) + nslices * 4 bytes.
+   * @param[in]  bytes   Decoded frame size.
+   * @param[in]  nslices Slice count.
+   * @param[in]  sizes   Encoded size of each slice.
+   * @return Bytes written.
+   */
+  size_t codec_write_header(uint8_t *dst, size_t bytes, int nslices, const uint32_t *sizes);
+
+  /**
+   * @brief Encode a frame.
+   * @param[out] dst     Destination buffer.
+   * @param[in]  cap     Size of @p dst (codec_bound() is always enough).
+   * @param[in]  cur     Frame of width*height bytes.
+   * @param[in]  ref     Previous frame for a delta frame, NULL for a key frame.
+   * @param[out] scratch Residual buffer of width*height bytes.
+   * @param[in]  width   Frame width.
+   * @param[in]  height  Frame height.
+   * @param[in]  nslices Slice count (1..CODEC_MAX_SLICES, at most height).
+   * @return Payload size; -1 on invalid arguments or short @p cap (errno set).
+   */
+  ssize_t codec_encode_frame(uint8_t *dst, size_t cap, const uint8_t *cur, const uint8_t *ref,
+                             uint8_t *scratch, size_t width, size_t height, int nslices);
+
+  /**
+   * @brief Decode a frame payload.
+   * @param[out] dst    Destination of width*height bytes (must not alias @p ref).
+   * @param[in]  ref    Previous decoded frame for a delta frame, NULL for a key frame.
+   * @param[in]  width  Frame width.
+   * @param[in]  height Frame height.
+   * @param[in]  src    Payload.
+   * @param[in]  size   Payload size.
+   * @return 0 on success; -1 if the payload is malformed (errno = EPROTO).
+   */
+  int codec_decode_frame(uint8_t *dst, const uint8_t *ref, size_t width, size_t height,
+                         const uint8_t *src, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CODEC_H
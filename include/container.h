@@ -0,0 +1,426 @@
+/*
+ * @file container.h
+ * @brief Recorded video container (.tbb) with a seekable side index
+ *
+ * Layout of a recording:
+ *
+ *   <path>      TbbFileHeader, then one record per stored frame:
+ *               TbbFrameHeader followed by payload_size bytes of payload
+ *   <path>.idx  TbbIndexHeader, then one TbbIndexEntry per record
+ *
+ * Frames that were not stored (static scene) leave a gap in seq; the next
+ * stored record carries the gap length in `skipped`, so a player repeats
+ * the previous picture that many times and timing stays intact. A trailing
+ * gap is closed with a payload-less TBB_FLAG_HOLD record. All fields
+ * are written in host byte order, like the raw format.
+ *
+ * Durability: index entries are a write-ahead record of what is on the
+ * media. They are held back until an fdatasync() of the data file has
+ * completed, so every indexed record survives a power loss. After a crash
+ * tbb_recover() keeps the indexed records, checks the unindexed tail by CRC
+ * and truncates the data file after the last intact record.
+ *
+ * Page cache: long recordings are never read back while recording, so the
+ * writer can drop written pages after each sync (TBB_IO_DONTNEED) or bypass
+ * the cache with O_DIRECT (TBB_IO_DIRECT). In direct mode records are staged
+ * in an aligned buffer and written in whole blocks; the partial last block
+ * is written zero padded when a sync is due and again once it grows, and the
+ * padding is truncated away on close.
+ */
+#ifndef CONTAINER_H
+#define CONTAINER_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "codec.h"
+#include "crc32c.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define TBB_FILE_MAGIC 0x56424254u  /**< "TBBV" */
+#define TBB_FRAME_MAGIC 0x4D524654u /**< "TFRM" */
+#define TBB_INDEX_MAGIC 0x49424254u /**< "TBBI" */
+#define TBB_VERSION 1
+#define TBB_INDEX_SUFFIX ".idx"
+#define TBB_MAX_IOV (CODEC_MAX_SLICES + 1) /**< Payload pieces per tbb_writer_appendv() */
+#define TBB_FILE_CRC32C 0x1u /**< TbbFileHeader.flags: records carry a CRC-32C */
+#define TBB_MAX_PENDING 1024 /**< Records that may wait for a sync; a full list forces one */
+#define TBB_DIRECT_ALIGN 4096            /**< Buffer, offset and size alignment for O_DIRECT */
+#define TBB_DIRECT_WRITE_SIZE (1u << 20) /**< Default O_DIRECT write size */
+#define TBB_BATCH_RECORDS 16             /**< Records coalesced into one writev() */
+#define TBB_BATCH_IOV 256                /**< iovecs coalesced into one writev() */
+
+  /**
+   * @enum TbbCodec
+   * @brief Payload encoding of one record.
+   */
+  typedef enum
+  {
+    TBB_CODEC_RAW = 0,     /**< Uncompressed frame */
+    TBB_CODEC_RLE = 1,     /**< Run-length coded frame (key), see codec.h */
+    TBB_CODEC_XOR_RLE = 2, /**< XOR against the previous picture, run-length coded */
+  } TbbCodec;
+
+  /**
+   * @enum TbbFrameFlags
+   * @brief Per-record flags.
+   */
+  typedef enum
+  {
+    TBB_FLAG_KEY = 1 << 0,       /**< Decodable without earlier records */
+    TBB_FLAG_KEEPALIVE = 1 << 1, /**< Stored by the keep-alive timer, not by a scene change */
+    TBB_FLAG_HOLD = 1 << 2,      /**< No payload: the previous picture lasts `skipped` more frames */
+  } TbbFrameFlags;
+
+  /**
+   * @struct TbbFileHeader
+   * @brief Stream parameters at the start of the data file (32 bytes).
+   */
+  typedef struct TbbFileHeader
+  {
+    uint32_t magic;             /**< TBB_FILE_MAGIC */
+    uint16_t version;           /**< TBB_VERSION */
+    uint16_t header_size;       /**< sizeof(TbbFileHeader) */
+    uint32_t width;             /**< Frame width */
+    uint32_t height;            /**< Frame height */
+    uint32_t depth;             /**< Bytes per pixel */
+    uint32_t frame_interval_us; /**< Capture period of one seq step */
+    uint32_t flags;             /**< TBB_FILE_* */
+    uint32_t reserved;          /**< Reserved, 0 */
+  } TbbFileHeader;
+
+  /**
+   * @struct TbbFrameHeader
+   * @brief Header in front of every stored frame (32 bytes).
+   */
+  typedef struct TbbFrameHeader
+  {
+    uint32_t magic;        /**< TBB_FRAME_MAGIC */
+    uint8_t codec;         /**< TbbCodec */
+    uint8_t flags;         /**< TbbFrameFlags */
+    uint16_t reserved;     /**< Reserved, 0 */
+    uint64_t seq;          /**< Capture sequence number */
+    uint32_t payload_size; /**< Bytes following this header */
+    uint32_t skipped;      /**< Frames not stored between the previous record and this one */
+    uint32_t crc;          /**< CRC-32C of this header (with crc = 0) and the payload */
+    uint32_t reserved2;    /**< Reserved, 0 */
+  } TbbFrameHeader;
+
+  /**
+   * @struct TbbIndexHeader
+   * @brief Header of the side index file (16 bytes).
+   */
+  typedef struct TbbIndexHeader
+  {
+    uint32_t magic;      /**< TBB_INDEX_MAGIC */
+    uint16_t version;    /**< TBB_VERSION */
+    uint16_t entry_size; /**< sizeof(TbbIndexEntry) */
+    uint64_t reserved;   /**< Reserved, 0 */
+  } TbbIndexHeader;
+
+  /**
+   * @struct TbbIndexEntry
+   * @brief Location and timing of one stored record (32 bytes).
+   */
+  typedef struct TbbIndexEntry
+  {
+    uint64_t seq;          /**< Capture sequence number */
+    uint64_t offset;       /**< Offset of the TbbFrameHeader in the data file */
+    uint32_t payload_size; /**< Payload bytes */
+    uint32_t skipped;      /**< Frames skipped before this record */
+    uint8_t codec;         /**< TbbCodec */
+    uint8_t flags;         /**< TbbFrameFlags */
+    uint16_t reserved;     /**< Reserved, 0 */
+    uint32_t crc;          /**< Copy of TbbFrameHeader.crc */
+  } TbbIndexEntry;
+
+  _Static_assert(sizeof(TbbFileHeader) == 32, "TbbFileHeader layout");
+  _Static_assert(sizeof(TbbFrameHeader) == 32, "TbbFrameHeader layout");
+  _Static_assert(sizeof(TbbIndexHeader) == 16, "TbbIndexHeader layout");
+  _Static_assert(sizeof(TbbIndexEntry) == 32, "TbbIndexEntry layout");
+
+  /**
+   * @struct TbbSyncPolicy
+   * @brief When written records are made durable. Zero fields are off.
+   */
+  typedef struct TbbSyncPolicy
+  {
+    uint32_t every_frames; /**< Sync after this many records */
+    uint32_t every_ms;     /**< Sync when the oldest unsynced record is this old */
+    bool writeback;        /**< Start writeback of each record right away (sync_file_range) */
+    bool background;       /**< Sync on a helper thread so appends never wait for the media */
+  } TbbSyncPolicy;
+
+  /**
+   * @enum TbbIoMode
+   * @brief How record data reaches the data file.
+   */
+  typedef enum
+  {
+    TBB_IO_BUFFERED = 0, /**< Plain buffered writes */
+    TBB_IO_DONTNEED,     /**< Buffered, pages dropped from the cache once synced */
+    TBB_IO_DIRECT,       /**< O_DIRECT through an aligned staging buffer */
+  } TbbIoMode;
+
+  /**
+   * @struct TbbSyncStats
+   * @brief What durability costs the writer.
+   */
+  typedef struct TbbSyncStats
+  {
+    uint64_t syncs;          /**< Completed sync rounds */
+    uint64_t durable;        /**< Records known to be on the media */
+    uint64_t sync_ns_max;    /**< Longest sync round */
+    uint64_t sync_ns_total;  /**< Time spent in sync rounds */
+    uint64_t stall_ns_max;   /**< Longest time an append waited for durability */
+    uint64_t stall_ns_total; /**< Time appends waited for durability */
+  } TbbSyncStats;
+
+  /**
+   * @struct TbbWriter
+   * @brief Appends records to a data file and its write-ahead index.
+   */
+  typedef struct TbbWriter
+  {
+    int fd;                 /**< Data file */
+    int idx_fd;             /**< Index file */
+    TbbFileHeader hdr;      /**< Header written at offset 0 */
+    uint64_t offset;        /**< Offset of the next record */
+    uint64_t records;       /**< Records written since open/rewind */
+    uint64_t bytes;         /**< Data bytes written since open (headers included) */
+    TbbSyncPolicy sync;     /**< Durability policy */
+    TbbSyncStats stats;     /**< Durability cost */
+    TbbIndexEntry *pending; /**< Entries of records not yet durable (TBB_MAX_PENDING) */
+    TbbIndexEntry *batch;   /**< Entries being made durable by the current sync round */
+    size_t npending;        /**< Valid entries in pending */
+    uint64_t idx_offset;    /**< Where the next durable index entry goes */
+    uint64_t wb_offset;     /**< Data handed to writeback so far */
+    uint64_t oldest_ns;     /**< Write time of pending[0] */
+    pthread_mutex_t mutex;  /**< Protects pending and the sync state below */
+    pthread_cond_t cond;    /**< Sync requested / sync round finished */
+    pthread_t sync_tid;     /**< Background sync thread */
+    bool sync_thread;       /**< sync_tid is running */
+    bool sync_requested;    /**< Background sync wanted */
+    bool sync_busy;         /**< A sync round is in progress */
+    bool quit;              /**< Stop the background thread */
+    int sync_error;         /**< errno of a failed background sync, reported once */
+    TbbIoMode io;           /**< Data path */
+    uint8_t *stage;         /**< TBB_IO_DIRECT: aligned buffer holding the block(s) at stage_off */
+    size_t stage_cap;       /**< Write size (multiple of TBB_DIRECT_ALIGN) */
+    size_t stage_fill;      /**< Valid bytes in stage */
+    uint64_t stage_off;     /**< File offset of stage[0] */
+    uint64_t written;       /**< Data bytes handed to the file (writer thread) */
+    uint64_t flushed;       /**< Copy of written for sync rounds (under mutex) */
+    uint64_t dropped;       /**< TBB_IO_DONTNEED: data dropped from the cache so far */
+    bool batching;          /**< Between tbb_writer_begin_batch() and tbb_writer_end_batch() */
+    struct iovec *biov;     /**< Queued headers and payload pieces (TBB_BATCH_IOV) */
+    int nbiov;              /**< Valid entries in biov */
+    int nbatch;             /**< Records queued in biov */
+    TbbFrameHeader bhead[TBB_BATCH_RECORDS]; /**< Headers of the queued records */
+    TbbIndexEntry bentry[TBB_BATCH_RECORDS]; /**< Index entries of the queued records */
+  } TbbWriter;
+
+  /**
+   * @struct TbbRecovery
+   * @brief Result of tbb_recover().
+   */
+  typedef struct TbbRecovery
+  {
+    uint64_t records;       /**< Intact records kept */
+    uint64_t indexed;       /**< Records that were already in the index */
+    uint64_t dropped_bytes; /**< Torn or corrupt tail removed from the data file */
+  } TbbRecovery;
+
+  /**
+   * @struct TbbReader
+   * @brief Sequential player of a .tbb file that re-expands skipped frames.
+   */
+  typedef struct TbbReader
+  {
+    int fd;              /**< Data file (not owned) */
+    TbbFileHeader hdr;   /**< Stream parameters */
+    size_t frame_bytes;  /**< width * height * depth */
+    uint8_t *frame;      /**< Picture currently being shown */
+    uint8_t *next;       /**< Decoded record waiting behind held repeats */
+    uint8_t *payload;    /**< Encoded payload of the record being read */
+    size_t payload_cap;  /**< Size of payload */
+    uint32_t repeat;     /**< Repeats of frame still to emit */
+    bool pending;        /**< next holds a picture to emit after the repeats */
+    bool have_frame;     /**< frame holds a valid picture */
+    bool verify;         /**< Check record CRCs (file has TBB_FILE_CRC32C) */
+    uint64_t crc_errors; /**< Records dropped because their CRC did not match */
+  } TbbReader;
+
+  /**
+   * @brief CRC-32C of a record: header with crc = 0, then the payload.
+   * @param[in] fh      Frame header (its crc field is ignored).
+   * @param[in] payload fh->payload_size bytes (NULL if 0).
+   * @return CRC to store in / compare with fh->crc.
+   */
+  uint32_t tbb_record_crc(const TbbFrameHeader *fh, const void *payload);
+
+  /**
+   * @brief Create (or truncate) a recording and its index.
+   * @param[out] wr          Writer to initialize (>NULL).
+   * @param[in]  path        Data file path; the index goes to path + ".idx".
+   * @param[in]  width       Frame width (>0).
+   * @param[in]  height      Frame height (>0).
+   * @param[in]  depth       Bytes per pixel (>0).
+   * @param[in]  interval_us Capture period of one seq step.
+   * @return 0 on success; -1 on failure (errno set).
+   */
+  int tbb_writer_open(TbbWriter *wr, const char *path, uint32_t width, uint32_t height,
+                      uint32_t depth, uint32_t interval_us);
+
+  /**
+   * @brief Set the durability policy (default: sync only when TBB_MAX_PENDING records wait).
+   * @param[in,out] wr     Writer.
+   * @param[in]     policy Policy; background starts a helper thread.
+   * @return 0 on success; -1 on failure (errno set).
+   */
+  int tbb_writer_set_sync(TbbWriter *wr, const TbbSyncPolicy *policy);
+
+  /**
+   * @brief Choose the data path; only before the first append.
+   *
+   * TBB_IO_DIRECT fails with EINVAL when the file system does not support
+   * O_DIRECT; the writer then stays buffered.
+   * @param[in,out] wr         Writer.
+   * @param[in]     mode       Data path.
+   * @param[in]     write_size TBB_IO_DIRECT write size, rounded up to TBB_DIRECT_ALIGN
+   *                           (0: TBB_DIRECT_WRITE_SIZE).
+   * @return 0 on success; -1 on failure (errno set, EBUSY after the first append).
+   */
+  int tbb_writer_set_io(TbbWriter *wr, TbbIoMode mode, size_t write_size);
+
+  /**
+   * @brief Make every record written so far durable and index it; call from the appending thread.
+   * @param[in,out] wr Writer.
+   * @return 0 on success; -1 on failure (errno set).
+   */
+  int tbb_writer_sync(TbbWriter *wr);
+
+  /**
+   * @brief Coalesce the following appends into as few writev() calls as possible.
+   *
+   * Until tbb_writer_end_batch() the payload buffers passed to the appends
+   * must stay untouched; they are written when the batch fills
+   * (TBB_BATCH_RECORDS / TBB_BATCH_IOV) or ends. Without effect in
+   * TBB_IO_DIRECT mode, which already writes whole blocks.
+   * @param[in,out] wr Writer.
+   */
+  void tbb_writer_begin_batch(TbbWriter *wr);
+
+  /**
+   * @brief Write the queued records and go back to one writev() per append.
+   * @param[in,out] wr Writer.
+   * @return 0 on success; -1 on failure (errno set).
+   */
+  int tbb_writer_end_batch(TbbWriter *wr);
+
+  /**
+   * @brief Append one record; its index entry follows once the record is durable.
+   *
+   * Records are written with pwritev at the writer's own offset: the file
+   * position of the fd is never used, so a restart must call
+   * tbb_writer_rewind() explicitly.
+   * @param[in,out] wr      Writer.
+   * @param[in]     seq     Capture sequence number.
+   * @param[in]     codec   TbbCodec of @p payload.
+   * @param[in]     flags   TbbFrameFlags.
+   * @param[in]     skipped Frames not stored since the previous record.
+   * @param[in]     payload Encoded frame.
+   * @param[in]     size    Payload bytes.
+   * @return 0 on success; -1 on failure (errno set).
+   */
+  int tbb_writer_append(TbbWriter *wr, uint64_t seq, uint8_t codec, uint8_t flags,
+                        uint32_t skipped, const void *payload, uint32_t size);
+
+  /**
+   * @brief Append one record whose payload is gathered from several buffers.
+   * @param[in,out] wr      Writer.
+   * @param[in]     seq     Capture sequence number.
+   * @param[in]     codec   TbbCodec of the payload.
+   * @param[in]     flags   TbbFrameFlags.
+   * @param[in]     skipped Frames not stored since the previous record.
+   * @param[in]     payload Payload pieces, written back to back.
+   * @param[in]     count   Number of pieces (0..TBB_MAX_IOV).
+   * @return 0 on success; -1 on failure (errno set).
+   */
+  int tbb_writer_appendv(TbbWriter *wr, uint64_t seq, uint8_t codec, uint8_t flags,
+                         uint32_t skipped, const struct iovec *payload, int count);
+
+  /**
+   * @brief Drop all records (keep the headers) and continue from the start.
+   * @param[in,out] wr Writer.
+   * @return 0 on success; -1 on failure (errno set).
+   */
+  int tbb_writer_rewind(TbbWriter *wr);
+
+  /**
+   * @brief Sync, stop the helper thread and close both files.
+   * @param[in,out] wr Writer (NULL safe).
+   */
+  void tbb_writer_close(TbbWriter *wr);
+
+  /**
+   * @brief Repair a recording after a crash.
+   *
+   * Records listed in the index are trusted (they were durable when
+   * indexed); records after them are checked by header and CRC. The data
+   * file is truncated after the last intact record and the index rebuilt.
+   * @param[in]  path Data file path.
+   * @param[out] out  Summary (may be NULL).
+   * @return 0 on success (also for a file that is not a recording, left
+   *         untouched); -1 on failure (errno set, ENOENT if missing).
+   */
+  int tbb_recover(const char *path, TbbRecovery *out);
+
+  /**
+   * @brief Detect a .tbb stream on @p fd and prepare to play it.
+   * @param[out] rd Reader to initialize (>NULL).
+   * @param[in]  fd Open file positioned anywhere; the reader does not own it.
+   * @return 1 if @p fd is a .tbb file (positioned at the first record);
+   *         0 if not (fd rewound to 0 for raw reading); -1 on error (errno set).
+   */
+  int tbb_reader_open_fd(TbbReader *rd, int fd);
+
+  /**
+   * @brief Produce the next capture-rate frame.
+   *
+   * Records with a non-zero `skipped` first repeat the previous picture.
+   * Coded records are decoded against the previous picture; a delta record
+   * without one (damaged start) is skipped until the next key record. A
+   * record whose CRC does not match is dropped the same way.
+   * At end of file playback restarts from the first record.
+   * @param[in,out] rd   Reader.
+   * @param[out]    out  Destination of frame_bytes bytes.
+   * @param[in]     size Size of @p out (must equal frame_bytes).
+   * @return 0 on success; 1 if playback wrapped to the start; -1 on error.
+   */
+  int tbb_reader_read_frame(TbbReader *rd, void *out, size_t size);
+
+  /**
+   * @brief Free reader buffers (the fd stays open).
+   * @param[in,out] rd Reader (NULL safe).
+   */
+  void tbb_reader_close(TbbReader *rd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONTAINER_H
@@ -0,0 +1,48 @@
+/*
+ * @file crc32c.h
+ * @brief CRC-32C (Castagnoli) checksums
+ *
+ * Uses the SSE4.2 crc32 instruction on x86 or the ARMv8 CRC extension when
+ * the CPU has it (checked once at run time) and a slicing-by-8 table
+ * implementation otherwise. All paths produce the same value.
+ */
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+  /**
+   * @brief Extend a CRC-32C over @p n more bytes.
+   *
+   * Start with @p crc = 0; pass the previous result to continue over the
+   * next piece, e.g. crc32c(crc32c(0, a, na), b, nb) == crc32c(0, ab, na + nb).
+   * @param[in] crc Running CRC (0 to start).
+   * @param[in] buf Bytes (may be NULL if @p n is 0).
+   * @param[in] n   Byte count.
+   * @return Updated CRC.
+   */
+  uint32_t crc32c(uint32_t crc, const void *buf, size_t n);
+
+  /**
+   * @brief Table-driven (slicing-by-8) implementation, used when no hardware support exists.
+   */
+  uint32_t crc32c_sw(uint32_t crc, const void *buf, size_t n);
+
+  /**
+   * @brief Whether crc32c() runs on CRC instructions.
+   * @return true for SSE4.2 / ARMv8 CRC, false for the table fallback.
+   */
+  bool crc32c_hw_available(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CRC32C_H
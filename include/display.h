@@ -18,9 +18,19 @@ extern "C"
 
 #include "console_color.h"
 #include "fbDraw.h"
+#include "glyph.h"
+#include "mosaic.h"
+#include "overlay.h"
+#include "render.h"
 #include "thread_arg.h"
 #define FRAME_INTERVAL_US 33000 /**< Delay between frames in microseconds (33ms) */
 #define MENU_COUNT 3            /**< Number of UI menu items */
+#define MENU_OVERLAY_W (10 + MENU_COUNT * 110) /**< Menu overlay layer width */
+#define MENU_OVERLAY_H 40                      /**< Menu overlay layer height */
+#define DISPLAY_RENDER_THREADS 0 /**< Band threads for fb_drawGray (0: online CPUs) */
+#define DISPLAY_SCALE_MODE SCALE_AREA /**< Panel scaling filter (SCALE_NEAREST/BILINEAR/AREA) */
+#define DISPLAY_MOTION_BOXES 1 /**< Outline regions reported by the motion detector */
+#define DISPLAY_BATCH_MAX QUEUE_SIZE /**< Queued frames taken per mosaic refresh */
 
   /**
    * @brief Launch the display thread.
@@ -0,0 +1,151 @@
+/*
+ * @file encoder.h
+ * @brief Parallel frame encoder with an in-order write-back stage
+ *
+ * Each submitted frame is copied into a slot of a small ring and its slices
+ * are coded as independent tasks on a worker pool. Finished slots are
+ * written to the container strictly in submission order (the ring doubles
+ * as reorder buffer), so several frames can be in flight while the output
+ * stays byte-identical to a single-threaded encode: slicing depends only on
+ * the frame size and the slice count, never on the number of threads.
+ *
+ * The copy kept in the newest slot is the reference of the next delta frame
+ * and of the recorder's change metric, so no separate "last frame" copy is
+ * needed.
+ */
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "codec.h"
+#include "container.h"
+#include "task.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FE_MAX_INFLIGHT 16 /**< Upper bound of frames in flight */
+
+  /**
+   * @struct EncodeSlot
+   * @brief One frame in flight: source copy, slice outputs and join group.
+   */
+  typedef struct EncodeSlot
+  {
+    uint8_t *frame;                                            /**< Copy of the submitted frame */
+    uint8_t *residual;                                         /**< XOR scratch */
+    uint8_t *out;                                              /**< nslices areas of slice_cap bytes */
+    const uint8_t *ref;                                        /**< Reference frame, NULL for a key frame */
+    uint32_t sizes[CODEC_MAX_SLICES];                          /**< Coded bytes per slice */
+    uint8_t head[sizeof(CodecHeader) + CODEC_MAX_SLICES * 4]; /**< Payload header built at write time */
+    TaskGroup group;                                           /**< Slice tasks of this frame */
+    uint64_t seq;                                              /**< Capture sequence number */
+    uint32_t skipped;                                          /**< Frames not stored before this one */
+    uint8_t flags;                                             /**< TbbFrameFlags requested by the caller */
+  } EncodeSlot;
+
+  /**
+   * @struct FrameEncoder
+   * @brief Slot ring, worker pool and coding parameters.
+   */
+  typedef struct FrameEncoder
+  {
+    ThreadPool *pool;   /**< Slice workers (NULL: encode on the caller) */
+    bool owns_pool;     /**< pool was created by fe_create() */
+    size_t width;       /**< Frame width in bytes */
+    size_t height;      /**< Frame height */
+    size_t bytes;       /**< width * height */
+    int nslices;        /**< Slices per frame; 0 stores raw frames */
+    size_t slice_cap;   /**< Output area per slice */
+    EncodeSlot *slots;  /**< Ring of nslots slots */
+    int nslots;         /**< Frames that can be in flight */
+    uint64_t head;      /**< Oldest slot not yet written (monotonic) */
+    uint64_t tail;      /**< Next slot to fill (monotonic) */
+    bool have_ref;      /**< Newest slot may serve as reference */
+    uint64_t raw_fallbacks; /**< Frames written raw because coding did not shrink them */
+  } FrameEncoder;
+
+  /**
+   * @brief Create an encoder.
+   * @param[in] width    Frame width in bytes (>0).
+   * @param[in] height   Frame height (>0).
+   * @param[in] nslices  Slices per frame (0: raw, else 1..CODEC_MAX_SLICES, at most height).
+   * @param[in] nthreads Worker threads (0: online CPUs, 1: encode on the caller).
+   * @param[in] inflight Frames in flight (2..FE_MAX_INFLIGHT).
+   * @return Pointer to FrameEncoder or NULL (errno set).
+   */
+  FrameEncoder *fe_create(size_t width, size_t height, int nslices, int nthreads, int inflight);
+
+  /**
+   * @brief Create an encoder whose slices run on an existing pool.
+   *
+   * Several encoders (one per recorded stream) can share one pool, so the
+   * number of coding threads does not grow with the number of streams.
+   * @param[in] pool     Worker pool, outlives the encoder (NULL: encode on the caller).
+   * @param[in] width    Frame width in bytes (>0).
+   * @param[in] height   Frame height (>0).
+   * @param[in] nslices  Slices per frame (0: raw, else 1..CODEC_MAX_SLICES, at most height).
+   * @param[in] inflight Frames in flight (2..FE_MAX_INFLIGHT).
+   * @return Pointer to FrameEncoder or NULL (errno set).
+   */
+  FrameEncoder *fe_create_shared(ThreadPool *pool, size_t width, size_t height, int nslices,
+                                 int inflight);
+
+  /**
+   * @brief Wait for running tasks and free the encoder (frames still queued are dropped).
+   * @param[in,out] fe Encoder pointer (NULL safe).
+   */
+  void fe_destroy(FrameEncoder *fe);
+
+  /**
+   * @brief Copy a frame into the ring and start coding it.
+   *
+   * Only when the ring is full is the oldest frame waited for and every
+   * finished frame written (in one batch); call fe_flush() to write earlier.
+   * A key frame is coded when @p key is set or no reference exists.
+   * @param[in,out] fe      Encoder.
+   * @param[in,out] wr      Container receiving finished frames.
+   * @param[in]     frame   Frame of width*height bytes.
+   * @param[in]     seq     Capture sequence number.
+   * @param[in]     skipped Frames not stored since the previous one.
+   * @param[in]     flags   Extra TbbFrameFlags (TBB_FLAG_KEY is set by the encoder).
+   * @param[in]     key     Force a key frame.
+   * @return 0 on success; -1 if writing failed (errno set).
+   */
+  int fe_submit(FrameEncoder *fe, TbbWriter *wr, const uint8_t *frame, uint64_t seq,
+                uint32_t skipped, uint8_t flags, bool key);
+
+  /**
+   * @brief Write finished frames in submission order, coalesced into few writev() calls.
+   * @param[in,out] fe   Encoder.
+   * @param[in,out] wr   Container.
+   * @param[in]     wait true: write every frame in flight; false: stop at the first unfinished one.
+   * @return Frames written; -1 if writing failed (errno set).
+   */
+  int fe_flush(FrameEncoder *fe, TbbWriter *wr, bool wait);
+
+  /**
+   * @brief Forget the reference: the next frame is a key frame.
+   * @param[in,out] fe Encoder.
+   */
+  void fe_reset(FrameEncoder *fe);
+
+  /**
+   * @brief Most recently submitted frame, if it is a valid reference.
+   * @param[in] fe Encoder.
+   * @return Frame pointer (valid until the next submit) or NULL.
+   */
+  const uint8_t *fe_last_frame(const FrameEncoder *fe);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENCODER_H
@@ -69,6 +69,54 @@ extern "C"
    */
   int fb_init(dev_fb *fb);
 
+  /**
+   * @brief Initializes an off-screen framebuffer backed by heap memory
+   * @param fb Pointer to the framebuffer device structure to initialize
+   * @param width Width in pixels
+   * @param height Height in pixels
+   * @param bpp Bits per pixel (16: RGB565, 32: XRGB8888)
+   * @return 0 on success, -1 on invalid arguments, FB_MMAP_FAIL on allocation failure
+   * @details Used for headless rendering (benchmarks, composition layers).
+   *          fb_close() releases the buffer.
+   */
+  int fb_initMemory(dev_fb *fb, int width, int height, int bpp);
+
+  /**
+   * @brief Packs a gray level into the framebuffer's native pixel format
+   * @param fb Pointer to the framebuffer device
+   * @param g Gray level (0-255)
+   * @return Pixel value laid out according to vinfo red/green/blue bitfields
+   */
+  uint32_t fb_grayToPixel(const dev_fb *fb, ubyte g);
+
+  /**
+   * @brief Fills a 256-entry table with fb_grayToPixel() of every gray level
+   * @param fb Pointer to the framebuffer device
+   * @param lut Output table
+   */
+  void fb_buildGrayLut(const dev_fb *fb, uint32_t lut[256]);
+
+  /**
+   * @brief Converts one row of xres gray bytes to native pixels through a LUT
+   * @param fb Pointer to the framebuffer device (16 or 32 bpp)
+   * @param y Destination row
+   * @param line xres gray bytes (e.g. one scaler output row)
+   * @param lut Table from fb_buildGrayLut()
+   */
+  void fb_putGrayRow(dev_fb *fb, int y, const ubyte *line, const uint32_t lut[256]);
+
+  /**
+   * @brief Converts len gray bytes to native pixels at (x, y) through a LUT
+   * @param fb Pointer to the framebuffer device (16 or 32 bpp)
+   * @param x First column (the span must lie on screen)
+   * @param y Destination row
+   * @param line len gray bytes
+   * @param len Number of pixels
+   * @param lut Table from fb_buildGrayLut()
+   */
+  void fb_putGraySpan(dev_fb *fb, int x, int y, const ubyte *line, int len,
+                      const uint32_t lut[256]);
+
   /**
    * @brief  이미 초기화된 fb 에 1바이트 그레이스케일 프레임을 nearest-neighbor 스케일링하여 그림.
    * @param  fb     초기화 및 mmap 이 완료된 framebuffer 디바이스 구조체
@@ -79,6 +127,51 @@ extern "C"
    */
   int fb_drawGray(dev_fb *fb, const ubyte *gray, int raw_w, int raw_h);
 
+  /**
+   * @brief  fb_drawGray() 의 행 범위 버전: 출력 행 [y_begin, y_end) 만 그림.
+   * @details 서로 겹치지 않는 행 범위는 여러 스레드에서 동시에 호출해도 안전하다.
+   * @param  fb      초기화된 framebuffer 디바이스 구조체
+   * @param  gray    입력 그레이스케일 데이터 버퍼 (raw_w * raw_h 바이트)
+   * @param  raw_w   입력 영상 가로 해상도
+   * @param  raw_h   입력 영상 세로 해상도
+   * @param  y_begin 첫 출력 행 (포함)
+   * @param  y_end   마지막 출력 행 (제외)
+   * @return 0: 성공, -1: 인자 오류, -2: 지원하지 않는 bpp
+   */
+  int fb_drawGrayRows(dev_fb *fb, const ubyte *gray, int raw_w, int raw_h, int y_begin,
+                      int y_end);
+
+  /**
+   * @brief Packs an RGB color into the framebuffer's native pixel format
+   * @param fb Pointer to the framebuffer device
+   * @param r Red color component (0-255)
+   * @param g Green color component (0-255)
+   * @param b Blue color component (0-255)
+   * @return Pixel value laid out according to vinfo red/green/blue bitfields
+   */
+  uint32_t fb_packColor(const dev_fb *fb, ubyte r, ubyte g, ubyte b);
+
+  /**
+   * @brief Fills a horizontal run of pixels with a packed color
+   * @param fb Pointer to the framebuffer device
+   * @param x First column (may be off-screen; the span is clipped once)
+   * @param y Row
+   * @param len Number of pixels
+   * @param pixel Color from fb_packColor()
+   */
+  void fb_fillSpan(dev_fb *fb, int x, int y, int len, uint32_t pixel);
+
+  /**
+   * @brief Fills a rectangle with a packed color
+   * @param fb Pointer to the framebuffer device
+   * @param x,y Top-left corner (may be off-screen)
+   * @param w,h Size in pixels
+   * @param pixel Color from fb_packColor()
+   * @details Clips once, then fills whole rows with memset or 8-byte stores.
+   *          fb_fillBox, fb_drawBox and fb_fillScr are built on it.
+   */
+  void fb_fillRect(dev_fb *fb, int x, int y, int w, int h, uint32_t pixel);
+
   /**
    * @brief Calculates the memory offset for a pixel at given coordinates
    * @param fb Pointer to the framebuffer device
@@ -223,12 +316,27 @@ extern "C"
    * @param r Red color component (0-255)
    * @param g Green color component (0-255)
    * @param b Blue color component (0-255)
-   * @details Draws a single character (numbers, letters, symbols) at the specified position
+   * @details Draws a single character (numbers, letters, symbols) at the specified position.
+   *          The glyph is rasterized once per height into the shared glyph atlas and
+   *          copied as row spans afterwards.
    * @date 2025-04-07
    * @author Kim Hyo Jin
    */
   void fb_drawChar(dev_fb *fb, char c, pixel start, short height, char r, char g, char b);
 
+  /**
+   * @brief Strokes a single character with Bresenham lines
+   * @param fb Pointer to the framebuffer device
+   * @param c Character to draw
+   * @param start Starting pixel coordinates
+   * @param height Height of the character
+   * @param r Red color component (0-255)
+   * @param g Green color component (0-255)
+   * @param b Blue color component (0-255)
+   * @details Reference rasterizer of the stroke font; used to fill the glyph atlas.
+   */
+  void fb_strokeChar(dev_fb *fb, char c, pixel start, short height, char r, char g, char b);
+
   /**
    * @brief Prints a string of characters
    * @param fb Pointer to the framebuffer device
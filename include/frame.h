@@ -39,6 +39,7 @@ extern "C"
     size_t height; /**< Frame height in pixels (>0) */
     DEPTH depth;   /**< Bytes per pixel (>0) */
     size_t seq;    /**< Sequence number, starts at 0 */
+    int stream;    /**< Source stream id (multi-stream capture), 0 otherwise */
     void *data;    /**< Pixel buffer of size width*height*depth bytes */
   } Frame;
 
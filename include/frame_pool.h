@@ -14,6 +14,7 @@ extern "C"
 #include <errno.h>
 #include <pthread.h>
 #include <stdatomic.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 
@@ -27,6 +28,7 @@ extern "C"
     atomic_int refcount;     /**< Number of users holding this block */
     struct FrameBlock *next; /**< Next free block in list */
     Frame frame;             /**< Underlying Frame object */
+    bool trimmed;            /**< Pixel pages were given back by fp_trim() */
   } FrameBlock;
 
   /**
@@ -42,6 +44,10 @@ extern "C"
     FrameBlock *free_list;        /**< Head of free blocks */
     pthread_mutex_t mutex;        /**< Protects free_list */
     pthread_cond_t cond;          /**< Signals availability */
+    size_t stalls;                /**< fp_alloc() calls that found no free block */
+    size_t limit;                 /**< Blocks that may be in use at once (<= pool_size) */
+    size_t in_use;                /**< Blocks handed out now */
+    size_t peak;                  /**< Highest in_use since the last fp_take_peak() */
   } FramePool;
 
   /**
@@ -140,6 +146,49 @@ extern "C"
    */
   size_t fp_total_bytes_per_frame_size(const FramePool *fp);
 
+  /**
+   * @brief Change how many blocks may be in use at once.
+   *
+   * fp_alloc() waits while @p limit blocks are out, even if more are free.
+   * Lowering the limit does not take blocks back; it applies as they return.
+   * @param[in,out] fp    FramePool pointer.
+   * @param[in]     limit New limit (clamped to pool_size).
+   * @return 0 on success; -1 if @p limit is 0 (errno EINVAL).
+   */
+  int fp_set_limit(FramePool *fp, size_t limit);
+
+  /**
+   * @brief Current in-use limit.
+   * @param[in] fp FramePool pointer (NULL safe).
+   * @return Limit, or 0 for NULL.
+   */
+  size_t fp_get_limit(const FramePool *fp);
+
+  /**
+   * @brief Number of fp_alloc() calls that had to wait so far.
+   * @param[in] fp FramePool pointer (NULL safe).
+   * @return Stall count.
+   */
+  size_t fp_stall_count(const FramePool *fp);
+
+  /**
+   * @brief Highest number of blocks in use since the previous call; restarts from now.
+   * @param[in,out] fp FramePool pointer.
+   * @return Peak in-use blocks.
+   */
+  size_t fp_take_peak(FramePool *fp);
+
+  /**
+   * @brief Give the pixel memory of free blocks above the limit back to the kernel.
+   *
+   * The free list is LIFO, so blocks deeper than (limit - in use) are the
+   * ones not touched lately; their whole pages are dropped with
+   * MADV_DONTNEED and come back zero-filled if the limit grows again.
+   * @param[in,out] fp FramePool pointer.
+   * @return Bytes given back by this call.
+   */
+  size_t fp_trim(FramePool *fp);
+
   /**
    * @brief Dump debugging info of FramePool.
    * @param[in] fp     FramePool pointer (NULL safe).
@@ -0,0 +1,150 @@
+/*
+ * @file glyph.h
+ * @brief Glyph atlas and cached text runs for the framebuffer
+ *
+ * Characters are rasterized once per height with the stroke font of
+ * fb_strokeChar() into a coverage bitmap, which is then reduced to a list of
+ * horizontal spans. Drawing a glyph or a whole TextRun is a sequence of
+ * clipped row fills with a pre-packed pixel value.
+ */
+#ifndef GLYPH_H
+#define GLYPH_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fbDraw.h"
+
+#define GLYPH_FIRST 32      /**< First cached character (' ') */
+#define GLYPH_COUNT 96      /**< Cached characters: ' ' .. 0x7F */
+#define GLYPH_MAX_SETS 8    /**< Distinct heights kept in an atlas */
+
+  /**
+   * @struct GlyphSpan
+   * @brief Horizontal run of covered pixels, relative to the glyph/run origin.
+   */
+  typedef struct GlyphSpan
+  {
+    int16_t y;   /**< Row */
+    int16_t x;   /**< First column */
+    int16_t len; /**< Pixel count */
+  } GlyphSpan;
+
+  /**
+   * @struct Glyph
+   * @brief One rasterized character.
+   */
+  typedef struct Glyph
+  {
+    int w;             /**< Cell width in pixels */
+    int h;             /**< Cell height in pixels */
+    GlyphSpan *spans;  /**< Covered pixels as row spans, sorted by row */
+    int nspans;        /**< Number of spans */
+    bool ready;        /**< Rasterized */
+  } Glyph;
+
+  /**
+   * @struct GlyphSet
+   * @brief All cached glyphs of one character height.
+   */
+  typedef struct GlyphSet
+  {
+    short height;               /**< Character height (0: unused slot) */
+    int advance;                /**< Cursor advance per character (as fb_printStr) */
+    int line_height;            /**< Cursor advance per line */
+    Glyph glyphs[GLYPH_COUNT];  /**< Lazily rasterized glyphs */
+  } GlyphSet;
+
+  /**
+   * @struct GlyphAtlas
+   * @brief Per-height glyph cache shared by all text drawing.
+   */
+  typedef struct GlyphAtlas
+  {
+    GlyphSet sets[GLYPH_MAX_SETS]; /**< Cached heights */
+    int next_evict;                /**< Round-robin slot reused when full */
+    pthread_mutex_t mutex;         /**< Protects sets */
+  } GlyphAtlas;
+
+  /**
+   * @struct TextRun
+   * @brief A string laid out once into spans; drawing it needs no glyph lookups.
+   */
+  typedef struct TextRun
+  {
+    short height;      /**< Character height */
+    int w;             /**< Bounding width */
+    int h;             /**< Bounding height */
+    GlyphSpan *spans;  /**< All covered pixels of the string, sorted by row */
+    int nspans;        /**< Number of spans */
+  } TextRun;
+
+  /**
+   * @brief Initialize an empty atlas.
+   * @param[out] atlas Atlas to initialize (>NULL).
+   */
+  void glyph_atlas_init(GlyphAtlas *atlas);
+
+  /**
+   * @brief Free every cached glyph.
+   * @param[in,out] atlas Atlas pointer (NULL safe).
+   */
+  void glyph_atlas_free(GlyphAtlas *atlas);
+
+  /**
+   * @brief Process-wide atlas used by fb_drawChar() / fb_printStr().
+   * @return Pointer to the shared atlas (never NULL).
+   */
+  GlyphAtlas *glyph_default_atlas(void);
+
+  /**
+   * @brief Draw one character through the atlas (rasterizing it on first use).
+   * @param[in] atlas  Atlas.
+   * @param[in] fb     Target framebuffer.
+   * @param[in] c      Character.
+   * @param[in] start  Top-left position.
+   * @param[in] height Character height.
+   * @param[in] pixel  Color packed with fb_packColor().
+   */
+  void glyph_draw(GlyphAtlas *atlas, dev_fb *fb, char c, pixel start, short height,
+                  uint32_t pixel);
+
+  /**
+   * @brief Lay out a string into a TextRun (newlines start a new line).
+   * @param[out] run    Run to initialize (>NULL).
+   * @param[in]  atlas  Atlas supplying the glyphs.
+   * @param[in]  str    Text.
+   * @param[in]  height Character height (>0).
+   * @return 0 on success; -1 on failure (errno set).
+   */
+  int text_run_init(TextRun *run, GlyphAtlas *atlas, const char *str, short height);
+
+  /**
+   * @brief Draw a prepared run at @p origin.
+   * @param[in] fb     Target framebuffer.
+   * @param[in] run    Prepared run.
+   * @param[in] origin Top-left position.
+   * @param[in] r,g,b  Color components.
+   */
+  void text_run_draw(dev_fb *fb, const TextRun *run, pixel origin, char r, char g, char b);
+
+  /**
+   * @brief Release a run.
+   * @param[in,out] run Run pointer (NULL safe).
+   */
+  void text_run_free(TextRun *run);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GLYPH_H
@@ -0,0 +1,92 @@
+/*
+ * @file mailbox.h
+ * @brief Single-slot latest-frame channel
+ *
+ * A FrameMailbox holds at most one FrameBlock. Publishing swaps the new
+ * block into the slot with one atomic exchange and releases the block it
+ * replaces to the pool, so the consumer always takes the newest frame and
+ * never sees one that is more than a frame old, however far behind it is.
+ * Neither side takes a lock: the exchange is the whole hand-over, and a
+ * semaphore is posted only when the slot goes from empty to full so a
+ * waiting consumer wakes up.
+ */
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <errno.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "frame_pool.h"
+
+#define MAILBOX_WAIT_FOREVER (-1) /**< timeout_ms: block until a frame or close */
+
+  /**
+   * @struct FrameMailbox
+   * @brief Latest-frame slot between one producer and one consumer.
+   */
+  typedef struct FrameMailbox
+  {
+    _Atomic(FrameBlock *) slot; /**< Newest unconsumed block (NULL: empty) */
+    atomic_bool closed;         /**< Set by mailbox_close() */
+    sem_t ready;                /**< Posted when the slot fills, and on close */
+    FramePool *pool;            /**< Where superseded blocks go back */
+    atomic_size_t published;    /**< Blocks put */
+    atomic_size_t superseded;   /**< Blocks replaced before they were taken */
+  } FrameMailbox;
+
+  /**
+   * @brief Set up an empty mailbox.
+   * @param[out] mb   Mailbox.
+   * @param[in]  pool Pool that superseded blocks are released to.
+   * @return 0 on success; -1 on bad arguments or semaphore failure (errno set).
+   */
+  int mailbox_init(FrameMailbox *mb, FramePool *pool);
+
+  /**
+   * @brief Release a block still in the slot and free resources.
+   * @param[in,out] mb Mailbox (NULL safe).
+   */
+  void mailbox_destroy(FrameMailbox *mb);
+
+  /**
+   * @brief Publish @p fb, releasing the block it replaces. Never waits.
+   * @param[in,out] mb Mailbox.
+   * @param[in]     fb Block; the mailbox holds the caller's reference.
+   * @return 0 on success; -1 once closed (errno ECANCELED, caller still owns @p fb).
+   */
+  int mailbox_put(FrameMailbox *mb, FrameBlock *fb);
+
+  /**
+   * @brief Take the newest block, waiting for one if the slot is empty.
+   * @param[in,out] mb         Mailbox.
+   * @param[in]     timeout_ms Max wait in ms (0: try only, MAILBOX_WAIT_FOREVER: no limit).
+   * @return Block (the caller owns its reference); NULL with errno ETIMEDOUT
+   *         (empty) or ECANCELED (closed and empty).
+   */
+  FrameBlock *mailbox_take(FrameMailbox *mb, int timeout_ms);
+
+  /**
+   * @brief Stop accepting blocks and wake the consumer; a block in the slot can still be taken.
+   * @param[in,out] mb Mailbox.
+   */
+  void mailbox_close(FrameMailbox *mb);
+
+  /**
+   * @brief Blocks replaced before the consumer took them.
+   * @param[in] mb Mailbox (NULL safe).
+   */
+  size_t mailbox_superseded(const FrameMailbox *mb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MAILBOX_H
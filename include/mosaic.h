@@ -0,0 +1,142 @@
+/*
+ * @file mosaic.h
+ * @brief Grid compositor that shows several streams on one framebuffer
+ *
+ * The panel is cut into a grid of tiles, one per stream. A new frame only
+ * marks its tile dirty; mosaic_compose() then scales every dirty tile into a
+ * retained off-screen buffer in one parallel pass (rows of all dirty tiles
+ * are spread over the worker pool) and copies the tiles that changed into the
+ * page shown next. When the panel has a second page (yres_virtual >= 2 *
+ * yres) that page is hidden until mosaic_present() pans to it, so all tiles
+ * of one refresh appear at once; otherwise the copy goes to the visible page
+ * in a single short memcpy pass after all scaling is done.
+ */
+#ifndef MOSAIC_H
+#define MOSAIC_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fbDraw.h"
+#include "overlay.h"
+#include "scale.h"
+#include "task.h"
+
+#define MOSAIC_MAX_TILES 16 /**< Upper bound on tiles (bits of the stale masks) */
+
+  /**
+   * @struct MosaicTile
+   * @brief One grid cell and the frame pending for it.
+   */
+  typedef struct MosaicTile
+  {
+    OvlRect rect;         /**< Cell on the panel */
+    Scaler scaler;        /**< Source geometry → cell */
+    const uint8_t *gray;  /**< Frame to draw at the next compose (NULL: none) */
+    int src_w;            /**< Width of @p gray */
+    int src_h;            /**< Height of @p gray */
+    uint64_t updates;     /**< Frames drawn into this tile */
+  } MosaicTile;
+
+  /**
+   * @struct Mosaic
+   * @brief Grid layout, retained composition buffer and page state.
+   */
+  typedef struct Mosaic
+  {
+    int ntiles;                         /**< Tiles in use */
+    int cols;                           /**< Grid columns */
+    int rows;                           /**< Grid rows */
+    ScaleMode mode;                     /**< Scaling filter */
+    ThreadPool *pool;                   /**< Row workers (NULL: caller only) */
+    dev_fb back;                        /**< Composed tiles, panel size and format */
+    uint32_t lut[256];                  /**< Gray → panel pixel */
+    MosaicTile tiles[MOSAIC_MAX_TILES]; /**< Cells in row-major order */
+    uint32_t dirty;                     /**< Tiles with a pending frame */
+    uint32_t stale[2];                  /**< Tiles each page still has to receive */
+    int npages;                         /**< 2 when the panel can be panned, else 1 */
+    int page;                           /**< Page composed last (shown after present) */
+    unsigned cleared;                   /**< Pages whose unused grid cells were blanked */
+    uint64_t composes;                  /**< mosaic_compose() calls that drew something */
+    atomic_int error;                   /**< Set by a worker that failed to allocate */
+  } Mosaic;
+
+  /**
+   * @brief Create a compositor for @p ntiles streams on @p panel.
+   * @param[in] panel  Initialized framebuffer (16 or 32 bpp).
+   * @param[in] ntiles Tiles (1..MOSAIC_MAX_TILES), laid out in a near-square grid.
+   * @param[in] mode   Scaling filter.
+   * @param[in] pool   Worker pool for scaling (NULL: caller only; not owned).
+   * @return Pointer to Mosaic or NULL (errno set).
+   */
+  Mosaic *mosaic_create(const dev_fb *panel, int ntiles, ScaleMode mode, ThreadPool *pool);
+
+  /**
+   * @brief Free a compositor.
+   * @param[in,out] m Compositor pointer (NULL safe).
+   */
+  void mosaic_destroy(Mosaic *m);
+
+  /**
+   * @brief Queue a frame for a tile; only the latest one before a compose is drawn.
+   *
+   * The frame is read during the next mosaic_compose(), so it must stay valid
+   * until then.
+   * @param[in,out] m    Compositor.
+   * @param[in]     tile Tile index.
+   * @param[in]     gray Gray frame (w * h bytes).
+   * @param[in]     w,h  Frame size.
+   * @return 0 on success; -1 on failure (errno set).
+   */
+  int mosaic_set_frame(Mosaic *m, int tile, const uint8_t *gray, int w, int h);
+
+  /**
+   * @brief Mark tiles under a region as overwritten on the page being composed.
+   *
+   * Call for overlays (boxes, menus) drawn on @p panel after mosaic_compose(),
+   * so the next compose on that page restores the video underneath.
+   * @param[in,out] m Compositor.
+   * @param[in]     r Region in panel coordinates.
+   */
+  void mosaic_damage(Mosaic *m, OvlRect r);
+
+  /**
+   * @brief Scale dirty tiles and copy every tile the next page lacks into it.
+   *
+   * Afterwards @p panel draws to the page that mosaic_present() will show
+   * (its vinfo.yoffset is moved there), so overlays can be added first.
+   * @param[in,out] m     Compositor.
+   * @param[in,out] panel Framebuffer passed to mosaic_create().
+   * @return Number of tiles scaled; -1 on failure (errno set).
+   */
+  int mosaic_compose(Mosaic *m, dev_fb *panel);
+
+  /**
+   * @brief Show the page prepared by mosaic_compose() (no-op on a single page).
+   * @param[in,out] m     Compositor.
+   * @param[in,out] panel Framebuffer.
+   * @return 0 on success; -1 if the pan ioctl failed (errno set).
+   */
+  int mosaic_present(Mosaic *m, dev_fb *panel);
+
+  /**
+   * @brief Cell of a tile on the panel.
+   * @param[in] m    Compositor.
+   * @param[in] tile Tile index.
+   * @return Rectangle (empty for an invalid index).
+   */
+  OvlRect mosaic_tile_rect(const Mosaic *m, int tile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOSAIC_H
@@ -0,0 +1,200 @@
+/*
+ * @file motion.h
+ * @brief Block-based motion detection on downsampled gray planes
+ *
+ * Each input frame is box-filtered into a small analysis plane (1/4 or 1/8
+ * of the resolution per axis). The plane is cut into MD_BLOCK x MD_BLOCK
+ * blocks and the sum of absolute differences (SAD) of every block is taken
+ * against the previous plane and against an adaptive background model. A
+ * block whose background SAD exceeds a threshold derived from its own noise
+ * level is active; active blocks are grouped into regions with bounding
+ * boxes in full-resolution pixels. The background learns slowly under moving
+ * blocks, normally under still ones, and fast under blocks that differ from
+ * it but stopped changing between frames (the ghost an object leaves behind,
+ * or an object that came to rest), so neither keeps firing.
+ *
+ * A MotionBoard publishes the latest event to other threads (overlay
+ * drawing, record triggering) without making them wait on the detector.
+ */
+#ifndef MOTION_H
+#define MOTION_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MD_BLOCK 16          /**< Block edge on the analysis plane (pixels) */
+#define MD_MAX_REGIONS 8     /**< Regions reported per event */
+#define MD_DEFAULT_SHIFT 2   /**< Default downsample: 1 << 2 = 4 per axis */
+
+  /**
+   * @struct MotionConfig
+   * @brief Detector tuning. Zero-initialized fields take the defaults.
+   */
+  typedef struct MotionConfig
+  {
+    int downsample_shift;  /**< log2 of the downsample factor (1..3, default 2) */
+    int min_mean_diff;     /**< Minimum mean |diff| per pixel for an active block (default 6) */
+    int noise_gain;        /**< Threshold = noise * gain / 4 (default 12, i.e. 3x noise) */
+    int bg_shift_still;    /**< Background learning rate for still blocks, 1/2^n (default 4) */
+    int bg_shift_moving;   /**< Background learning rate for moving blocks, 1/2^n (default 8) */
+    int bg_shift_static;   /**< Learning rate for foreground that stopped moving, 1/2^n (default 2) */
+    int min_blocks;        /**< Active blocks needed to report motion (default 2) */
+    int hold_frames;       /**< Frames motion stays reported after it stops (default 15) */
+  } MotionConfig;
+
+  /**
+   * @struct MotionRegion
+   * @brief Bounding box of connected active blocks, in frame pixels.
+   */
+  typedef struct MotionRegion
+  {
+    int x;       /**< Left */
+    int y;       /**< Top */
+    int w;       /**< Width */
+    int h;       /**< Height */
+    int blocks;  /**< Active blocks in the region */
+    float score; /**< Mean per-pixel |diff| against the background */
+  } MotionRegion;
+
+  /**
+   * @struct MotionEvent
+   * @brief Detector output for one frame.
+   */
+  typedef struct MotionEvent
+  {
+    size_t seq;                            /**< Frame sequence number */
+    bool active;                           /**< Motion present (with hold) */
+    bool started;                          /**< First frame of a motion episode */
+    bool ended;                            /**< First frame after an episode ended */
+    float score;                           /**< Fraction of active blocks (0..1) */
+    int nregions;                          /**< Valid entries in regions */
+    MotionRegion regions[MD_MAX_REGIONS];  /**< Largest regions first */
+  } MotionEvent;
+
+  /**
+   * @struct MotionDetector
+   * @brief Detector state: analysis planes, background and per-block statistics.
+   */
+  typedef struct MotionDetector
+  {
+    MotionConfig cfg; /**< Effective configuration */
+    int src_w;        /**< Input frame width */
+    int src_h;        /**< Input frame height */
+    int w;            /**< Analysis plane width */
+    int h;            /**< Analysis plane height */
+    int bw;           /**< Blocks per row */
+    int bh;           /**< Block rows */
+    uint16_t *acc;    /**< Column sums used while downsampling (w << shift) */
+    uint8_t *cur;     /**< Current analysis plane (w*h) */
+    uint8_t *prev;    /**< Previous analysis plane */
+    uint16_t *bg;     /**< Background model, 8.8 fixed point */
+    uint8_t *bg8;     /**< Background rounded to 8 bit for SAD */
+    uint32_t *noise;  /**< Per-block SAD noise estimate, 8.8 fixed point */
+    uint32_t *sad;    /**< Per-block background SAD of the last frame */
+    uint8_t *recent;  /**< Per-block countdown since it last differed from the previous plane */
+    uint8_t *active;  /**< Per-block active flag / region label scratch */
+    int *stack;       /**< Flood-fill scratch (bw*bh) */
+    size_t frames;    /**< Frames processed */
+    int hold;         /**< Remaining hold frames */
+  } MotionDetector;
+
+  /**
+   * @struct MotionBoard
+   * @brief Latest motion event shared between threads.
+   */
+  typedef struct MotionBoard
+  {
+    pthread_mutex_t mutex;         /**< Protects last */
+    MotionEvent last;              /**< Most recent event */
+    atomic_bool active;            /**< last.active, readable without the lock */
+    atomic_size_t last_motion_seq; /**< Sequence of the last frame with motion */
+    atomic_bool seen;              /**< Any motion reported yet */
+  } MotionBoard;
+
+  /**
+   * @brief Create a detector for frames of @p width x @p height gray pixels.
+   * @param[in] width  Frame width (>0).
+   * @param[in] height Frame height (>0).
+   * @param[in] cfg    Configuration (NULL for defaults).
+   * @return Pointer to MotionDetector or NULL (errno set).
+   */
+  MotionDetector *md_create(int width, int height, const MotionConfig *cfg);
+
+  /**
+   * @brief Free a detector.
+   * @param[in,out] md Detector pointer (NULL safe).
+   */
+  void md_destroy(MotionDetector *md);
+
+  /**
+   * @brief Analyze one frame.
+   * @param[in,out] md   Detector.
+   * @param[in]     gray Frame pixels (src_w*src_h, one byte per pixel).
+   * @param[in]     seq  Frame sequence number.
+   * @param[out]    ev   Event for this frame (>NULL).
+   * @return 1 if motion is reported, 0 if not, -1 on invalid arguments (errno set).
+   */
+  int md_process(MotionDetector *md, const uint8_t *gray, size_t seq, MotionEvent *ev);
+
+  /**
+   * @brief Sum of absolute differences of a @p w x @p h block.
+   *
+   * Uses SSE2 (psadbw) or NEON when available, a scalar loop otherwise.
+   * @param[in] a,b     Top-left pixels of the two blocks.
+   * @param[in] stride  Row stride of both planes.
+   * @param[in] w,h     Block size.
+   * @return SAD.
+   */
+  uint32_t md_sad_block(const uint8_t *a, const uint8_t *b, int stride, int w, int h);
+
+  /**
+   * @brief Initialize a board.
+   * @param[out] board Board to initialize (>NULL).
+   */
+  void md_board_init(MotionBoard *board);
+
+  /**
+   * @brief Destroy a board.
+   * @param[in,out] board Board pointer (NULL safe).
+   */
+  void md_board_destroy(MotionBoard *board);
+
+  /**
+   * @brief Publish an event.
+   * @param[in,out] board Board.
+   * @param[in]     ev    Event to publish.
+   */
+  void md_board_publish(MotionBoard *board, const MotionEvent *ev);
+
+  /**
+   * @brief Copy the most recent event.
+   * @param[in]  board Board.
+   * @param[out] ev    Destination.
+   */
+  void md_board_snapshot(MotionBoard *board, MotionEvent *ev);
+
+  /**
+   * @brief Whether motion was seen within @p window frames before @p seq.
+   * @param[in] board  Board (NULL: false).
+   * @param[in] seq    Current frame sequence.
+   * @param[in] window Frames of history to accept.
+   * @return true if recent motion was reported.
+   */
+  bool md_board_recent(MotionBoard *board, size_t seq, size_t window);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOTION_H
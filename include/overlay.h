@@ -0,0 +1,144 @@
+/*
+ * @file overlay.h
+ * @brief Retained ARGB overlay layer with dirty-rectangle tracking
+ *
+ * UI elements are drawn once into an off-screen ARGB8888 layer. Drawing calls
+ * only record dirty rectangles; ovl_update() rescans those rectangles and
+ * keeps, per row, the horizontal extent of non-transparent pixels.
+ * ovl_composite() then alpha-blends just those extents over the framebuffer
+ * in one pass, so the per-frame cost is the blend of the rows the UI covers
+ * rather than a full redraw of every widget.
+ */
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fbDraw.h"
+#include "glyph.h"
+
+#define OVL_MAX_DIRTY 16 /**< Dirty rectangles kept before merging into one */
+
+/** Pack an ARGB8888 color for the overlay layer. */
+#define OVL_ARGB(a, r, g, b)                                                                       \
+  (((uint32_t)(ubyte)(a) << 24) | ((uint32_t)(ubyte)(r) << 16) | ((uint32_t)(ubyte)(g) << 8) |    \
+   (uint32_t)(ubyte)(b))
+
+  /**
+   * @struct OvlRect
+   * @brief Axis-aligned rectangle in layer coordinates.
+   */
+  typedef struct OvlRect
+  {
+    int x; /**< Left */
+    int y; /**< Top */
+    int w; /**< Width */
+    int h; /**< Height */
+  } OvlRect;
+
+  /**
+   * @struct OvlRowExtent
+   * @brief Columns [x0, x1) of one row holding non-transparent pixels.
+   */
+  typedef struct OvlRowExtent
+  {
+    int16_t x0; /**< First covered column */
+    int16_t x1; /**< One past the last covered column (x0 == x1: empty row) */
+  } OvlRowExtent;
+
+  /**
+   * @struct OverlayLayer
+   * @brief Retained UI layer composited over the video.
+   */
+  typedef struct OverlayLayer
+  {
+    int w;                           /**< Layer width */
+    int h;                           /**< Layer height */
+    uint32_t *argb;                  /**< w*h ARGB8888 pixels (straight alpha) */
+    OvlRowExtent *rows;              /**< Per-row covered extent */
+    int row_first;                   /**< First row with content */
+    int row_last;                    /**< One past the last row with content */
+    OvlRect dirty[OVL_MAX_DIRTY];    /**< Regions changed since ovl_update() */
+    int ndirty;                      /**< Number of dirty rectangles */
+  } OverlayLayer;
+
+  /**
+   * @brief Allocate a fully transparent layer.
+   * @param[in] w Width in pixels (>0).
+   * @param[in] h Height in pixels (>0).
+   * @return Pointer to OverlayLayer or NULL (errno set).
+   */
+  OverlayLayer *ovl_create(int w, int h);
+
+  /**
+   * @brief Free a layer.
+   * @param[in,out] ovl Layer pointer (NULL safe).
+   */
+  void ovl_destroy(OverlayLayer *ovl);
+
+  /**
+   * @brief Record a changed region (clipped to the layer).
+   * @param[in,out] ovl Layer.
+   * @param[in]     r   Region.
+   */
+  void ovl_mark_dirty(OverlayLayer *ovl, OvlRect r);
+
+  /**
+   * @brief Fill a rectangle with @p argb (alpha 0 clears it).
+   * @param[in,out] ovl  Layer.
+   * @param[in]     r    Rectangle.
+   * @param[in]     argb Color from OVL_ARGB().
+   */
+  void ovl_fill_rect(OverlayLayer *ovl, OvlRect r, uint32_t argb);
+
+  /**
+   * @brief Draw a one-pixel rectangle outline.
+   * @param[in,out] ovl  Layer.
+   * @param[in]     r    Rectangle.
+   * @param[in]     argb Color from OVL_ARGB().
+   */
+  void ovl_draw_rect(OverlayLayer *ovl, OvlRect r, uint32_t argb);
+
+  /**
+   * @brief Draw a prepared text run into the layer.
+   * @param[in,out] ovl  Layer.
+   * @param[in]     run  Text laid out with text_run_init().
+   * @param[in]     x,y  Top-left position.
+   * @param[in]     argb Color from OVL_ARGB().
+   */
+  void ovl_draw_text(OverlayLayer *ovl, const TextRun *run, int x, int y, uint32_t argb);
+
+  /**
+   * @brief Rescan dirty rectangles and refresh per-row extents.
+   * @param[in,out] ovl Layer.
+   * @return Number of dirty rectangles that were processed.
+   */
+  int ovl_update(OverlayLayer *ovl);
+
+  /**
+   * @brief Alpha-blend the layer's covered extents over a framebuffer.
+   *
+   * Pending dirty rectangles are folded in first. Fully transparent rows are
+   * skipped; 32bpp XRGB targets use a branch-free two-channels-per-multiply
+   * blend, other formats go through the vinfo bitfields.
+   * @param[in]     ovl Layer.
+   * @param[in,out] fb  Target framebuffer (16 or 32 bpp).
+   * @param[in]     ox,oy Position of the layer's top-left corner on @p fb.
+   * @return Number of rows blended.
+   */
+  int ovl_composite(OverlayLayer *ovl, dev_fb *fb, int ox, int oy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OVERLAY_H
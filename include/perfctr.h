@@ -0,0 +1,136 @@
+/*
+ * @file perfctr.h
+ * @brief Per-thread hardware counters (perf_event_open) attributed to pipeline stages
+ *
+ * A stage thread opens one counter group for itself (cycles, instructions,
+ * cache misses, branch misses, page faults) and brackets each unit of work
+ * with perf_stage_begin() / perf_stage_end(); the deltas are summed with the
+ * number of frames the unit covered, so the report is per frame. Low IPC
+ * with many cache misses per instruction points at a memory-bound stage.
+ *
+ * Only the calling thread is counted: work handed to pool workers (render
+ * bands, encoder slices) is not included. Events the kernel or the board
+ * does not provide (no PMU in a VM, perf_event_paranoid) are left out; a
+ * stage without any event turns begin/end into no-ops.
+ */
+#ifndef PERFCTR_H
+#define PERFCTR_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+  /**
+   * @enum PerfEvent
+   * @brief Counters a stage can have.
+   */
+  typedef enum PerfEvent
+  {
+    PERF_CYCLES,        /**< CPU cycles (user space) */
+    PERF_INSTRUCTIONS,  /**< Retired instructions */
+    PERF_CACHE_MISSES,  /**< Last-level cache misses */
+    PERF_BRANCH_MISSES, /**< Mispredicted branches */
+    PERF_PAGE_FAULTS,   /**< Page faults (software event) */
+    PERF_NEVENTS
+  } PerfEvent;
+
+  /**
+   * @struct PerfStage
+   * @brief Counter group of one thread and the totals attributed to it.
+   */
+  typedef struct PerfStage
+  {
+    const char *name;             /**< Stage name used in reports */
+    int fd[PERF_NEVENTS];         /**< Counter fds (-1: not available) */
+    int slot[PERF_NEVENTS];       /**< Position in a group read (-1: not available) */
+    int nslots;                   /**< Events opened (0: counting disabled) */
+    uint64_t start[PERF_NEVENTS]; /**< Values at perf_stage_begin() */
+    uint64_t total[PERF_NEVENTS]; /**< Summed deltas */
+    uint64_t frames;              /**< Frames the deltas cover */
+    uint64_t spans;               /**< begin/end pairs */
+    bool multiplexed;             /**< Some span was scaled because the PMU was shared */
+  } PerfStage;
+
+  /**
+   * @brief Set up a stage with no counters (begin/end are no-ops, reports are empty).
+   * @param[out] st   Stage.
+   * @param[in]  name Stage name (kept, not copied).
+   */
+  void perf_stage_init(PerfStage *st, const char *name);
+
+  /**
+   * @brief Open the counter group for the calling thread.
+   *
+   * Call from the thread to be measured. Kernel code is excluded so the
+   * default perf_event_paranoid of 2 is enough.
+   * @param[out] st   Stage.
+   * @param[in]  name Stage name (kept, not copied).
+   * @return Number of events opened; -1 if none could be (errno set), in
+   *         which case @p st is still safe to use and to close.
+   */
+  int perf_stage_open(PerfStage *st, const char *name);
+
+  /**
+   * @brief Close the counters; totals stay readable.
+   * @param[in,out] st Stage (NULL safe).
+   */
+  void perf_stage_close(PerfStage *st);
+
+  /**
+   * @brief Start a unit of work.
+   * @param[in,out] st Stage.
+   */
+  void perf_stage_begin(PerfStage *st);
+
+  /**
+   * @brief Finish a unit of work and attribute it to @p frames frames.
+   * @param[in,out] st     Stage.
+   * @param[in]     frames Frames processed since perf_stage_begin().
+   */
+  void perf_stage_end(PerfStage *st, unsigned frames);
+
+  /**
+   * @brief Whether an event is counted.
+   * @param[in] st Stage.
+   * @param[in] ev Event.
+   */
+  bool perf_stage_has(const PerfStage *st, PerfEvent ev);
+
+  /**
+   * @brief Average of an event per attributed frame.
+   * @param[in] st Stage.
+   * @param[in] ev Event.
+   * @return Count per frame; -1 if the event is not counted or no frame was.
+   */
+  double perf_stage_per_frame(const PerfStage *st, PerfEvent ev);
+
+  /**
+   * @brief Short name of an event ("cycles", "instructions", ...).
+   */
+  const char *perf_event_name(PerfEvent ev);
+
+  /**
+   * @brief Print one line: per-frame counts, IPC and cache misses per 1k instructions.
+   * @param[in] st  Stage.
+   * @param[in] out Stream (NULL: stderr).
+   */
+  void perf_stage_report(const PerfStage *st, FILE *out);
+
+  /**
+   * @brief Write the per-frame counts as a JSON object ("null" when nothing was counted).
+   * @param[in] st  Stage.
+   * @param[in] out Stream.
+   */
+  void perf_stage_write_json(const PerfStage *st, FILE *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERFCTR_H
@@ -1,6 +1,17 @@
 /*
  * @file queue.h
  * @brief Thread-safe fixed-size FIFO queue
+ *
+ * enqueue()/dequeue() are the raw ring operations for callers that hold the
+ * mutex themselves. The *_wait and *_n functions lock, wait (with an
+ * optional timeout), move one or up to n items and wake the other side once.
+ * After queue_set_done() producers fail with ECANCELED and consumers drain
+ * what is left, then fail the same way.
+ *
+ * What a producer does when the queue is full is the queue's policy
+ * (queue_set_policy()): wait, refuse the new item, or evict queued items
+ * through a drop callback so the producer never waits on a slow consumer.
+ * Refused and evicted items are counted per queue.
  */
 #ifndef QUEUE_H
 #define QUEUE_H
@@ -11,9 +22,32 @@ extern "C"
 #endif
 
 #include "util.h"
+#include <errno.h>
 #include <pthread.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <time.h>
+
+#define QUEUE_WAIT_FOREVER (-1) /**< timeout_ms: block until possible or done */
+
+  /**
+   * @enum QueuePolicy
+   * @brief What enqueue does when the queue is full.
+   */
+  typedef enum QueuePolicy
+  {
+    QUEUE_BLOCK,       /**< Wait up to timeout_ms (lossless, producer follows the consumer) */
+    QUEUE_DROP_NEWEST, /**< Refuse the new item at once (EAGAIN); the caller keeps it */
+    QUEUE_DROP_OLDEST, /**< Evict the oldest queued item to make room */
+    QUEUE_LATEST_ONLY  /**< Evict everything queued: the consumer only sees the newest item */
+  } QueuePolicy;
+
+  /**
+   * @brief Takes ownership of an item evicted by QUEUE_DROP_OLDEST / QUEUE_LATEST_ONLY.
+   *
+   * Called with the queue locked: it must not use the same queue.
+   */
+  typedef void (*QueueDropFn)(void *item, void *ctx);
 
   /**
    * @struct Queue
@@ -25,11 +59,17 @@ extern "C"
     size_t head;                   /**< Dequeue index (0 <= head < capacity) */
     size_t tail;                   /**< Enqueue index (0 <= tail < capacity) */
     size_t capacity;               /**< Max number of items */
+    size_t limit;                  /**< Items allowed now (<= capacity) */
     size_t count;                  /**< Current number of items */
+    size_t peak;                   /**< Highest count since the last queue_take_peak() */
     pthread_mutex_t mutex;         /**< Protects queue fields */
     pthread_cond_t cond_not_full;  /**< Signaled when space available */
     pthread_cond_t cond_not_empty; /**< Signaled when items available */
     volatile bool done;            /**< Shutdown flag to unblock waiters */
+    QueuePolicy policy;            /**< Behaviour when full (default QUEUE_BLOCK) */
+    QueueDropFn drop_fn;           /**< Receives evicted items */
+    void *drop_ctx;                /**< Passed to drop_fn */
+    size_t dropped;                /**< Items refused or evicted so far */
   } Queue;
 
   /**
@@ -53,7 +93,7 @@ extern "C"
   int is_empty(const Queue *queue);
 
   /**
-   * @brief Check if queue is full.
+   * @brief Check if queue holds as many items as its limit allows.
    * @param[in] queue Queue pointer (NULL safe).
    * @return true if full or q is NULL.
    */
@@ -73,6 +113,91 @@ extern "C"
    */
   void *dequeue(Queue *queue);
 
+  /**
+   * @brief Enqueue one item, following the queue's policy when it is full.
+   * @param[in,out] queue      Queue pointer (>NULL).
+   * @param[in]     item       Item pointer to enqueue.
+   * @param[in]     timeout_ms Max wait in ms for QUEUE_BLOCK (0: try only,
+   *                           QUEUE_WAIT_FOREVER: no limit); other policies never wait.
+   * @return 0 on success; -1 with errno ETIMEDOUT (full), EAGAIN (refused by
+   *         QUEUE_DROP_NEWEST) or ECANCELED (done). On -1 the caller still owns @p item.
+   */
+  int enqueue_wait(Queue *queue, void *item, int timeout_ms);
+
+  /**
+   * @brief Blocking dequeue of one item.
+   * @param[in,out] queue      Queue pointer (>NULL).
+   * @param[in]     timeout_ms Max wait in ms (0: try only, QUEUE_WAIT_FOREVER: no limit).
+   * @return Item; NULL with errno ETIMEDOUT (empty) or ECANCELED (done and drained).
+   */
+  void *dequeue_wait(Queue *queue, int timeout_ms);
+
+  /**
+   * @brief Enqueue up to @p n items under one lock, waiting only for the first slot.
+   *
+   * With QUEUE_DROP_OLDEST / QUEUE_LATEST_ONLY every item is taken and queued
+   * ones are evicted instead (items of the same call included).
+   * @param[in,out] queue      Queue pointer (>NULL).
+   * @param[in]     items      Items, enqueued in order.
+   * @param[in]     n          Number of items.
+   * @param[in]     timeout_ms Max wait for a free slot in ms (0: try only, QUEUE_WAIT_FOREVER).
+   * @return Items enqueued (a prefix of @p items); 0 with errno ETIMEDOUT,
+   *         EAGAIN or ECANCELED.
+   */
+  size_t enqueue_n(Queue *queue, void *const *items, size_t n, int timeout_ms);
+
+  /**
+   * @brief Dequeue up to @p max items under one lock, waiting only for the first.
+   * @param[in,out] queue      Queue pointer (>NULL).
+   * @param[out]    items      Receives the items in FIFO order.
+   * @param[in]     max        Capacity of @p items.
+   * @param[in]     timeout_ms Max wait for an item in ms (0: try only, QUEUE_WAIT_FOREVER).
+   * @return Items dequeued; 0 with errno ETIMEDOUT or ECANCELED (done and drained).
+   */
+  size_t dequeue_n(Queue *queue, void **items, size_t max, int timeout_ms);
+
+  /**
+   * @brief Change how many items the queue accepts before producers wait.
+   *
+   * Items already queued above a lowered limit stay and drain normally.
+   * @param[in,out] queue Queue pointer (>NULL).
+   * @param[in]     limit New limit (clamped to capacity).
+   * @return 0 on success; -1 if @p limit is 0 (errno EINVAL).
+   */
+  int queue_set_limit(Queue *queue, size_t limit);
+
+  /**
+   * @brief Highest depth since the previous call; restarts from the current depth.
+   * @param[in,out] queue Queue pointer (>NULL).
+   * @return Peak number of queued items.
+   */
+  size_t queue_take_peak(Queue *queue);
+
+  /**
+   * @brief Choose what enqueue does when the queue is full.
+   *
+   * Meant for setup: a producer already waiting under QUEUE_BLOCK keeps waiting.
+   * @param[in,out] queue  Queue pointer (>NULL).
+   * @param[in]     policy Policy.
+   * @param[in]     drop   Owner of evicted items (required by QUEUE_DROP_OLDEST
+   *                       and QUEUE_LATEST_ONLY).
+   * @param[in]     ctx    Passed to @p drop.
+   * @return 0 on success; -1 on a bad policy or a missing @p drop (errno EINVAL).
+   */
+  int queue_set_policy(Queue *queue, QueuePolicy policy, QueueDropFn drop, void *ctx);
+
+  /**
+   * @brief Items refused (full, timed out) or evicted so far.
+   * @param[in] queue Queue pointer (NULL safe).
+   * @return Drop count.
+   */
+  size_t queue_drop_count(const Queue *queue);
+
+  /**
+   * @brief Name of a policy ("block", "drop-newest", "drop-oldest", "latest-only").
+   */
+  const char *queue_policy_name(QueuePolicy policy);
+
   /**
    * @brief Signal shutdown, unblocking all waiting threads.
    * @param[in,out] queue Queue pointer (>NULL).
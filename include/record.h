@@ -6,6 +6,9 @@
 extern "C"
 {
 #endif
+#include "container.h"
+#include "encoder.h"
+#include "motion.h"
 #include "thread_arg.h"
 #include <errno.h>
 #include <fcntl.h>
@@ -13,13 +16,85 @@ extern "C"
 #include <stdlib.h>
 #include <unistd.h>
 
+#define RECORD_ON_MOTION 0      /**< 1: write only frames near detected motion */
+#define RECORD_MOTION_WINDOW 90 /**< Frames kept after the last motion (~3s at 30fps) */
+
+#define RECORD_GATE 1                  /**< 1: store a frame only when the scene changed */
+#define RECORD_KEEPALIVE_FRAMES 150    /**< Store at least one frame this often (~5s at 30fps) */
+#define RECORD_FRAME_INTERVAL_US 33333 /**< Capture period written to the file header */
+#define RECORD_SAMPLE_ROW_STEP 8       /**< Change metric looks at every Nth row */
+#define RECORD_SAMPLE_SEG 64           /**< Pixels per compared row segment */
+#define RECORD_CHANGE_MEAN 10          /**< Mean |diff| that marks a segment as changed */
+#define RECORD_CHANGE_SEGMENTS 4       /**< Changed segments that mark the frame as changed */
+
+#define RECORD_CODEC 1           /**< 1: store frames XOR-delta + RLE coded (codec.h), 0: raw */
+#define RECORD_CODEC_SLICES 8    /**< Independently coded slices per frame */
+#define RECORD_KEY_INTERVAL 30   /**< Stored records between key frames */
+#define RECORD_ENCODE_THREADS 0  /**< Slice encoder threads when no shared encode pool is given (0: online CPUs) */
+#define RECORD_ENCODE_INFLIGHT 4 /**< Frames coded concurrently before the oldest is waited for */
+#define RECORD_BATCH_MAX 8       /**< Queued frames taken (and written) per record-thread pass */
+
+#define RECORD_SYNC_FRAMES 30     /**< Make the recording durable at least every N records (0: off) */
+#define RECORD_SYNC_MS 1000       /**< ... and at least every N ms, also while the scene is idle */
+#define RECORD_SYNC_WRITEBACK 1   /**< 1: start writeback right after each record (sync_file_range) */
+#define RECORD_SYNC_BACKGROUND 1  /**< 1: fdatasync on a helper thread, not the record thread */
+#define RECORD_KEEP_PREVIOUS 1    /**< 1: recover the last recording and keep it as *.prev */
+
+#define RECORD_IO_MODE TBB_IO_DIRECT    /**< Data path (TbbIoMode); direct falls back to DONTNEED */
+#define RECORD_IO_WRITE_SIZE (1u << 20) /**< O_DIRECT write size */
+
+  /**
+   * @struct RecordGate
+   * @brief Decides which frames are stored; the last stored frame itself is
+   *        kept by the encoder (fe_last_frame()).
+   */
+  typedef struct RecordGate
+  {
+    size_t width;       /**< Frame width */
+    size_t height;      /**< Frame height */
+    bool have_last;     /**< A frame was stored since the last reset */
+    size_t last_seq;    /**< seq of the last stored frame */
+    size_t seen_seq;    /**< seq of the last frame offered */
+    size_t since_key;   /**< Records stored since the last key frame */
+    size_t stored;      /**< Frames stored */
+    size_t dropped;     /**< Frames skipped as unchanged */
+  } RecordGate;
+
+  /**
+   * @brief Count changed row segments between two gray frames.
+   *
+   * Samples every RECORD_SAMPLE_ROW_STEP-th row in RECORD_SAMPLE_SEG pixel
+   * segments and counts segments whose mean |diff| exceeds
+   * RECORD_CHANGE_MEAN, so a small moving object is not averaged away.
+   * @param[in] a,b    Frames of width*height bytes.
+   * @param[in] width  Frame width.
+   * @param[in] height Frame height.
+   * @return Number of changed segments.
+   */
+  size_t record_change_score(const uint8_t *a, const uint8_t *b, size_t width, size_t height);
+
+  /**
+   * @brief Initialize a gate for frames of the given size.
+   * @param[out] gate   Gate (>NULL).
+   * @param[in]  width  Frame width (>0).
+   * @param[in]  height Frame height (>0).
+   * @return 0 on success; -1 on failure (errno set).
+   */
+  int record_gate_init(RecordGate *gate, size_t width, size_t height);
+
+  /**
+   * @brief Forget the reference frame; the next frame is always stored.
+   * @param[in,out] gate Gate.
+   */
+  void record_gate_reset(RecordGate *gate);
+
   /**
    * @brief Start the record thread.
-   * @param[in] arg Shared context pointer.
+   * @param[in] arg Stream context of the feed to record.
    * @param[out] tid Thread identifier output.
    * @return true if thread created; false on error.
    */
-  bool record_run(SharedCtx *arg, pthread_t *tid);
+  bool record_run(StreamCtx *arg, pthread_t *tid);
 
   /**
    * @brief Create (or truncate) raw video file and write header.
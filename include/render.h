@@ -0,0 +1,124 @@
+/*
+ * @file render.h
+ * @brief Banded multi-threaded framebuffer rendering
+ *
+ * The output frame is cut into horizontal bands, one per thread. Worker
+ * threads are persistent and synchronized with two barriers per frame
+ * (start, done); the calling thread renders band 0 itself. Each band writes a
+ * disjoint row range of the framebuffer mapping, so no locking is needed
+ * while drawing.
+ */
+#ifndef RENDER_H
+#define RENDER_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fbDraw.h"
+#include "scale.h"
+
+#define RENDER_MAX_THREADS 16           /**< Upper bound on band threads */
+#define RENDER_MT_MIN_PIXELS (1280 * 720) /**< Below this output size render single-threaded */
+
+  struct BandRenderer;
+
+  /**
+   * @struct BandWorker
+   * @brief Per-band worker state.
+   */
+  typedef struct BandWorker
+  {
+    struct BandRenderer *br; /**< Owning renderer */
+    int band;                /**< Band index handled by this worker */
+    pthread_t tid;           /**< Thread handle */
+  } BandWorker;
+
+  /**
+   * @struct BandRenderer
+   * @brief Persistent band threads plus the job of the current frame.
+   */
+  typedef struct BandRenderer
+  {
+    int nthreads;              /**< Bands per frame (caller included) */
+    size_t min_pixels;         /**< Output size threshold for multi-threading */
+    BandWorker *workers;       /**< nthreads - 1 worker threads */
+    pthread_barrier_t start;   /**< Releases workers for a new frame */
+    pthread_barrier_t done;    /**< Joins workers after their band */
+    volatile bool quit;        /**< Shutdown flag (read after start barrier) */
+    bool ready;                /**< Barriers initialized; workers may enter */
+    pthread_mutex_t mutex;     /**< Protects ready during startup */
+    pthread_cond_t cond;       /**< Signals ready */
+
+    /* current job, written by the caller before the start barrier */
+    dev_fb *fb;        /**< Target framebuffer */
+    const ubyte *gray; /**< Source gray frame */
+    int raw_w;         /**< Source width */
+    int raw_h;         /**< Source height */
+    int result[RENDER_MAX_THREADS]; /**< Per-band return codes */
+
+    /* filtered scaling (mode != SCALE_NEAREST) */
+    ScaleMode mode;                      /**< Display scaling filter */
+    Scaler scaler;                       /**< Tables for the current geometry */
+    uint32_t lut[256];                   /**< Gray → native pixel */
+    ubyte *line[RENDER_MAX_THREADS];     /**< Per-band scaled row */
+    uint16_t *tmp[RENDER_MAX_THREADS];   /**< Per-band vertical-pass scratch */
+    size_t line_cap;                     /**< Allocated bytes per line[] */
+    size_t tmp_cap;                      /**< Allocated entries per tmp[] */
+  } BandRenderer;
+
+  /**
+   * @brief Create a band renderer.
+   * @param[in] nthreads   Bands (threads incl. the caller); 0 selects online CPUs.
+   * @param[in] min_pixels Output pixel count below which frames render on the caller only.
+   * @return Pointer to BandRenderer or NULL (errno set).
+   */
+  BandRenderer *br_create(int nthreads, size_t min_pixels);
+
+  /**
+   * @brief Stop band threads and free the renderer.
+   * @param[in,out] br Renderer pointer (NULL safe).
+   */
+  void br_destroy(BandRenderer *br);
+
+  /**
+   * @brief Scale and convert a gray frame into the framebuffer, band-parallel.
+   *
+   * With SCALE_NEAREST this is equivalent to fb_drawGray(). Small outputs and
+   * single-thread renderers draw on the caller only. Must be called from one
+   * thread at a time.
+   * @param[in,out] br    Renderer (NULL: single-threaded).
+   * @param[in,out] fb    Initialized framebuffer.
+   * @param[in]     gray  Source frame (raw_w * raw_h bytes).
+   * @param[in]     raw_w Source width.
+   * @param[in]     raw_h Source height.
+   * @return 0 on success; negative fb_drawGray() error code on failure.
+   */
+  int br_draw_gray(BandRenderer *br, dev_fb *fb, const ubyte *gray, int raw_w, int raw_h);
+
+  /**
+   * @brief Select the scaling filter used by br_draw_gray().
+   * @param[in,out] br   Renderer (>NULL).
+   * @param[in]     mode SCALE_NEAREST (default), SCALE_BILINEAR or SCALE_AREA.
+   */
+  void br_set_scale_mode(BandRenderer *br, ScaleMode mode);
+
+  /**
+   * @brief Number of bands (threads including the caller).
+   * @param[in] br Renderer pointer (NULL safe).
+   * @return Band count; 1 if br NULL.
+   */
+  int br_thread_count(const BandRenderer *br);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RENDER_H
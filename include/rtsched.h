@@ -0,0 +1,105 @@
+/*
+ * @file rtsched.h
+ * @brief CPU affinity, scheduling policy and priority of pipeline threads
+ *
+ * Each pipeline thread calls rt_thread_setup() first thing with its own
+ * RtSched: a CPU mask, SCHED_OTHER with a nice value or SCHED_FIFO / SCHED_RR
+ * with a static priority. Pool workers the thread creates afterwards (render
+ * bands, mosaic workers) inherit the same settings. What the kernel refuses
+ * (real-time priority or negative nice without CAP_SYS_NICE / RLIMIT_RTPRIO,
+ * CPUs that are offline) is reported and the thread goes on with what it has.
+ *
+ * The setup then measures the thread's wakeup latency: it sleeps until a
+ * series of absolute deadlines and records how late each wakeup was, the
+ * way cyclictest does, so a configuration can be checked on the board.
+ */
+#ifndef RTSCHED_H
+#define RTSCHED_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <errno.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RT_CPUS_ANY 0 /**< Affinity mask that leaves placement to the scheduler */
+
+  /**
+   * @struct RtSched
+   * @brief Scheduling of one thread.
+   */
+  typedef struct RtSched
+  {
+    uint64_t cpus; /**< Bit i allows CPU i (RT_CPUS_ANY: no restriction) */
+    int policy;    /**< SCHED_OTHER, SCHED_FIFO or SCHED_RR */
+    int priority;  /**< Static priority for FIFO/RR (1..99) */
+    int nice;      /**< Nice value for SCHED_OTHER (-20..19) */
+  } RtSched;
+
+/** SCHED_OTHER on @p cpus with nice @p nice */
+#define RT_SCHED_OTHER(cpus, nice) ((RtSched){(uint64_t)(cpus), SCHED_OTHER, 0, (nice)})
+/** SCHED_FIFO on @p cpus with priority @p prio */
+#define RT_SCHED_FIFO(cpus, prio) ((RtSched){(uint64_t)(cpus), SCHED_FIFO, (prio), 0})
+
+  /**
+   * @struct RtLatency
+   * @brief Wakeup lateness over a series of timed sleeps.
+   */
+  typedef struct RtLatency
+  {
+    int samples;   /**< Sleeps measured */
+    double avg_us; /**< Mean lateness */
+    double p99_us; /**< 99th percentile */
+    double max_us; /**< Worst wakeup */
+  } RtLatency;
+
+  /**
+   * @brief Apply @p cfg to the calling thread, as much as the kernel allows.
+   * @param[in] cfg Scheduling.
+   * @return 0 if everything was applied; -1 otherwise (errno of the first
+   *         refusal; the remaining settings are still tried).
+   */
+  int rt_apply(const RtSched *cfg);
+
+  /**
+   * @brief Measure the calling thread's wakeup latency.
+   * @param[in]  samples   Sleeps (>0).
+   * @param[in]  period_us Interval between deadlines (>0).
+   * @param[out] out       Result.
+   * @return 0 on success; -1 on bad arguments or no memory (errno set).
+   */
+  int rt_measure_latency(int samples, int period_us, RtLatency *out);
+
+  /**
+   * @brief Name the thread, apply @p cfg and report it with its measured latency.
+   *
+   * Prints one line to stderr: the scheduling in effect, the CPUs and the
+   * wakeup latency (skipped when @p samples is 0).
+   * @param[in] cfg       Scheduling.
+   * @param[in] name      Thread name (first 15 characters are used for the thread).
+   * @param[in] samples   Latency samples (0: do not measure).
+   * @param[in] period_us Interval between latency samples.
+   */
+  void rt_thread_setup(const RtSched *cfg, const char *name, int samples, int period_us);
+
+  /**
+   * @brief Lock current and future memory of the process (mlockall).
+   * @return 0 on success; -1 on failure (errno set, e.g. EPERM or ENOMEM
+   *         under RLIMIT_MEMLOCK).
+   */
+  int rt_lock_memory(void);
+
+  /**
+   * @brief Name of a scheduling policy ("SCHED_OTHER", "SCHED_FIFO", ...).
+   */
+  const char *rt_policy_name(int policy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTSCHED_H
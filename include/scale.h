@@ -0,0 +1,137 @@
+/*
+ * @file scale.h
+ * @brief Fixed-point separable gray scalers (nearest, bilinear, area-average)
+ *
+ * A Scaler precomputes, for one source/destination geometry, the filter taps
+ * of every output column and row (Q8 coefficients summing to 256). Scaling is
+ * then two passes per output row: a vertical pass that blends the contributing
+ * source rows into a 16-bit line (contiguous, auto-vectorizable), and a
+ * horizontal pass that applies the column taps to that line.
+ */
+#ifndef SCALE_H
+#define SCALE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define SCALE_COEF_BITS 8                     /**< Coefficient precision (Q8) */
+#define SCALE_COEF_ONE (1 << SCALE_COEF_BITS) /**< Sum of the taps of one output */
+
+  /**
+   * @enum ScaleMode
+   * @brief Resampling filter.
+   */
+  typedef enum
+  {
+    SCALE_NEAREST,  /**< Nearest neighbour (no filtering) */
+    SCALE_BILINEAR, /**< 2x2 linear interpolation, pixel-center aligned */
+    SCALE_AREA      /**< Box filter: average of the covered source area */
+  } ScaleMode;
+
+  /**
+   * @struct ScaleTaps
+   * @brief Filter taps of one axis: output i reads source [start[i], start[i] + len[i]).
+   */
+  typedef struct ScaleTaps
+  {
+    int *start;     /**< First source index per output */
+    int *len;       /**< Tap count per output (1..max_taps) */
+    uint16_t *coef; /**< Q8 coefficients, n * max_taps (row-major) */
+    int max_taps;   /**< Stride of coef */
+  } ScaleTaps;
+
+  /**
+   * @struct Scaler
+   * @brief Precomputed coefficient tables for one geometry and mode.
+   */
+  typedef struct Scaler
+  {
+    ScaleMode mode; /**< Filter */
+    int src_w;      /**< Source width */
+    int src_h;      /**< Source height */
+    int dst_w;      /**< Destination width */
+    int dst_h;      /**< Destination height */
+    ScaleTaps x;    /**< Column taps (dst_w entries) */
+    ScaleTaps y;    /**< Row taps (dst_h entries) */
+  } Scaler;
+
+  /**
+   * @brief Build coefficient tables for a geometry.
+   * @param[out] sc    Scaler to initialize (>NULL).
+   * @param[in]  src_w Source width (>0).
+   * @param[in]  src_h Source height (>0).
+   * @param[in]  dst_w Destination width (>0).
+   * @param[in]  dst_h Destination height (>0).
+   * @param[in]  mode  Filter.
+   * @return 0 on success; -1 on failure (errno set).
+   */
+  int scaler_init(Scaler *sc, int src_w, int src_h, int dst_w, int dst_h, ScaleMode mode);
+
+  /**
+   * @brief Release coefficient tables.
+   * @param[in,out] sc Scaler pointer (NULL safe).
+   */
+  void scaler_free(Scaler *sc);
+
+  /**
+   * @brief Whether @p sc was built for exactly this geometry and mode.
+   * @param[in] sc Scaler pointer (NULL safe).
+   * @return non-zero if the tables can be reused.
+   */
+  int scaler_matches(const Scaler *sc, int src_w, int src_h, int dst_w, int dst_h,
+                     ScaleMode mode);
+
+  /**
+   * @brief Entries of scratch a caller must provide per concurrent row job.
+   * @param[in] sc Initialized scaler.
+   * @return Number of uint16_t elements (src_w).
+   */
+  size_t scaler_tmp_size(const Scaler *sc);
+
+  /**
+   * @brief Produce one destination row.
+   * @param[in]  sc         Initialized scaler.
+   * @param[in]  src        Source frame.
+   * @param[in]  src_stride Bytes between source rows.
+   * @param[in]  y          Destination row index (0 <= y < dst_h).
+   * @param[out] out        dst_w output bytes.
+   * @param[in]  tmp        Scratch of scaler_tmp_size() elements (unused for NEAREST).
+   */
+  void scaler_scale_row(const Scaler *sc, const uint8_t *src, size_t src_stride, int y,
+                        uint8_t *out, uint16_t *tmp);
+
+  /**
+   * @brief Produce destination rows [y_begin, y_end).
+   * @param[in]  sc         Initialized scaler.
+   * @param[in]  src        Source frame.
+   * @param[in]  src_stride Bytes between source rows.
+   * @param[out] dst        Destination frame (row 0).
+   * @param[in]  dst_stride Bytes between destination rows.
+   * @param[in]  y_begin    First row (inclusive).
+   * @param[in]  y_end      Last row (exclusive).
+   * @param[in]  tmp        Scratch of scaler_tmp_size() elements.
+   */
+  void scaler_scale_rows(const Scaler *sc, const uint8_t *src, size_t src_stride, uint8_t *dst,
+                         size_t dst_stride, int y_begin, int y_end, uint16_t *tmp);
+
+  /**
+   * @brief One-shot resize of a packed gray image (e.g. recorder thumbnails).
+   * @param[in]  src   Source (src_w * src_h bytes).
+   * @param[out] dst   Destination (dst_w * dst_h bytes).
+   * @return 0 on success; -1 on failure (errno set).
+   */
+  int scale_gray(const uint8_t *src, int src_w, int src_h, uint8_t *dst, int dst_w, int dst_h,
+                 ScaleMode mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCALE_H
@@ -0,0 +1,133 @@
+/*
+ * @file synth.h
+ * @brief Synthetic gray video source for load tests without input files
+ *
+ * Frames are a function of their sequence number only: a diagonal gradient
+ * that can drift, a number of bouncing boxes, per-pixel noise and an
+ * optional burned-in timecode. Rows are built from precomputed tables (a
+ * doubled gradient ramp, a noise strip read at a per-row offset), so a 1080p
+ * frame costs a few memcpy-like passes and the source can run far above
+ * real time when unthrottled.
+ *
+ * A capture input path of the form "synth:key=value,..." selects this source
+ * instead of a file; see synth_parse() for the keys.
+ */
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glyph.h"
+
+#define SYNTH_PREFIX "synth:"  /**< Input path prefix that selects the synthetic source */
+#define SYNTH_MAX_OBJECTS 16   /**< Upper bound on bouncing boxes */
+#define SYNTH_NOISE_SPAN 4096  /**< Row offsets into the noise strip */
+
+  /**
+   * @struct SynthConfig
+   * @brief What the generated video looks like and how fast it is produced.
+   */
+  typedef struct SynthConfig
+  {
+    int width;     /**< Frame width (>0) */
+    int height;    /**< Frame height (>0) */
+    int fps;       /**< Frames per second (0: unthrottled) */
+    int motion;    /**< Box speed in pixels per frame (0: boxes stand still) */
+    int objects;   /**< Bouncing boxes (0..SYNTH_MAX_OBJECTS) */
+    int drift;     /**< Gradient shift per frame (0: static background) */
+    int noise;     /**< Per-pixel noise amplitude, ± levels (0: none) */
+    bool timecode; /**< Burn frame number and time into the top-left corner */
+    uint32_t seed; /**< Noise pattern and box start positions */
+  } SynthConfig;
+
+  /**
+   * @struct SynthSource
+   * @brief Generator state: tables for the configured geometry and pacing.
+   */
+  typedef struct SynthSource
+  {
+    SynthConfig cfg;                /**< Configuration */
+    uint8_t *ramp;                  /**< Gradient, 4 * width entries (two periods) */
+    int16_t *noise;                 /**< Noise strip, width + SYNTH_NOISE_SPAN entries */
+    int phase[SYNTH_MAX_OBJECTS][2]; /**< Start offset of each box (x, y) */
+    uint64_t seq;                   /**< Next frame synth_read_frame() produces */
+    uint64_t start_ns;              /**< Pacing origin (CLOCK_MONOTONIC) */
+    uint64_t paced_from;            /**< Frame number produced at start_ns */
+    uint64_t late;                  /**< Frames produced after their deadline */
+  } SynthSource;
+
+  /**
+   * @brief Fill @p cfg with the defaults: 30 fps, one box moving 6 px per
+   *        frame, static gradient, ±4 noise, timecode on.
+   * @param[out] cfg    Configuration (>NULL).
+   * @param[in]  width  Frame width.
+   * @param[in]  height Frame height.
+   */
+  void synth_config_default(SynthConfig *cfg, int width, int height);
+
+  /**
+   * @brief Whether an input path names the synthetic source.
+   * @param[in] path Input path (NULL safe).
+   * @return true if @p path starts with SYNTH_PREFIX.
+   */
+  bool synth_is_spec(const char *path);
+
+  /**
+   * @brief Override fields of @p cfg from "synth:key=value,...".
+   *
+   * Keys: w, h, fps, motion, objects, drift, noise, timecode, seed. Fields
+   * not named keep their value.
+   * @param[in]     spec Specification (the prefix is optional).
+   * @param[in,out] cfg  Configuration to update.
+   * @return 0 on success; -1 on an unknown key or bad value (errno EINVAL).
+   */
+  int synth_parse(const char *spec, SynthConfig *cfg);
+
+  /**
+   * @brief Build a source for @p cfg.
+   * @param[in] cfg Configuration.
+   * @return Pointer to SynthSource or NULL (errno set).
+   */
+  SynthSource *synth_create(const SynthConfig *cfg);
+
+  /**
+   * @brief Free a source.
+   * @param[in,out] src Source pointer (NULL safe).
+   */
+  void synth_destroy(SynthSource *src);
+
+  /**
+   * @brief Render frame @p seq (the same seq always gives the same picture).
+   * @param[in]  src Source.
+   * @param[in]  seq Frame number.
+   * @param[out] dst width * height bytes.
+   */
+  void synth_render(const SynthSource *src, uint64_t seq, uint8_t *dst);
+
+  /**
+   * @brief Produce the next frame, waiting for its time slot when fps > 0.
+   *
+   * A source that falls more than a frame behind restarts its clock instead
+   * of bursting to catch up; such frames are counted in @c late.
+   * @param[in,out] src  Source.
+   * @param[out]    dst  Destination buffer.
+   * @param[in]     size Size of @p dst (must be width * height).
+   * @return 0 on success; -1 on a size mismatch (errno EINVAL).
+   */
+  int synth_read_frame(SynthSource *src, uint8_t *dst, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SYNTH_H
@@ -1,3 +1,12 @@
+/*
+ * @file task.h
+ * @brief Work-stealing worker pool with per-worker deques and join helpers
+ *
+ * Every worker owns a bounded deque. The owner pushes and pops at the bottom
+ * (LIFO, cache friendly), idle workers steal from the top of a victim's deque
+ * (FIFO, oldest and usually largest piece of work). Tasks are plain function
+ * pointers with a small payload copied inline, so submitting never allocates.
+ */
 #ifndef TASK_H
 #define TASK_H
 
@@ -6,98 +15,172 @@ extern "C"
 {
 #endif
 
+#include <errno.h>
 #include <pthread.h>
-#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "console_color.h"
 
-  volatile sig_atomic_t keep_running = 1;
+#define TP_MAX_WORKERS 64     /**< Upper bound on worker threads */
+#define TP_DEQUE_CAPACITY 256 /**< Slots per worker deque (power of two) */
+#define TP_TASK_INLINE 48     /**< Bytes of argument payload stored in a Task */
 
-#define TASK_QUEUE_CAPACITY 128 // Maximum queue size
+  /**
+   * @brief Task entry point. @p arg points at the task's inline payload copy.
+   */
+  typedef void (*TaskFn)(void *arg);
+
+  /**
+   * @brief Range body used by tp_parallel_for(): processes [begin, end).
+   */
+  typedef void (*RangeFn)(size_t begin, size_t end, void *ctx);
+
+  /**
+   * @struct TaskGroup
+   * @brief Join counter for a set of submitted tasks.
+   */
+  typedef struct TaskGroup
+  {
+    atomic_int outstanding; /**< Tasks submitted but not finished */
+    pthread_mutex_t mutex;  /**< Protects cond wait */
+    pthread_cond_t cond;    /**< Broadcast when outstanding reaches 0 */
+  } TaskGroup;
 
   /**
-   * @brief Structure representing a task to be processed
-   * @details This structure contains information about a command to be executed,
-   *          including the client file descriptor, received data, and data length.
-   * @date 2025-04-07
-   * @author Kim Hyo Jin
+   * @struct Task
+   * @brief One unit of work: function pointer plus inline argument bytes.
    */
-  typedef struct
+  typedef struct Task
   {
-    int fd;            // Client file descriptor
-    char data[BUFSIZ]; // Received data
-    int length;        // Data length
+    TaskFn fn;                                              /**< Entry point */
+    TaskGroup *group;                                       /**< Join group (NULL: detached) */
+    _Alignas(max_align_t) unsigned char arg[TP_TASK_INLINE]; /**< Inline payload */
   } Task;
 
   /**
-   * @brief Structure representing a task queue
-   * @details This structure manages a queue of tasks using a circular buffer,
-   *          with synchronization mechanisms for thread safety. The queue is
-   *          implemented as a circular buffer with front and rear pointers.
-   * @date 2025-04-07
-   * @author Kim Hyo Jin
+   * @struct TaskDeque
+   * @brief Bounded double-ended ring of tasks owned by one worker.
    */
-  typedef struct
+  typedef struct TaskDeque
   {
-    Task queue[TASK_QUEUE_CAPACITY]; // Task storage space (circular queue)
-    int front;                       // Queue front index
-    int rear;                        // Queue rear index
-    int count;                       // Current number of tasks
+    Task *slots;           /**< TP_DEQUE_CAPACITY slots */
+    size_t top;            /**< Steal end (monotonic) */
+    size_t bottom;         /**< Owner end (monotonic) */
+    pthread_mutex_t mutex; /**< Protects top/bottom/slots */
+  } TaskDeque;
 
-    pthread_mutex_t mutex; // Mutex for queue access
-    pthread_cond_t cond;   // Condition variable (signals when tasks are available)
-  } TaskQueue;
+  struct ThreadPool;
+
+  /**
+   * @struct TaskWorker
+   * @brief Per-worker state.
+   */
+  typedef struct TaskWorker
+  {
+    struct ThreadPool *pool; /**< Owning pool */
+    size_t id;               /**< Index in pool->workers */
+    pthread_t tid;           /**< Thread handle */
+    TaskDeque deque;         /**< Local work */
+    unsigned int rng;        /**< Victim selection state */
+  } TaskWorker;
+
+  /**
+   * @struct ThreadPool
+   * @brief Fixed set of workers sharing work by stealing.
+   */
+  typedef struct ThreadPool
+  {
+    TaskWorker *workers;     /**< Array of nworkers */
+    size_t nworkers;         /**< Number of worker threads */
+    atomic_size_t next;      /**< Round-robin target for external submits */
+    atomic_int pending;      /**< Tasks queued in any deque */
+    pthread_mutex_t mutex;   /**< Protects idle sleep */
+    pthread_cond_t cond;     /**< Signaled when work arrives or on shutdown */
+    volatile bool done;      /**< Shutdown flag */
+  } ThreadPool;
 
   /**
-   * @brief Initializes a new task queue
-   * @param q Pointer to the task queue to be initialized
-   * @details Initializes the task queue by setting front, rear, and count to 0,
-   *          and initializing the mutex and condition variables. This function
-   *          must be called before any other task queue operations.
-   * @date 2025-04-07
-   * @author Kim Hyo Jin
+   * @brief Create a pool and start its workers.
+   * @param[in] nworkers Worker count; 0 selects the number of online CPUs.
+   * @return Pointer to ThreadPool or NULL (errno set).
    */
-  void task_queue_init(TaskQueue *q);
+  ThreadPool *tp_create(size_t nworkers);
 
   /**
-   * @brief Adds a task to the queue
-   * @param q Pointer to the task queue
-   * @param task Task to be added
-   * @details Adds a task to the end of the queue. If the queue is full, the function
-   *          will wait until space becomes available. This function is typically called
-   *          by the main thread (epoll loop) to add new tasks.
-   * @date 2025-04-07
-   * @author Kim Hyo Jin
+   * @brief Drain queued tasks, stop workers and free the pool.
+   * @param[in,out] pool Pool pointer (NULL safe).
    */
-  void task_queue_push(TaskQueue *q, Task task);
+  void tp_destroy(ThreadPool *pool);
 
   /**
-   * @brief Removes a task from the queue
-   * @param q Pointer to the task queue
-   * @return The task removed from the queue
-   * @details Removes a task from the front of the queue. If the queue is empty, the function
-   *          will wait until a task becomes available, unless keep_running is false.
-   *          This function is typically called by worker threads to process tasks.
-   * @date 2025-04-07
-   * @author Kim Hyo Jin
+   * @brief Submit a task.
+   *
+   * Called from a worker, the task goes to that worker's own deque; otherwise
+   * deques are picked round-robin. If the chosen deque is full the task runs
+   * synchronously in the caller.
+   * @param[in] pool     Pool pointer (>NULL).
+   * @param[in] group    Join group or NULL.
+   * @param[in] fn       Task function (>NULL).
+   * @param[in] arg      Payload copied into the task (may be NULL if size 0).
+   * @param[in] arg_size Payload size (<= TP_TASK_INLINE).
+   * @return 0 on success; -1 on failure (errno set).
    */
-  Task task_queue_pop(TaskQueue *q);
+  int tp_submit(ThreadPool *pool, TaskGroup *group, TaskFn fn, const void *arg, size_t arg_size);
 
   /**
-   * @brief Frees all resources used by the task queue
-   * @param q Pointer to the task queue to be destroyed
-   * @details Frees the task queue and all associated resources, including
-   *          destroying the mutex and condition variables.
-   * @date 2025-04-07
-   * @author Kim Hyo Jin
+   * @brief Split [begin, end) into chunks of @p grain and run them on the pool.
+   *
+   * Blocks until every chunk has completed; the caller executes chunks too.
+   * Runs inline when @p pool is NULL or the range fits in a single chunk.
+   * @param[in] pool  Pool pointer (NULL runs serially).
+   * @param[in] begin First index.
+   * @param[in] end   One past the last index.
+   * @param[in] grain Indices per chunk (0 selects an even split across workers).
+   * @param[in] fn    Range body.
+   * @param[in] ctx   Opaque pointer passed to @p fn.
    */
-  void task_queue_destroy(TaskQueue *q);
+  void tp_parallel_for(ThreadPool *pool, size_t begin, size_t end, size_t grain, RangeFn fn,
+                       void *ctx);
+
+  /**
+   * @brief Number of worker threads in the pool.
+   * @param[in] pool Pool pointer (NULL safe).
+   * @return Worker count; 0 if pool NULL.
+   */
+  size_t tp_worker_count(const ThreadPool *pool);
+
+  /**
+   * @brief Index of the calling worker within its pool.
+   * @return Worker index, or -1 when called from a non-worker thread.
+   */
+  int tp_current_worker(void);
+
+  /**
+   * @brief Initialize a join group.
+   * @param[out] group Group to initialize (>NULL).
+   */
+  void tg_init(TaskGroup *group);
+
+  /**
+   * @brief Wait for all tasks in @p group, executing queued work meanwhile.
+   * @param[in] pool  Pool the tasks were submitted to (NULL: plain wait).
+   * @param[in] group Group to join (>NULL).
+   */
+  void tg_wait(ThreadPool *pool, TaskGroup *group);
+
+  /**
+   * @brief Destroy a join group. The group must have been joined.
+   * @param[in,out] group Group pointer (NULL safe).
+   */
+  void tg_destroy(TaskGroup *group);
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif
+#endif // TASK_H
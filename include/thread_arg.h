@@ -8,32 +8,104 @@
 #include <semaphore.h>
 
 #include "frame_pool.h"
+#include "mailbox.h"
+#include "motion.h"
+#include "perfctr.h"
 #include "queue.h"
+#include "rtsched.h"
+#include "task.h"
 #include "ui.h"
 
 #define WIDTH 1920
 #define HEIGHT 1080
 #define TYPE GRAY
-#define POOL_SIZE 10
+#define POOL_SIZE 10 // stream 하나당 frame block 수
 #define QUEUE_SIZE 30 // 큐의 크기
-#define CAPTURE_FILE "data/cap/video1.raw"
-#define RECORD_FILE "data/rec/video1_rec.raw"
+#define MOTION_QUEUE_SIZE 2 // 분석이 밀리면 capture 는 기다리지 않고 프레임을 건너뜀
+#define PERF_STAGE_COUNTERS 0 // 1: capture/display/record thread 마다 perf_event_open counter (perfctr.h)
+
+/* ─── 다중 stream: 메모리/스레드 예산은 여기서 한꺼번에 정한다 ─── */
+#define STREAM_MAX 8
+#define STREAM_COUNT 1          // 동시에 받는 feed 수 (1..STREAM_MAX)
+#define STREAM_POOL_SHARED 1    // 1: 모든 stream 이 POOL_SIZE*STREAM_COUNT 블록 pool 하나를 공유
+#define STREAM_ENCODE_THREADS 0 // 모든 recorder 가 나눠 쓰는 slice 인코딩 worker (0: online CPU 수)
+#define DISPLAY_STREAM 0        // 화면에 보이고 motion 분석을 받는 stream
+#define DISPLAY_MOSAIC 1        // 1: stream 이 여럿이면 모두 grid 로 보여준다 (mosaic.h)
+#define CAPTURE_FILE_FMT "data/cap/video%d.raw"   // stream i 의 입력 (i+1 로 채움)
+#define RECORD_FILE_FMT "data/rec/video%d_rec.tbb" // stream i 의 녹화 (i+1 로 채움)
+#define CAPTURE_SYNTH 0          // 1: 입력 파일 대신 합성 영상 (synth.h, 파일 없이 부하 시험)
+#define CAPTURE_SYNTH_SPEC "synth:fps=30,motion=6,noise=4" // stream 마다 seed=i+1 이 붙는다
+#define STREAM_PATH_MAX 256
+
+/* ─── 소비자별 backpressure: queue 가 가득 찼을 때 capture 가 하는 일 (queue.h) ─── */
+// 화면은 최신 frame 만 (mosaic 이면 stream 마다 최신): 녹화가 밀려도 멈추지 않는다
+#define DISPLAY_QUEUE_POLICY (DISPLAY_MOSAIC && STREAM_COUNT > 1 ? QUEUE_DROP_OLDEST : QUEUE_LATEST_ONLY)
+#define DISPLAY_QUEUE_DEPTH (DISPLAY_MOSAIC && STREAM_COUNT > 1 ? 2 * STREAM_COUNT : 1)
+#define DISPLAY_MAILBOX 1 // 1: stream 하나만 보일 때 display_q 대신 lock 없는 한 칸 mailbox (mailbox.h)
+// record queue 몫까지는 무손실, 넘치면 새 frame 을 빼고 센다 (QUEUE_BLOCK: 예전처럼 capture 가 기다림)
+#define RECORD_QUEUE_POLICY QUEUE_DROP_NEWEST
+#define RECORD_QUEUE_WAIT_MS QUEUE_WAIT_FOREVER // QUEUE_BLOCK 일 때 capture 가 기다리는 최대 시간
+// record queue 들이 pool 에서 가져가지 않는 블록: capture 가 채우는 중 + display (queue + 그리는 중)
+// + analysis (queue + 분석 중). 이만큼은 녹화가 밀려도 항상 남아 있다
+#define RECORD_POOL_HEADROOM(nstreams) (2 * (nstreams) + DISPLAY_QUEUE_DEPTH + MOTION_QUEUE_SIZE + 1)
+
+/* ─── pool/queue 크기 자동 조절 (adapt.h): 평소엔 작게, recorder 가 밀릴 때만 늘린다 ─── */
+#define ADAPT_POOL 1             // 0: POOL_SIZE 고정
+#define ADAPT_POOL_MIN 4         // stream 하나당 record queue 최소 몫 (RECORD_POOL_HEADROOM 위로)
+#define ADAPT_POOL_MAX QUEUE_SIZE // stream 하나당 최대 블록 수 (이만큼 주소 공간을 잡아 둔다)
+#define ADAPT_MEM_MAX_MB 256     // 모든 pool 의 frame 메모리 상한
+#define ADAPT_PERIOD_MS 500      // 조절 주기
+#define ADAPT_SHRINK_TICKS 10    // 이만큼 연속으로 한가해야 한 블록 줄인다
+#define ADAPT_HEADROOM 2         // 최근 최대 사용량 위로 남겨 둘 블록
+
+/* ─── 스케줄링: thread 마다 CPU mask, 정책, 우선순위/nice (rtsched.h) ─── */
+// 예: capture 를 CPU 0 에 SCHED_FIFO 60 으로 → RT_SCHED_FIFO(0x1, 60) (CAP_SYS_NICE 필요)
+#define CAPTURE_SCHED RT_SCHED_OTHER(RT_CPUS_ANY, 0)
+#define DISPLAY_SCHED RT_SCHED_OTHER(RT_CPUS_ANY, 0)  // band worker 도 이 설정을 물려받는다
+#define RECORD_SCHED RT_SCHED_OTHER(RT_CPUS_ANY, 0)
+#define ANALYSIS_SCHED RT_SCHED_OTHER(RT_CPUS_ANY, 0) // 밀려도 frame 을 건너뛸 뿐: nice 를 올려도 됨
+#define SCHED_MLOCKALL 0            // 1: 시작할 때 mlockall (page fault 로 인한 멈춤 방지)
+#define SCHED_LATENCY_SAMPLES 100   // 설정 후 thread 마다 재는 깨어남 지연 횟수 (0: 재지 않음)
+#define SCHED_LATENCY_PERIOD_US 1000
+
+struct SharedCtx;
+
+/**
+ * @struct StreamCtx
+ * @brief One input feed: its capture thread, record queue and recorder.
+ */
+typedef struct StreamCtx
+{
+  int id;                              /**< Stream id, also written to Frame.stream */
+  char capture_file[STREAM_PATH_MAX];  /**< Input (.raw or .tbb) */
+  char record_file[STREAM_PATH_MAX];   /**< Recording (.tbb) */
+  sem_t wrap_sem;                      /**< Posted by capture when the input wraps or the UI restarts */
+  Queue *record_q;                     /**< capture → record */
+  FramePool *frame_pool;               /**< Own pool, or the shared one */
+  struct SharedCtx *shared;            /**< Pipeline-wide context */
+} StreamCtx;
 
 /**
  * @struct SharedCtx
  * @brief Holds shared arguments for capture, display, and record threads.
  *
- * Includes raw video fds, wrap semaphore, frame queues, frame pool, and UI context.
+ * Includes raw video fds, frame queues, frame pool, UI context and one
+ * StreamCtx per input feed.
  */
-typedef struct
+typedef struct SharedCtx
 {
   int fd_in;
   int fd_out;
-  sem_t wrap_sem;
-  Queue *display_q;
-  Queue *record_q;
-  FramePool *frame_pool;
+  Queue *display_q;      // DISPLAY_STREAM capture → display (mosaic: 모든 stream)
+  FrameMailbox display_mb; // display_mailbox 일 때 display_q 대신 (최신 frame 한 칸)
+  bool display_mailbox;
+  Queue *motion_q;       // capture → analysis (가득 차면 건너뜀)
+  MotionBoard motion;    // 최신 motion event (display/record 가 참조)
+  FramePool *frame_pool; // STREAM_POOL_SHARED 일 때 모든 stream 의 pool
+  ThreadPool *encode_pool; // 모든 recorder 의 slice 인코딩 worker
   UiArgs *ui_arg; // UI Thread와의 상호작용을 위한 포인터
+  int nstreams;
+  StreamCtx streams[STREAM_MAX];
 } SharedCtx;
 
 #endif // THREAD_ARGS_H
@@ -9,6 +9,11 @@
 #include <stdbool.h>
 #include <termios.h>
 
+#include "rtsched.h"
+
+#define UI_MAX_FDS 16 /**< fds[i]: input of stream i (recordings are rewound via restarts) */
+#define UI_SCHED RT_SCHED_OTHER(RT_CPUS_ANY, 0) /**< Scheduling of the UI thread (rtsched.h) */
+
 /**
  * @enum State
  * @brief Program execution states managed by the UI thread.
@@ -26,7 +31,8 @@ typedef enum
  */
 typedef struct
 {
-  int fds[2];                  /**< File descriptors for reset callbacks */
+  int fds[UI_MAX_FDS];         /**< File descriptors for reset callbacks (-1: unused) */
+  unsigned restarts;           /**< Incremented on every restart; capture tells its recorder */
   State state;                 /**< Current program state */
   pthread_mutex_t mutex;       /**< Protects state changes */
   pthread_cond_t cond;         /**< Signals state changes */
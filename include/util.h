@@ -6,11 +6,28 @@ extern "C"
 {
 #endif
 
+#include <stdint.h>
 #include <stdlib.h>
+#include <time.h>
 
 
   void safe_free(void **ptr);
 
+  /**
+   * @brief Read a clock in nanoseconds.
+   * @param[in] id Clock (CLOCK_MONOTONIC, CLOCK_THREAD_CPUTIME_ID, ...).
+   */
+  uint64_t clock_ns(clockid_t id);
+
+  /** @brief CLOCK_MONOTONIC in nanoseconds. */
+  uint64_t now_ns(void);
+
+  /** @brief CLOCK_MONOTONIC in milliseconds. */
+  double now_ms(void);
+
+  /** @brief qsort comparator for uint64_t, ascending. */
+  int cmp_u64(const void *a, const void *b);
+
 #ifdef __cplusplus
 }
 #endif
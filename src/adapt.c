@@ -0,0 +1,212 @@
+/*
+ * @file adapt.c
+ * @brief Pool / record queue sizing controller and its thread.
+ */
+#include "adapt.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+void adapt_init(PoolAdapter *ad, int shrink_ticks, size_t headroom)
+{
+  memset(ad, 0, sizeof(*ad));
+  ad->shrink_ticks = shrink_ticks > 0 ? shrink_ticks : 1;
+  ad->headroom = headroom;
+}
+
+// 각 record queue 는 reserve 를 뺀 pool limit 을 나눠 가진다
+static void apply_queue_share(AdaptLane *ln, size_t limit)
+{
+  if (ln->nqueues == 0)
+    return;
+  size_t share = (limit > ln->reserve ? limit - ln->reserve : 0) / (size_t)ln->nqueues;
+  for (int i = 0; i < ln->nqueues; i++)
+    queue_set_limit(ln->queues[i], share > 0 ? share : 1);
+}
+
+int adapt_add_pool(PoolAdapter *ad, FramePool *pool, size_t min_blocks, size_t max_blocks,
+                   size_t reserve)
+{
+  if (!ad || !pool || min_blocks == 0 || ad->nlanes >= STREAM_MAX)
+  {
+    errno = ad && ad->nlanes >= STREAM_MAX ? ENOSPC : EINVAL;
+    return -1;
+  }
+  if (max_blocks > pool->pool_size)
+    max_blocks = pool->pool_size;
+  if (min_blocks > max_blocks)
+    min_blocks = max_blocks;
+
+  AdaptLane *ln = &ad->lanes[ad->nlanes];
+  memset(ln, 0, sizeof(*ln));
+  ln->pool = pool;
+  ln->min_blocks = min_blocks;
+  ln->max_blocks = max_blocks;
+  ln->reserve = reserve;
+  ln->last_stalls = fp_stall_count(pool);
+  ln->low = ln->high = fp_get_limit(pool);
+  return ad->nlanes++;
+}
+
+int adapt_add_queue(PoolAdapter *ad, int lane, Queue *queue)
+{
+  if (!ad || lane < 0 || lane >= ad->nlanes || !queue ||
+      ad->lanes[lane].nqueues >= STREAM_MAX)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  AdaptLane *ln = &ad->lanes[lane];
+  ln->last_drops[ln->nqueues] = queue_drop_count(queue);
+  ln->queues[ln->nqueues++] = queue;
+  apply_queue_share(ln, fp_get_limit(ln->pool));
+  return 0;
+}
+
+static int adapt_lane(PoolAdapter *ad, int idx)
+{
+  AdaptLane *ln = &ad->lanes[idx];
+  size_t limit = fp_get_limit(ln->pool);
+  size_t stalls = fp_stall_count(ln->pool);
+  size_t new_stalls = stalls - ln->last_stalls;
+  size_t peak = fp_take_peak(ln->pool);
+  ln->last_stalls = stalls;
+
+  // recorder 가 밀리면 자기 몫의 queue 가 먼저 차고, 넘치면 frame 을 뺀다
+  int lagging = -1;
+  size_t qpeak = 0, qdrops = 0;
+  for (int i = 0; i < ln->nqueues; i++)
+  {
+    size_t p = queue_take_peak(ln->queues[i]);
+    size_t drops = queue_drop_count(ln->queues[i]);
+    if ((p >= ln->queues[i]->limit || drops > ln->last_drops[i]) && lagging < 0)
+    {
+      lagging = i;
+      qpeak = p;
+      qdrops = drops - ln->last_drops[i];
+    }
+    ln->last_drops[i] = drops;
+  }
+
+  size_t next = limit;
+  if ((new_stalls > 0 || lagging >= 0) && limit < ln->max_blocks)
+  {
+    // 한 번에 1/4 씩: write stall 은 짧고 몰려서 온다
+    size_t step = limit / 4 > 0 ? limit / 4 : 1;
+    next = limit + step < ln->max_blocks ? limit + step : ln->max_blocks;
+    ln->calm = 0;
+    ln->grows++;
+    fprintf(stderr, "%s:%d in %s() → pool %d: %zu new waits, record queue %d peak %zu dropped %zu: limit %zu → %zu\n",
+            __FILE__, __LINE__, __func__, idx, new_stalls, lagging, qpeak, qdrops, limit, next);
+  }
+  else if (new_stalls == 0 && lagging < 0 && peak + ad->headroom < limit && limit > ln->min_blocks)
+  {
+    if (++ln->calm >= ad->shrink_ticks)
+    {
+      next = limit - 1;
+      ln->calm = 0;
+      ln->shrinks++;
+    }
+  }
+  else
+    ln->calm = 0;
+
+  if (next == limit)
+    return 0;
+
+  fp_set_limit(ln->pool, next);
+  apply_queue_share(ln, next);
+  if (next < limit)
+  {
+    size_t freed = fp_trim(ln->pool);
+    ln->trimmed += freed;
+    fprintf(stderr, "%s:%d in %s() → pool %d: peak %zu over %d quiet ticks: limit %zu → %zu, %.1f MB returned\n",
+            __FILE__, __LINE__, __func__, idx, peak, ad->shrink_ticks, limit, next, freed / 1e6);
+  }
+  if (next < ln->low)
+    ln->low = next;
+  if (next > ln->high)
+    ln->high = next;
+  return 1;
+}
+
+int adapt_tick(PoolAdapter *ad)
+{
+  int changed = 0;
+  for (int i = 0; i < ad->nlanes; i++)
+    changed += adapt_lane(ad, i);
+  ad->ticks++;
+  return changed;
+}
+
+void adapt_report(const PoolAdapter *ad, FILE *out)
+{
+  if (!out)
+    out = stderr;
+  for (int i = 0; i < ad->nlanes; i++)
+  {
+    const AdaptLane *ln = &ad->lanes[i];
+    size_t limit = fp_get_limit(ln->pool);
+    fprintf(out,
+            "pool %d: limit %zu blocks (%.1f MB), range %zu..%zu of %zu..%zu, %zu grows, "
+            "%zu shrinks, %zu waits, %.1f MB trimmed over %llu ticks\n",
+            i, limit, limit * fp_total_bytes_per_frame_size(ln->pool) / 1e6, ln->low, ln->high,
+            ln->min_blocks, ln->max_blocks, ln->grows, ln->shrinks, fp_stall_count(ln->pool),
+            ln->trimmed / 1e6, (unsigned long long)ad->ticks);
+  }
+}
+
+/**
+ * @brief Thread function for the sizing controller.
+ *
+ * Puts every pool of the pipeline under control (one lane for the shared
+ * pool, or one per stream) with the record queues that hold its blocks,
+ * then ticks every ADAPT_PERIOD_MS until the UI asks to exit.
+ * @param[in] arg Pointer to SharedCtx.
+ * @return NULL on thread exit.
+ */
+static void *adapt_thread(void *arg)
+{
+  SharedCtx *sh = (SharedCtx *)arg;
+  PoolAdapter ad;
+
+  rt_thread_setup(&ANALYSIS_SCHED, "adapt", 0, 0);
+  fprintf(stderr, "%s:%d in %s() → adapt thread start \n", __FILE__, __LINE__, __func__);
+
+  adapt_init(&ad, ADAPT_SHRINK_TICKS, ADAPT_HEADROOM);
+  int nlanes = STREAM_POOL_SHARED ? 1 : sh->nstreams;
+  int per_lane = STREAM_POOL_SHARED ? sh->nstreams : 1;
+  // 메모리 상한은 pool 들이 똑같이 나눈다
+  size_t bytes = fp_total_bytes_per_frame_size(sh->streams[0].frame_pool);
+  size_t mem_blocks = (size_t)ADAPT_MEM_MAX_MB * 1000000 / (bytes * (size_t)nlanes);
+  for (int l = 0; l < nlanes; l++)
+  {
+    size_t reserve = RECORD_POOL_HEADROOM((size_t)per_lane);
+    int lane = adapt_add_pool(&ad, sh->streams[l].frame_pool,
+                              reserve + (size_t)ADAPT_POOL_MIN * per_lane, mem_blocks, reserve);
+    for (int i = 0; lane >= 0 && i < per_lane; i++)
+      adapt_add_queue(&ad, lane, sh->streams[l + i].record_q);
+  }
+
+  while (sh->ui_arg->state != STATE_EXIT)
+  {
+    usleep(ADAPT_PERIOD_MS * 1000);
+    adapt_tick(&ad);
+  }
+
+  fprintf(stderr, "%s:%d in %s() → adapt thread exit\n", __FILE__, __LINE__, __func__);
+  adapt_report(&ad, stderr);
+  return NULL;
+}
+
+bool adapt_run(SharedCtx *arg, pthread_t *tid)
+{
+  if (pthread_create(tid, NULL, adapt_thread, (void *)arg) != 0)
+  {
+    perror("pthread_create");
+    return false;
+  }
+
+  return true;
+}
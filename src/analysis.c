@@ -0,0 +1,86 @@
+/*
+ * @file analysis.c
+ * @brief Analysis thread: motion detection on captured frames.
+ */
+#include "analysis.h"
+
+/**
+ * @brief Thread function for running the motion detector.
+ *
+ * Dequeues FrameBlocks from motion_q, analyzes them, publishes the event
+ * and releases the block back to the pool.
+ * @param[in] arg Pointer to SharedCtx.
+ * @return NULL on thread exit.
+ */
+static void *analysis_thread(void *arg)
+{
+  SharedCtx *ana_arg = (SharedCtx *)arg;
+  FramePool *frame_pool = ana_arg->streams[DISPLAY_STREAM].frame_pool; // 분석하는 stream 의 pool
+  MotionDetector *md = NULL;
+  FrameBlock *fb = NULL;
+  MotionEvent ev;
+
+  rt_thread_setup(&ANALYSIS_SCHED, "analysis", SCHED_LATENCY_SAMPLES, SCHED_LATENCY_PERIOD_US);
+  fprintf(stderr, "%s:%d in %s() → analysis thread start \n", __FILE__, __LINE__, __func__);
+
+  while (1)
+  {
+    /* Dequeue next block (NULL once capture has stopped) */
+    fb = dequeue_wait(ana_arg->motion_q, QUEUE_WAIT_FOREVER);
+    if (!fb)
+    {
+      fprintf(stderr, "%s:%d in %s() → analysis thread exit\n", __FILE__, __LINE__, __func__);
+      goto thread_exit;
+    }
+
+    // 첫 프레임의 크기로 detector 생성
+    if (md == NULL)
+    {
+      md = md_create((int)fb->frame.width, (int)fb->frame.height, NULL);
+      if (md == NULL)
+      {
+        fprintf(stderr, "%s:%d in %s() → failed to create motion detector\n", __FILE__, __LINE__,
+                __func__);
+        fp_release(frame_pool, fb);
+        goto thread_exit;
+      }
+    }
+
+    /* Analyze and publish */
+    if (md_process(md, fb->frame.data, fb->frame.seq, &ev) >= 0)
+    {
+      md_board_publish(&ana_arg->motion, &ev);
+      if (ev.started)
+        fprintf(stderr, "%s:%d in %s() → motion start seq=%zu regions=%d score=%.2f\n", __FILE__,
+                __LINE__, __func__, ev.seq, ev.nregions, ev.score);
+      else if (ev.ended)
+        fprintf(stderr, "%s:%d in %s() → motion end seq=%zu\n", __FILE__, __LINE__, __func__,
+                ev.seq);
+    }
+
+    // release the frame block
+    fp_release(frame_pool, fb);
+
+    /* Exit check */
+    if (ana_arg->ui_arg->state == STATE_EXIT)
+    {
+      fprintf(stderr, "%s:%d in %s() → analysis thread exit\n", __FILE__, __LINE__, __func__);
+      goto thread_exit;
+    }
+  }
+
+thread_exit:
+  md_destroy(md);
+  return NULL;
+}
+
+bool analysis_run(SharedCtx *arg, pthread_t *tid)
+{
+  if (pthread_create(tid, NULL, analysis_thread, (void *)arg) != 0)
+  {
+    perror("pthread_create");
+    return false;
+  }
+
+  return true;
+}
@@ -7,35 +7,97 @@
 /**
  * @brief Thread function for reading frames and dispatching to consumers.
  *
- * Reads raw frames from file, handles wrap-around, sets sequence numbers,
- * and enqueues to display and record queues.
- * @param[in] arg Pointer to SharedCtx containing queues, pool, and UI args.
+ * Reads raw frames from file (or renders them, for a "synth:" input),
+ * handles wrap-around, sets sequence numbers, and enqueues to the display
+ * queue (for DISPLAY_STREAM, or every stream when the display shows a
+ * mosaic), to analysis (DISPLAY_STREAM, when its queue has room) and to the
+ * stream's record queue, each under the queue's backpressure policy.
+ * @param[in] arg Pointer to the StreamCtx of the source to read.
  * @return NULL on thread exit.
  */
 static void *capture_thread(void *arg)
 {
+  TbbReader reader = {0};
+  SynthSource *synth = NULL;
+  int fd = -1;
+  int is_tbb = 0;
+
+  // Initialize the capture arguments
+  StreamCtx *stream = (StreamCtx *)arg;
+  SharedCtx *cap_arg = stream->shared;
+  FramePool *frame_pool = stream->frame_pool;
+  // analysis 는 한 stream 만, display 는 mosaic 이면 전부 본다
+  bool is_display = stream->id == DISPLAY_STREAM;
+  bool to_display = is_display || (DISPLAY_MOSAIC && cap_arg->nstreams > 1);
+  size_t seq = 0;
+  FrameBlock *fb = NULL;
+  int wrapped = 0;
+  PerfStage perf;
+  char perf_name[32];
+
+  snprintf(perf_name, sizeof(perf_name), "capture %d", stream->id);
+  rt_thread_setup(&CAPTURE_SCHED, perf_name, SCHED_LATENCY_SAMPLES, SCHED_LATENCY_PERIOD_US);
+  perf_stage_init(&perf, perf_name);
+
+  // "synth:..." 이면 파일 대신 합성 영상
+  if (synth_is_spec(stream->capture_file))
+  {
+    SynthConfig cfg;
+    synth_config_default(&cfg, WIDTH, HEIGHT);
+    if (synth_parse(stream->capture_file, &cfg) < 0 || (synth = synth_create(&cfg)) == NULL)
+    {
+      fprintf(stderr, "%s:%d in %s() → bad synthetic source: %s\n", __FILE__, __LINE__,
+              __func__, stream->capture_file);
+      goto thread_exit;
+    }
+    if ((size_t)cfg.width * cfg.height != frame_pool->total_bytes_per_frame)
+    {
+      fprintf(stderr, "%s:%d in %s() → synthetic source is %dx%d, pool expects %zu bytes/frame\n",
+              __FILE__, __LINE__, __func__, cfg.width, cfg.height,
+              frame_pool->total_bytes_per_frame);
+      goto thread_exit;
+    }
+    goto source_ready;
+  }
+
   // Open the raw video file
-  int fd = open(CAPTURE_FILE, O_RDONLY);
+  fd = open(stream->capture_file, O_RDONLY);
   if (fd == -1)
   {
     fprintf(stderr, "%s:%d in %s() → failed to open file: %s\n", __FILE__, __LINE__, __func__,
-            CAPTURE_FILE);
+            stream->capture_file);
     goto thread_exit;
   }
 
-  // Initialize the capture arguments
-  SharedCtx *cap_arg = (SharedCtx *)arg;
-  FramePool *frame_pool = cap_arg->frame_pool;
-  size_t seq = 0;
-  FrameBlock *fb = NULL;
-  int wrapped = 0;
+  // 녹화 파일(.tbb)이면 record 단위로 재생, 아니면 raw
+  is_tbb = tbb_reader_open_fd(&reader, fd);
+  if (is_tbb < 0)
+  {
+    fprintf(stderr, "%s:%d in %s() → bad recording: %s\n", __FILE__, __LINE__, __func__,
+            stream->capture_file);
+    goto thread_exit;
+  }
+  if (is_tbb && reader.frame_bytes != frame_pool->total_bytes_per_frame)
+  {
+    fprintf(stderr, "%s:%d in %s() → recording is %ux%u, pool expects %zu bytes/frame\n",
+            __FILE__, __LINE__, __func__, reader.hdr.width, reader.hdr.height,
+            frame_pool->total_bytes_per_frame);
+    goto thread_exit;
+  }
 
-  /* Notify UI of input FD */
+source_ready:
+  /* Notify UI of input FD (none for a synthetic source) */
   pthread_mutex_lock(&cap_arg->ui_arg->mutex);
-  cap_arg->ui_arg->fds[1] = fd;
+  cap_arg->ui_arg->fds[stream->id] = fd;
+  unsigned restarts = cap_arg->ui_arg->restarts;
   pthread_mutex_unlock(&cap_arg->ui_arg->mutex);
 
-  fprintf(stderr, "%s:%d in %s() → capture thread start \n", __FILE__, __LINE__, __func__);
+  fprintf(stderr, "%s:%d in %s() → capture thread start (stream %d)\n", __FILE__, __LINE__, __func__,
+          stream->id);
+
+  if (PERF_STAGE_COUNTERS && perf_stage_open(&perf, perf_name) < 0)
+    fprintf(stderr, "%s:%d in %s() → no perf counters: %s\n", __FILE__, __LINE__, __func__,
+            strerror(errno));
 
   /* Main capture loop */
   while (1)
@@ -49,14 +111,19 @@ static void *capture_thread(void *arg)
     }
     if (cap_arg->ui_arg->state == STATE_EXIT)
     {
+      pthread_mutex_unlock(&cap_arg->ui_arg->mutex);
       fprintf(stderr, "%s:%d in %s() → capture thread exit\n", __FILE__, __LINE__, __func__);
       goto thread_exit;
     }
-
+    // UI 재시작: 입력은 UI 가 되감았고, 녹화는 recorder 가 다음 frame 전에 되감는다
+    bool restarted = cap_arg->ui_arg->restarts != restarts;
+    restarts = cap_arg->ui_arg->restarts;
     pthread_mutex_unlock(&cap_arg->ui_arg->mutex);
+    if (restarted)
+      sem_post(&stream->wrap_sem);
 
     // Allocate a frame block from the pool
-    fb = fp_alloc(frame_pool, 2);
+    fb = fp_alloc(frame_pool, 1 + to_display + is_display);
     if (!fb)
     {
       fprintf(stderr, "%s:%d in %s() → failed to allocate frame block\n", __FILE__, __LINE__,
@@ -65,7 +132,15 @@ static void *capture_thread(void *arg)
     }
 
     // read the frame data into the block (returns 1 on wrap)
-    if ((wrapped = raw_video_read_frame(fd, fb->frame.data, frame_pool->total_bytes_per_frame)) < 0)
+    perf_stage_begin(&perf);
+    if (synth)
+      wrapped = synth_read_frame(synth, fb->frame.data, frame_pool->total_bytes_per_frame);
+    else if (is_tbb)
+      wrapped = tbb_reader_read_frame(&reader, fb->frame.data, frame_pool->total_bytes_per_frame);
+    else
+      wrapped = raw_video_read_frame(fd, fb->frame.data, frame_pool->total_bytes_per_frame);
+    perf_stage_end(&perf, 1);
+    if (wrapped < 0)
     {
       fprintf(stderr, "%s:%d in %s() → failed to read frame\n", __FILE__, __LINE__, __func__);
       goto thread_exit;
@@ -74,39 +149,52 @@ static void *capture_thread(void *arg)
     {
       // fprintf(stderr, "%s:%d in %s() → EOF reached\n", __FILE__, __LINE__, __func__);
       // rewind the file offset to the beginning
-      sem_post(&cap_arg->wrap_sem);
+      sem_post(&stream->wrap_sem);
     }
 
     /* Assign sequence */
     fb->frame.seq = seq++;
+    fb->frame.stream = stream->id;
 
-    /* Enqueue to display */
-    pthread_mutex_lock(&cap_arg->display_q->mutex);
-    while (is_full(cap_arg->display_q))
-    {
-      pthread_cond_wait(&cap_arg->display_q->cond_not_full, &cap_arg->display_q->mutex);
-    }
-    enqueue(cap_arg->display_q, (void *)fb);
-    pthread_cond_signal(&cap_arg->display_q->cond_not_empty);
-    pthread_mutex_unlock(&cap_arg->display_q->mutex);
-
-    /* Enqueue to record */
-    pthread_mutex_lock(&cap_arg->record_q->mutex);
-    while (is_full(cap_arg->record_q))
-    {
-      pthread_cond_wait(&cap_arg->record_q->cond_not_full, &cap_arg->record_q->mutex);
-    }
-    enqueue(cap_arg->record_q, (void *)fb);
-    pthread_cond_signal(&cap_arg->record_q->cond_not_empty);
-    pthread_mutex_unlock(&cap_arg->record_q->mutex);
+    /*
+     * Hand the block to each consumer under its queue's policy: display and
+     * analysis never make capture wait, so they go first and stay live even
+     * when recording waits (QUEUE_BLOCK) on a slow disk. A refused block is
+     * released here, an evicted one by the queue's drop callback.
+     */
+    if (to_display && (cap_arg->display_mailbox ? mailbox_put(&cap_arg->display_mb, fb)
+                                                : enqueue_wait(cap_arg->display_q, fb, 0)) < 0)
+      fp_release(frame_pool, fb);
+    if (is_display && enqueue_wait(cap_arg->motion_q, fb, 0) < 0)
+      fp_release(frame_pool, fb);
+    if (enqueue_wait(stream->record_q, fb, RECORD_QUEUE_WAIT_MS) < 0)
+      fp_release(frame_pool, fb);
   }
 
 thread_exit:
-  close(fd);
+  // 소비자는 남은 frame 을 마저 처리한 뒤 끝난다
+  queue_set_done(stream->record_q);
+  if (is_display)
+  {
+    queue_set_done(cap_arg->display_q);
+    if (cap_arg->display_mailbox)
+      mailbox_close(&cap_arg->display_mb);
+    queue_set_done(cap_arg->motion_q);
+  }
+  if (reader.crc_errors)
+    fprintf(stderr, "%s:%d in %s() → %llu corrupted records skipped\n", __FILE__, __LINE__,
+            __func__, (unsigned long long)reader.crc_errors);
+  if (PERF_STAGE_COUNTERS)
+    perf_stage_report(&perf, stderr);
+  perf_stage_close(&perf);
+  tbb_reader_close(&reader);
+  synth_destroy(synth);
+  if (fd >= 0)
+    close(fd);
   return NULL;
 }
 
-bool capture_run(SharedCtx *arg, pthread_t *tid)
+bool capture_run(StreamCtx *arg, pthread_t *tid)
 {
   if (pthread_create(tid, NULL, capture_thread, (void *)arg) != 0)
   {
@@ -0,0 +1,296 @@
+/*
+ * @file codec.c
+ * @brief XOR delta + run-length frame codec.
+ */
+#include "codec.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define VARINT_MAX 10 // uint64 LEB128 최대 길이
+
+static inline uint8_t *put_varint(uint8_t *o, uint64_t v)
+{
+  while (v >= 0x80)
+  {
+    *o++ = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  *o++ = (uint8_t)v;
+  return o;
+}
+
+static inline int get_varint(const uint8_t **p, const uint8_t *end, uint64_t *v)
+{
+  uint64_t x = 0;
+  for (int shift = 0; shift < 7 * VARINT_MAX; shift += 7)
+  {
+    if (*p >= end)
+      return -1;
+    uint8_t b = *(*p)++;
+    x |= (uint64_t)(b & 0x7F) << shift;
+    if (!(b & 0x80))
+    {
+      *v = x;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+// p[0] 과 같은 값이 이어지는 길이 (1..n)
+static size_t run_length(const uint8_t *p, size_t n)
+{
+  uint8_t v = p[0];
+  // literal 구간은 대부분 여기서 끝난다
+  if (n < 2 || p[1] != v)
+    return 1;
+
+  size_t i = 0;
+#if defined(__SSE2__)
+  __m128i vv = _mm_set1_epi8((char)v);
+  for (; i + 16 <= n; i += 16)
+  {
+    unsigned m = (unsigned)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + i)), vv));
+    if (m != 0xFFFF)
+      return i + (size_t)__builtin_ctz(~m);
+  }
+#elif defined(__ARM_NEON)
+  uint8x16_t vv = vdupq_n_u8(v);
+  for (; i + 16 <= n; i += 16)
+  {
+    uint64x2_t eq = vreinterpretq_u64_u8(vceqq_u8(vld1q_u8(p + i), vv));
+    if ((vgetq_lane_u64(eq, 0) & vgetq_lane_u64(eq, 1)) != UINT64_MAX)
+      break; // 정확한 위치는 아래 scalar 루프가 찾는다
+  }
+#endif
+  while (i < n && p[i] == v)
+    i++;
+  return i;
+}
+
+static uint8_t *put_literal(uint8_t *o, const uint8_t *src, size_t len)
+{
+  o = put_varint(o, (uint64_t)len << 1);
+  memcpy(o, src, len);
+  return o + len;
+}
+
+size_t codec_bound(size_t bytes, int nslices)
+{
+  if (nslices < 1)
+    nslices = 1;
+  // run token 은 입력보다 길어지지 않으므로 slice 마다 literal 하나 분의 varint 여유면 충분
+  return sizeof(CodecHeader) + (size_t)nslices * (sizeof(uint32_t) + 2 * VARINT_MAX) + bytes;
+}
+
+void codec_xor(uint8_t *dst, const uint8_t *a, const uint8_t *b, size_t n)
+{
+  size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 64 <= n; i += 64)
+  {
+    __m128i a0 = _mm_loadu_si128((const __m128i *)(a + i));
+    __m128i a1 = _mm_loadu_si128((const __m128i *)(a + i + 16));
+    __m128i a2 = _mm_loadu_si128((const __m128i *)(a + i + 32));
+    __m128i a3 = _mm_loadu_si128((const __m128i *)(a + i + 48));
+    __m128i b0 = _mm_loadu_si128((const __m128i *)(b + i));
+    __m128i b1 = _mm_loadu_si128((const __m128i *)(b + i + 16));
+    __m128i b2 = _mm_loadu_si128((const __m128i *)(b + i + 32));
+    __m128i b3 = _mm_loadu_si128((const __m128i *)(b + i + 48));
+    _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(a0, b0));
+    _mm_storeu_si128((__m128i *)(dst + i + 16), _mm_xor_si128(a1, b1));
+    _mm_storeu_si128((__m128i *)(dst + i + 32), _mm_xor_si128(a2, b2));
+    _mm_storeu_si128((__m128i *)(dst + i + 48), _mm_xor_si128(a3, b3));
+  }
+  for (; i + 16 <= n; i += 16)
+    _mm_storeu_si128((__m128i *)(dst + i),
+                     _mm_xor_si128(_mm_loadu_si128((const __m128i *)(a + i)),
+                                   _mm_loadu_si128((const __m128i *)(b + i))));
+#elif defined(__ARM_NEON)
+  for (; i + 16 <= n; i += 16)
+    vst1q_u8(dst + i, veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+#endif
+  for (; i < n; i++)
+    dst[i] = a[i] ^ b[i];
+}
+
+size_t codec_rle_encode(uint8_t *dst, const uint8_t *src, size_t n)
+{
+  uint8_t *o = dst;
+  size_t lit = 0; // 아직 내보내지 않은 literal 의 시작
+  size_t i = 0;
+
+  while (i < n)
+  {
+    size_t run = run_length(src + i, n - i);
+    if (run >= CODEC_MIN_RUN)
+    {
+      if (i > lit)
+        o = put_literal(o, src + lit, i - lit);
+      o = put_varint(o, ((uint64_t)run << 1) | 1);
+      *o++ = src[i];
+      lit = i + run;
+    }
+    i += run;
+  }
+  if (n > lit)
+    o = put_literal(o, src + lit, n - lit);
+  return (size_t)(o - dst);
+}
+
+int codec_rle_decode(uint8_t *dst, size_t n, const uint8_t *src, size_t size)
+{
+  const uint8_t *p = src;
+  const uint8_t *end = src + size;
+  size_t o = 0;
+
+  while (o < n)
+  {
+    uint64_t v;
+    if (get_varint(&p, end, &v) < 0)
+      goto bad;
+    uint64_t len = v >> 1;
+    if (len == 0 || len > n - o)
+      goto bad;
+
+    if (v & 1)
+    {
+      if (p >= end)
+        goto bad;
+      memset(dst + o, *p++, len);
+    }
+    else
+    {
+      if ((uint64_t)(end - p) < len)
+        goto bad;
+      memcpy(dst + o, p, len);
+      p += len;
+    }
+    o += len;
+  }
+  if (p != end)
+    goto bad;
+  return 0;
+
+bad:
+  errno = EPROTO;
+  return -1;
+}
+
+size_t codec_encode_slice(uint8_t *dst, const uint8_t *cur, const uint8_t *ref,
+                          uint8_t *scratch, size_t n)
+{
+  const uint8_t *src = cur;
+  if (ref)
+  {
+    // 변하지 않은 픽셀은 0 이 되어 긴 run 으로 묶인다
+    codec_xor(scratch, cur, ref, n);
+    src = scratch;
+  }
+  return codec_rle_encode(dst, src, n);
+}
+
+// slice i 의 시작 행
+static inline size_t slice_row(size_t height, int nslices, int i)
+{
+  return height * (size_t)i / (size_t)nslices;
+}
+
+void codec_slice_range(size_t width, size_t height, int nslices, int i, size_t *off,
+                       size_t *len)
+{
+  *off = slice_row(height, nslices, i) * width;
+  *len = slice_row(height, nslices, i + 1) * width - *off;
+}
+
+size_t codec_write_header(uint8_t *dst, size_t bytes, int nslices, const uint32_t *sizes)
+{
+  CodecHeader hdr = {.nslices = (uint16_t)nslices, .bytes = (uint32_t)bytes};
+  memcpy(dst, &hdr, sizeof(hdr));
+  memcpy(dst + sizeof(hdr), sizes, (size_t)nslices * sizeof(uint32_t));
+  return sizeof(hdr) + (size_t)nslices * sizeof(uint32_t);
+}
+
+ssize_t codec_encode_frame(uint8_t *dst, size_t cap, const uint8_t *cur, const uint8_t *ref,
+                           uint8_t *scratch, size_t width, size_t height, int nslices)
+{
+  size_t bytes = width * height;
+  if (!dst || !cur || (ref && !scratch) || width == 0 || height == 0 || nslices < 1 ||
+      nslices > CODEC_MAX_SLICES || (size_t)nslices > height || bytes > UINT32_MAX)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  if (cap < codec_bound(bytes, nslices))
+  {
+    errno = ENOBUFS;
+    return -1;
+  }
+
+  uint32_t sizes[CODEC_MAX_SLICES];
+  uint8_t *o = dst + sizeof(CodecHeader) + (size_t)nslices * sizeof(uint32_t);
+  for (int i = 0; i < nslices; i++)
+  {
+    size_t off, len;
+    codec_slice_range(width, height, nslices, i, &off, &len);
+    size_t n = codec_encode_slice(o, cur + off, ref ? ref + off : NULL,
+                                  scratch ? scratch + off : NULL, len);
+    sizes[i] = (uint32_t)n;
+    o += n;
+  }
+  codec_write_header(dst, bytes, nslices, sizes);
+  return (ssize_t)(o - dst);
+}
+
+int codec_decode_frame(uint8_t *dst, const uint8_t *ref, size_t width, size_t height,
+                       const uint8_t *src, size_t size)
+{
+  if (!dst || !src || width == 0 || height == 0)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  CodecHeader hdr;
+  if (size < sizeof(hdr))
+    goto bad;
+  memcpy(&hdr, src, sizeof(hdr));
+  int nslices = hdr.nslices;
+  if (nslices < 1 || nslices > CODEC_MAX_SLICES || (size_t)nslices > height ||
+      hdr.bytes != width * height)
+    goto bad;
+
+  size_t table = sizeof(hdr) + (size_t)nslices * sizeof(uint32_t);
+  if (size < table)
+    goto bad;
+  uint32_t sizes[CODEC_MAX_SLICES];
+  memcpy(sizes, src + sizeof(hdr), (size_t)nslices * sizeof(uint32_t));
+
+  const uint8_t *p = src + table;
+  size_t left = size - table;
+  for (int i = 0; i < nslices; i++)
+  {
+    if (sizes[i] > left)
+      goto bad;
+    size_t off, len;
+    codec_slice_range(width, height, nslices, i, &off, &len);
+    if (codec_rle_decode(dst + off, len, p, sizes[i]) < 0)
+      return -1;
+    if (ref)
+      codec_xor(dst + off, dst + off, ref + off, len);
+    p += sizes[i];
+    left -= sizes[i];
+  }
+  if (left != 0)
+    goto bad;
+  return 0;
+
+bad:
+  errno = EPROTO;
+  return -1;
+}
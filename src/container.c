@@ -0,0 +1,1100 @@
+/*
+ * @file container.c
+ * @brief .tbb recording writer, recovery and player.
+ */
+#define _GNU_SOURCE // sync_file_range
+#include "container.h"
+
+#include <sys/stat.h>
+#include <time.h>
+
+#include "util.h"
+
+// EINTR 와 부분 쓰기를 처리하는 pwritev: 파일 offset 을 쓰지도 바꾸지도 않는다
+static int pwritev_all(int fd, struct iovec *iov, int iovcnt, uint64_t off)
+{
+  while (iovcnt > 0)
+  {
+    ssize_t n = pwritev(fd, iov, iovcnt, (off_t)off);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    off += (uint64_t)n;
+    while (iovcnt > 0 && (size_t)n >= iov->iov_len)
+    {
+      n -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0)
+    {
+      iov->iov_base = (uint8_t *)iov->iov_base + n;
+      iov->iov_len -= n;
+    }
+  }
+  return 0;
+}
+
+// 읽은 바이트 수 반환 (EOF 이면 size 보다 작음), 오류 시 -1
+static ssize_t read_all(int fd, void *buf, size_t size)
+{
+  size_t done = 0;
+  while (done < size)
+  {
+    ssize_t n = read(fd, (uint8_t *)buf + done, size - done);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    if (n == 0)
+      break;
+    done += n;
+  }
+  return (ssize_t)done;
+}
+
+static int pwrite_all(int fd, const void *buf, size_t size, uint64_t off)
+{
+  size_t done = 0;
+  while (done < size)
+  {
+    ssize_t n = pwrite(fd, (const uint8_t *)buf + done, size - done, (off_t)(off + done));
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    done += n;
+  }
+  return 0;
+}
+
+static ssize_t pread_all(int fd, void *buf, size_t size, uint64_t off)
+{
+  size_t done = 0;
+  while (done < size)
+  {
+    ssize_t n = pread(fd, (uint8_t *)buf + done, size - done, (off_t)(off + done));
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    if (n == 0)
+      break;
+    done += n;
+  }
+  return (ssize_t)done;
+}
+
+static char *index_path(const char *path)
+{
+  size_t len = strlen(path);
+  char *idx_path = malloc(len + sizeof(TBB_INDEX_SUFFIX));
+  if (!idx_path)
+  {
+    errno = ENOMEM;
+    return NULL;
+  }
+  memcpy(idx_path, path, len);
+  memcpy(idx_path + len, TBB_INDEX_SUFFIX, sizeof(TBB_INDEX_SUFFIX));
+  return idx_path;
+}
+
+// crc 필드를 0 으로 둔 header 의 crc
+static uint32_t header_crc(const TbbFrameHeader *fh)
+{
+  TbbFrameHeader tmp = *fh;
+  tmp.crc = 0;
+  return crc32c(0, &tmp, sizeof(tmp));
+}
+
+uint32_t tbb_record_crc(const TbbFrameHeader *fh, const void *payload)
+{
+  return crc32c(header_crc(fh), payload, fh->payload_size);
+}
+
+/*
+ * 한 번의 sync: data 를 media 에 내린 뒤, 그 전에 쓰인 record 의 index entry 만 기록.
+ * 호출자가 sync_busy 를 세운 상태에서 mutex 없이 부른다.
+ */
+static int sync_round(TbbWriter *wr)
+{
+  pthread_mutex_lock(&wr->mutex);
+  // 파일에 넘어간 record 만 (direct 모드에서 staging 에 남은 것은 다음 round 로)
+  size_t n = 0;
+  while (n < wr->npending &&
+         wr->pending[n].offset + sizeof(TbbFrameHeader) + wr->pending[n].payload_size <= wr->flushed)
+    n++;
+  memcpy(wr->batch, wr->pending, n * sizeof(TbbIndexEntry));
+  uint64_t idx_off = wr->idx_offset;
+  uint64_t synced = wr->flushed;
+  pthread_mutex_unlock(&wr->mutex);
+  if (n == 0)
+    return 0;
+
+  uint64_t t0 = now_ns();
+  if (fdatasync(wr->fd) < 0 || pwrite_all(wr->idx_fd, wr->batch, n * sizeof(TbbIndexEntry), idx_off) < 0 ||
+      fdatasync(wr->idx_fd) < 0)
+    return -1;
+  uint64_t dt = now_ns() - t0;
+
+  if (wr->io == TBB_IO_DONTNEED && synced > wr->dropped)
+  {
+    // 이제 clean 한 page 라서 바로 버려진다
+    posix_fadvise(wr->fd, (off_t)wr->dropped, (off_t)(synced - wr->dropped), POSIX_FADV_DONTNEED);
+    wr->dropped = synced;
+  }
+
+  pthread_mutex_lock(&wr->mutex);
+  memmove(wr->pending, wr->pending + n, (wr->npending - n) * sizeof(TbbIndexEntry));
+  wr->npending -= n;
+  wr->idx_offset += n * sizeof(TbbIndexEntry);
+  wr->oldest_ns = t0; // 남은 entry 는 이번 round 도중에 쓰였다
+  wr->stats.syncs++;
+  wr->stats.durable += n;
+  wr->stats.sync_ns_total += dt;
+  if (dt > wr->stats.sync_ns_max)
+    wr->stats.sync_ns_max = dt;
+  pthread_mutex_unlock(&wr->mutex);
+  return 0;
+}
+
+// 다른 sync round 가 끝나길 기다렸다가 호출자 스레드에서 한 round 실행
+static int run_sync(TbbWriter *wr)
+{
+  pthread_mutex_lock(&wr->mutex);
+  while (wr->sync_busy)
+    pthread_cond_wait(&wr->cond, &wr->mutex);
+  wr->sync_busy = true;
+  pthread_mutex_unlock(&wr->mutex);
+
+  int ret = sync_round(wr);
+  int saved = errno;
+
+  pthread_mutex_lock(&wr->mutex);
+  wr->sync_busy = false;
+  pthread_cond_broadcast(&wr->cond);
+  pthread_mutex_unlock(&wr->mutex);
+  errno = saved;
+  return ret;
+}
+
+static void *sync_thread(void *arg)
+{
+  TbbWriter *wr = arg;
+
+  pthread_mutex_lock(&wr->mutex);
+  while (!wr->quit)
+  {
+    if (!wr->sync_requested)
+    {
+      if (wr->sync.every_ms)
+      {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        uint64_t ns = (uint64_t)ts.tv_nsec + (uint64_t)wr->sync.every_ms * 1000000ull;
+        ts.tv_sec += (time_t)(ns / 1000000000ull);
+        ts.tv_nsec = (long)(ns % 1000000000ull);
+        pthread_cond_timedwait(&wr->cond, &wr->mutex, &ts);
+        // 기록이 멈춘 동안에도 오래된 record 는 시간 기준으로 내린다
+        if (wr->npending && now_ns() - wr->oldest_ns >= (uint64_t)wr->sync.every_ms * 1000000ull)
+          wr->sync_requested = true;
+      }
+      else
+      {
+        pthread_cond_wait(&wr->cond, &wr->mutex);
+      }
+      continue;
+    }
+
+    wr->sync_requested = false;
+    while (wr->sync_busy)
+      pthread_cond_wait(&wr->cond, &wr->mutex);
+    wr->sync_busy = true;
+    pthread_mutex_unlock(&wr->mutex);
+
+    int ret = sync_round(wr);
+    int saved = errno;
+
+    pthread_mutex_lock(&wr->mutex);
+    wr->sync_busy = false;
+    if (ret < 0 && !wr->sync_error)
+      wr->sync_error = saved;
+    pthread_cond_broadcast(&wr->cond);
+  }
+  pthread_mutex_unlock(&wr->mutex);
+  return NULL;
+}
+
+// 이번 append 로 sync 할 때가 되었는지 (extra: 아직 pending 에 넣지 않은 entry 수)
+static bool sync_due(const TbbWriter *wr, uint64_t now, size_t extra)
+{
+  size_t n = wr->npending + extra;
+  if (n == 0)
+    return false;
+  if (n >= TBB_MAX_PENDING || (wr->sync.every_frames && n >= wr->sync.every_frames))
+    return true;
+  uint64_t oldest = wr->npending ? wr->oldest_ns : now;
+  return wr->sync.every_ms && now - oldest >= (uint64_t)wr->sync.every_ms * 1000000ull;
+}
+
+/*
+ * O_DIRECT staging (writer thread 전용). stage 는 파일의 stage_off 부터의 내용을
+ * 담고, 가득 차면 통째로 기록하고 비운다.
+ */
+static int stage_put(TbbWriter *wr, const void *src, size_t len)
+{
+  const uint8_t *p = src;
+  while (len)
+  {
+    size_t n = wr->stage_cap - wr->stage_fill;
+    if (n > len)
+      n = len;
+    memcpy(wr->stage + wr->stage_fill, p, n);
+    wr->stage_fill += n;
+    p += n;
+    len -= n;
+    if (wr->stage_fill == wr->stage_cap)
+    {
+      if (pwrite_all(wr->fd, wr->stage, wr->stage_cap, wr->stage_off) < 0)
+        return -1;
+      wr->stage_off += wr->stage_cap;
+      wr->stage_fill = 0;
+      wr->written = wr->stage_off;
+    }
+  }
+  return 0;
+}
+
+// 채우다 만 block 을 0 으로 채워 기록. 내용은 stage 에 남아 block 이 차면 다시 쓴다
+static int stage_flush(TbbWriter *wr)
+{
+  if (wr->written == wr->stage_off + wr->stage_fill)
+    return 0;
+  size_t mask = TBB_DIRECT_ALIGN - 1;
+  size_t from = (size_t)(wr->written - wr->stage_off) & ~mask; // 이미 기록된 온전한 block 은 건너뜀
+  size_t to = (wr->stage_fill + mask) & ~mask;
+  memset(wr->stage + wr->stage_fill, 0, to - wr->stage_fill);
+  if (pwrite_all(wr->fd, wr->stage + from, to - from, wr->stage_off + from) < 0)
+    return -1;
+  wr->written = wr->stage_off + wr->stage_fill;
+  return 0;
+}
+
+static void stop_sync_thread(TbbWriter *wr)
+{
+  if (!wr->sync_thread)
+    return;
+  pthread_mutex_lock(&wr->mutex);
+  wr->quit = true;
+  pthread_cond_broadcast(&wr->cond);
+  pthread_mutex_unlock(&wr->mutex);
+  pthread_join(wr->sync_tid, NULL);
+  wr->sync_thread = false;
+  wr->quit = false;
+}
+
+int tbb_writer_open(TbbWriter *wr, const char *path, uint32_t width, uint32_t height,
+                    uint32_t depth, uint32_t interval_us)
+{
+  if (!wr || !path || width == 0 || height == 0 || depth == 0)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  memset(wr, 0, sizeof(*wr));
+  wr->fd = -1;
+  wr->idx_fd = -1;
+
+  wr->pending = malloc(TBB_MAX_PENDING * sizeof(TbbIndexEntry));
+  wr->batch = malloc(TBB_MAX_PENDING * sizeof(TbbIndexEntry));
+  wr->biov = malloc(TBB_BATCH_IOV * sizeof(struct iovec));
+  char *idx_path = index_path(path);
+  if (!wr->pending || !wr->batch || !wr->biov || !idx_path)
+  {
+    free(wr->pending);
+    free(wr->batch);
+    free(wr->biov);
+    free(idx_path);
+    wr->pending = wr->batch = NULL;
+    wr->biov = NULL;
+    errno = ENOMEM;
+    return -1;
+  }
+  pthread_mutex_init(&wr->mutex, NULL);
+  pthread_cond_init(&wr->cond, NULL);
+
+  wr->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  wr->idx_fd = open(idx_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  free(idx_path);
+  if (wr->fd < 0 || wr->idx_fd < 0)
+    goto fail;
+
+  wr->hdr = (TbbFileHeader){
+      .magic = TBB_FILE_MAGIC,
+      .version = TBB_VERSION,
+      .header_size = sizeof(TbbFileHeader),
+      .width = width,
+      .height = height,
+      .depth = depth,
+      .frame_interval_us = interval_us,
+      .flags = TBB_FILE_CRC32C,
+  };
+  TbbIndexHeader ih = {
+      .magic = TBB_INDEX_MAGIC,
+      .version = TBB_VERSION,
+      .entry_size = sizeof(TbbIndexEntry),
+  };
+  if (pwrite_all(wr->fd, &wr->hdr, sizeof(wr->hdr), 0) < 0 ||
+      pwrite_all(wr->idx_fd, &ih, sizeof(ih), 0) < 0)
+    goto fail;
+
+  wr->offset = sizeof(TbbFileHeader);
+  wr->bytes = sizeof(TbbFileHeader);
+  wr->wb_offset = sizeof(TbbFileHeader);
+  wr->idx_offset = sizeof(TbbIndexHeader);
+  wr->written = sizeof(TbbFileHeader);
+  wr->flushed = sizeof(TbbFileHeader);
+  return 0;
+
+fail:
+  {
+    int saved = errno;
+    tbb_writer_close(wr);
+    errno = saved;
+  }
+  return -1;
+}
+
+int tbb_writer_set_sync(TbbWriter *wr, const TbbSyncPolicy *policy)
+{
+  if (!wr || !wr->pending || !policy)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  stop_sync_thread(wr);
+  pthread_mutex_lock(&wr->mutex);
+  wr->sync = *policy;
+  pthread_mutex_unlock(&wr->mutex);
+
+  if (policy->background)
+  {
+    if (pthread_create(&wr->sync_tid, NULL, sync_thread, wr) != 0)
+    {
+      wr->sync.background = false;
+      errno = EAGAIN;
+      return -1;
+    }
+    wr->sync_thread = true;
+  }
+  return 0;
+}
+
+int tbb_writer_set_io(TbbWriter *wr, TbbIoMode mode, size_t write_size)
+{
+  if (!wr || wr->fd < 0 || mode > TBB_IO_DIRECT)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  if (wr->records || wr->offset != sizeof(TbbFileHeader) || wr->io == TBB_IO_DIRECT)
+  {
+    errno = EBUSY;
+    return -1;
+  }
+
+  if (mode == TBB_IO_DIRECT)
+  {
+    size_t cap = write_size ? (write_size + TBB_DIRECT_ALIGN - 1) & ~(size_t)(TBB_DIRECT_ALIGN - 1)
+                            : TBB_DIRECT_WRITE_SIZE;
+    void *stage;
+    if (posix_memalign(&stage, TBB_DIRECT_ALIGN, cap) != 0)
+    {
+      errno = ENOMEM;
+      return -1;
+    }
+    int fl = fcntl(wr->fd, F_GETFL);
+    if (fl < 0 || fcntl(wr->fd, F_SETFL, fl | O_DIRECT) < 0)
+    {
+      int saved = errno;
+      free(stage);
+      errno = saved;
+      return -1;
+    }
+    // 첫 block 에는 이미 기록된 file header 가 들어 있다
+    wr->stage = stage;
+    wr->stage_cap = cap;
+    memcpy(wr->stage, &wr->hdr, sizeof(wr->hdr));
+    wr->stage_fill = sizeof(wr->hdr);
+    wr->stage_off = 0;
+  }
+  wr->io = mode;
+  return 0;
+}
+
+int tbb_writer_sync(TbbWriter *wr)
+{
+  if (!wr || wr->fd < 0)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  pthread_mutex_lock(&wr->mutex);
+  int err = wr->sync_error;
+  wr->sync_error = 0;
+  pthread_mutex_unlock(&wr->mutex);
+  if (err)
+  {
+    errno = err;
+    return -1;
+  }
+  if (wr->io == TBB_IO_DIRECT && stage_flush(wr) < 0)
+    return -1;
+  pthread_mutex_lock(&wr->mutex);
+  wr->flushed = wr->written;
+  pthread_mutex_unlock(&wr->mutex);
+  return run_sync(wr);
+}
+
+int tbb_writer_rewind(TbbWriter *wr)
+{
+  if (!wr || wr->fd < 0)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  // 진행 중인 sync round 가 옛 entry 를 index 에 쓰지 못하게 끝날 때까지 기다린다
+  pthread_mutex_lock(&wr->mutex);
+  while (wr->sync_busy)
+    pthread_cond_wait(&wr->cond, &wr->mutex);
+  wr->npending = 0;
+  wr->nbatch = 0; // 이전 회차의 미기록 record 는 버린다
+  wr->nbiov = 0;
+  wr->sync_requested = false;
+  int ret = 0;
+  if (ftruncate(wr->fd, sizeof(TbbFileHeader)) < 0 ||
+      ftruncate(wr->idx_fd, sizeof(TbbIndexHeader)) < 0)
+    ret = -1;
+  wr->offset = sizeof(TbbFileHeader);
+  wr->wb_offset = sizeof(TbbFileHeader);
+  wr->idx_offset = sizeof(TbbIndexHeader);
+  wr->written = sizeof(TbbFileHeader);
+  wr->flushed = sizeof(TbbFileHeader);
+  wr->dropped = 0;
+  wr->records = 0;
+  if (wr->stage)
+  {
+    memcpy(wr->stage, &wr->hdr, sizeof(wr->hdr));
+    wr->stage_fill = sizeof(TbbFileHeader);
+    wr->stage_off = 0;
+  }
+  pthread_mutex_unlock(&wr->mutex);
+  return ret;
+}
+
+int tbb_writer_append(TbbWriter *wr, uint64_t seq, uint8_t codec, uint8_t flags,
+                      uint32_t skipped, const void *payload, uint32_t size)
+{
+  struct iovec iov = {.iov_base = (void *)payload, .iov_len = size};
+  if (size && !payload)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  return tbb_writer_appendv(wr, seq, codec, flags, skipped, &iov, size ? 1 : 0);
+}
+
+/*
+ * 파일로 넘어간 record 의 후처리: writeback 시작, index entry 를 pending 에 넣고
+ * policy 에 따라 sync.
+ */
+static int commit_record(TbbWriter *wr, const TbbIndexEntry *e)
+{
+  if (wr->io != TBB_IO_DIRECT)
+    wr->written = e->offset + sizeof(TbbFrameHeader) + e->payload_size;
+
+  if (wr->sync.writeback && wr->io != TBB_IO_DIRECT)
+  {
+    // 기다리지 않고 writeback 만 시작: 다음 fdatasync 가 짧아진다
+    sync_file_range(wr->fd, (off_t)wr->wb_offset, (off_t)(wr->written - wr->wb_offset),
+                    SYNC_FILE_RANGE_WRITE);
+    wr->wb_offset = wr->written;
+  }
+
+  /* index entry 는 data 가 durable 해진 뒤에 기록되도록 pending 에 둔다 */
+  uint64_t now = now_ns();
+  uint64_t stall = 0;
+  int ret = 0;
+  if (wr->io == TBB_IO_DIRECT)
+  {
+    // sync 할 때가 되었으면 staging 의 마지막 block 까지 파일로 넘긴다
+    pthread_mutex_lock(&wr->mutex);
+    bool flush = sync_due(wr, now, 1);
+    pthread_mutex_unlock(&wr->mutex);
+    if (flush && stage_flush(wr) < 0)
+      return -1;
+  }
+  pthread_mutex_lock(&wr->mutex);
+  wr->flushed = wr->written;
+  if (wr->sync_error)
+  {
+    errno = wr->sync_error;
+    wr->sync_error = 0;
+    ret = -1;
+  }
+  while (ret == 0 && wr->npending == TBB_MAX_PENDING)
+  {
+    // pending 이 가득 참: sync 가 끝날 때까지 기다리는 수밖에 없다
+    if (wr->sync_thread)
+    {
+      wr->sync_requested = true;
+      pthread_cond_broadcast(&wr->cond);
+      pthread_cond_wait(&wr->cond, &wr->mutex);
+      if (wr->sync_error)
+        ret = -1, errno = wr->sync_error, wr->sync_error = 0;
+    }
+    else
+    {
+      pthread_mutex_unlock(&wr->mutex);
+      ret = run_sync(wr);
+      pthread_mutex_lock(&wr->mutex);
+    }
+  }
+  if (ret == 0)
+  {
+    if (wr->npending == 0)
+      wr->oldest_ns = now;
+    wr->pending[wr->npending++] = *e;
+  }
+  bool due = ret == 0 && sync_due(wr, now, 0);
+  if (due && wr->sync_thread)
+  {
+    wr->sync_requested = true;
+    pthread_cond_broadcast(&wr->cond);
+    due = false;
+  }
+  pthread_mutex_unlock(&wr->mutex);
+
+  if (due)
+    ret = run_sync(wr);
+  stall = now_ns() - now;
+
+  pthread_mutex_lock(&wr->mutex);
+  wr->stats.stall_ns_total += stall;
+  if (stall > wr->stats.stall_ns_max)
+    wr->stats.stall_ns_max = stall;
+  pthread_mutex_unlock(&wr->mutex);
+  return ret;
+}
+
+// 모아 둔 record 를 첫 record 의 offset 에 pwritev 한 번으로 기록하고 차례로 commit
+static int flush_batch(TbbWriter *wr)
+{
+  int n = wr->nbatch;
+  int niov = wr->nbiov;
+  wr->nbatch = 0;
+  wr->nbiov = 0;
+  if (n == 0)
+    return 0;
+  if (pwritev_all(wr->fd, wr->biov, niov, wr->bentry[0].offset) < 0)
+    return -1;
+  int ret = 0;
+  for (int i = 0; i < n; i++)
+    if (commit_record(wr, &wr->bentry[i]) < 0)
+      ret = -1;
+  return ret;
+}
+
+void tbb_writer_begin_batch(TbbWriter *wr)
+{
+  if (wr && wr->biov)
+    wr->batching = true;
+}
+
+int tbb_writer_end_batch(TbbWriter *wr)
+{
+  if (!wr)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  wr->batching = false;
+  return flush_batch(wr);
+}
+
+int tbb_writer_appendv(TbbWriter *wr, uint64_t seq, uint8_t codec, uint8_t flags,
+                       uint32_t skipped, const struct iovec *payload, int count)
+{
+  if (!wr || wr->fd < 0 || count < 0 || count > TBB_MAX_IOV || (count && !payload))
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  TbbFrameHeader fh = {
+      .magic = TBB_FRAME_MAGIC,
+      .codec = codec,
+      .flags = flags,
+      .seq = seq,
+      .skipped = skipped,
+  };
+  // pwritev_all 이 iovec 을 고쳐 쓰므로 복사본을 넘긴다
+  struct iovec iov[TBB_MAX_IOV + 1];
+  size_t size = 0;
+  iov[0] = (struct iovec){.iov_base = &fh, .iov_len = sizeof(fh)};
+  for (int i = 0; i < count; i++)
+  {
+    iov[i + 1] = payload[i];
+    size += payload[i].iov_len;
+  }
+  if (size > UINT32_MAX)
+  {
+    errno = EFBIG;
+    return -1;
+  }
+  fh.payload_size = (uint32_t)size;
+  uint32_t crc = header_crc(&fh);
+  for (int i = 0; i < count; i++)
+    crc = crc32c(crc, payload[i].iov_base, payload[i].iov_len);
+  fh.crc = crc;
+  if (wr->io == TBB_IO_DIRECT)
+  {
+    for (int i = 0; i <= count; i++)
+      if (stage_put(wr, iov[i].iov_base, iov[i].iov_len) < 0)
+        return -1;
+  }
+  else if (wr->batching)
+  {
+    // 다음 record 들과 함께 pwritev 한 번으로 기록 (payload 는 end_batch 까지 유효)
+    if ((wr->nbatch == TBB_BATCH_RECORDS || wr->nbiov + count + 1 > TBB_BATCH_IOV) &&
+        flush_batch(wr) < 0)
+      return -1;
+    wr->bhead[wr->nbatch] = fh;
+    wr->biov[wr->nbiov++] = (struct iovec){.iov_base = &wr->bhead[wr->nbatch], .iov_len = sizeof(fh)};
+    for (int i = 0; i < count; i++)
+      wr->biov[wr->nbiov++] = payload[i];
+  }
+  else if (pwritev_all(wr->fd, iov, count + 1, wr->offset) < 0)
+  {
+    return -1;
+  }
+
+  TbbIndexEntry ie = {
+      .seq = seq,
+      .offset = wr->offset,
+      .payload_size = (uint32_t)size,
+      .skipped = skipped,
+      .codec = codec,
+      .flags = flags,
+      .crc = crc,
+  };
+  wr->offset += sizeof(fh) + size;
+  wr->bytes += sizeof(fh) + size;
+  wr->records++;
+
+  if (wr->batching && wr->io != TBB_IO_DIRECT)
+  {
+    wr->bentry[wr->nbatch++] = ie;
+    return 0;
+  }
+  return commit_record(wr, &ie);
+}
+
+void tbb_writer_close(TbbWriter *wr)
+{
+  if (!wr)
+    return;
+  if (wr->pending)
+  {
+    stop_sync_thread(wr);
+    if (wr->fd >= 0 && wr->idx_fd >= 0)
+    {
+      if (tbb_writer_end_batch(wr) < 0)
+        perror("tbb_writer_close: batch");
+      // direct 모드: 마지막 block 을 기록하고 padding 을 잘라낸다
+      if (wr->io == TBB_IO_DIRECT && (stage_flush(wr) < 0 || ftruncate(wr->fd, (off_t)wr->offset) < 0))
+        perror("tbb_writer_close: direct tail");
+      wr->flushed = wr->written;
+      if (run_sync(wr) < 0)
+        perror("tbb_writer_close: sync");
+    }
+  }
+  if (wr->fd >= 0)
+    close(wr->fd);
+  if (wr->idx_fd >= 0)
+    close(wr->idx_fd);
+  wr->fd = -1;
+  wr->idx_fd = -1;
+  if (wr->pending)
+  {
+    free(wr->pending);
+    free(wr->batch);
+    free(wr->stage);
+    free(wr->biov);
+    wr->pending = NULL;
+    wr->batch = NULL;
+    wr->stage = NULL;
+    wr->biov = NULL;
+    pthread_mutex_destroy(&wr->mutex);
+    pthread_cond_destroy(&wr->cond);
+  }
+}
+
+int tbb_recover(const char *path, TbbRecovery *out)
+{
+  TbbRecovery rec = {0};
+  TbbIndexEntry *tail = NULL;
+  size_t ntail = 0, tail_cap = 0;
+  uint8_t *buf = NULL;
+  size_t buf_cap = 0;
+  char *idx_path = NULL;
+  int idx_fd = -1;
+  int ret = -1;
+
+  if (!path)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  int fd = open(path, O_RDWR);
+  if (fd < 0)
+    return -1;
+
+  struct stat st;
+  TbbFileHeader hdr;
+  if (fstat(fd, &st) < 0)
+    goto out;
+  uint64_t size = (uint64_t)st.st_size;
+  if (pread_all(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) || hdr.magic != TBB_FILE_MAGIC ||
+      hdr.header_size < sizeof(hdr))
+  {
+    ret = 0; // 녹화 파일이 아니면 손대지 않는다
+    goto out;
+  }
+
+  idx_path = index_path(path);
+  if (!idx_path)
+    goto out;
+  idx_fd = open(idx_path, O_RDWR | O_CREAT, 0644);
+  if (idx_fd < 0)
+    goto out;
+
+  /* 1. index 에 있는 record 는 기록 당시 durable: 위치와 header 만 확인 */
+  uint64_t off = hdr.header_size;
+  TbbIndexHeader ih;
+  bool idx_ok = pread_all(idx_fd, &ih, sizeof(ih), 0) == (ssize_t)sizeof(ih) &&
+                ih.magic == TBB_INDEX_MAGIC && ih.entry_size == sizeof(TbbIndexEntry);
+  while (idx_ok)
+  {
+    TbbIndexEntry e;
+    TbbFrameHeader fh;
+    uint64_t at = sizeof(ih) + rec.indexed * sizeof(e);
+    if (pread_all(idx_fd, &e, sizeof(e), at) != (ssize_t)sizeof(e) || e.offset != off ||
+        off + sizeof(fh) + e.payload_size > size ||
+        pread_all(fd, &fh, sizeof(fh), off) != (ssize_t)sizeof(fh) || fh.magic != TBB_FRAME_MAGIC ||
+        fh.seq != e.seq || fh.crc != e.crc)
+      break;
+    off += sizeof(fh) + e.payload_size;
+    rec.indexed++;
+  }
+
+  /* 2. index 뒤의 record 는 header 와 CRC 로 확인 */
+  while (off + sizeof(TbbFrameHeader) <= size)
+  {
+    TbbFrameHeader fh;
+    if (pread_all(fd, &fh, sizeof(fh), off) != (ssize_t)sizeof(fh) || fh.magic != TBB_FRAME_MAGIC ||
+        off + sizeof(fh) + fh.payload_size > size)
+      break;
+    if (hdr.flags & TBB_FILE_CRC32C)
+    {
+      if (fh.payload_size > buf_cap)
+      {
+        free(buf);
+        buf_cap = fh.payload_size;
+        buf = malloc(buf_cap);
+        if (!buf)
+        {
+          errno = ENOMEM;
+          goto out;
+        }
+      }
+      if (pread_all(fd, buf, fh.payload_size, off + sizeof(fh)) != (ssize_t)fh.payload_size ||
+          tbb_record_crc(&fh, buf) != fh.crc)
+        break;
+    }
+    if (ntail == tail_cap)
+    {
+      size_t ncap = tail_cap ? tail_cap * 2 : 64;
+      TbbIndexEntry *p = realloc(tail, ncap * sizeof(*p));
+      if (!p)
+      {
+        errno = ENOMEM;
+        goto out;
+      }
+      tail = p;
+      tail_cap = ncap;
+    }
+    tail[ntail++] = (TbbIndexEntry){
+        .seq = fh.seq,
+        .offset = off,
+        .payload_size = fh.payload_size,
+        .skipped = fh.skipped,
+        .codec = fh.codec,
+        .flags = fh.flags,
+        .crc = fh.crc,
+    };
+    off += sizeof(fh) + fh.payload_size;
+  }
+  rec.records = rec.indexed + ntail;
+
+  /* 3. 마지막 온전한 record 뒤를 잘라내고 index 를 맞춘다 */
+  rec.dropped_bytes = size - off;
+  if (rec.dropped_bytes && ftruncate(fd, (off_t)off) < 0)
+    goto out;
+  ih = (TbbIndexHeader){
+      .magic = TBB_INDEX_MAGIC,
+      .version = TBB_VERSION,
+      .entry_size = sizeof(TbbIndexEntry),
+  };
+  uint64_t idx_end = sizeof(ih) + rec.indexed * sizeof(TbbIndexEntry);
+  if (pwrite_all(idx_fd, &ih, sizeof(ih), 0) < 0 || ftruncate(idx_fd, (off_t)idx_end) < 0 ||
+      pwrite_all(idx_fd, tail, ntail * sizeof(TbbIndexEntry), idx_end) < 0 || fdatasync(fd) < 0 ||
+      fdatasync(idx_fd) < 0)
+    goto out;
+  ret = 0;
+
+out:
+  {
+    int saved = errno;
+    if (out)
+      *out = rec;
+    free(tail);
+    free(buf);
+    free(idx_path);
+    if (idx_fd >= 0)
+      close(idx_fd);
+    close(fd);
+    errno = saved;
+  }
+  return ret;
+}
+
+int tbb_reader_open_fd(TbbReader *rd, int fd)
+{
+  if (!rd || fd < 0)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  memset(rd, 0, sizeof(*rd));
+  rd->fd = fd;
+
+  if (lseek(fd, 0, SEEK_SET) < 0)
+    return -1;
+  ssize_t n = read_all(fd, &rd->hdr, sizeof(rd->hdr));
+  if (n < 0)
+    return -1;
+  if (n != sizeof(rd->hdr) || rd->hdr.magic != TBB_FILE_MAGIC)
+  {
+    // .tbb 가 아니면 raw 로 읽도록 되감는다
+    if (lseek(fd, 0, SEEK_SET) < 0)
+      return -1;
+    return 0;
+  }
+  if (rd->hdr.version != TBB_VERSION || rd->hdr.header_size < sizeof(TbbFileHeader) ||
+      rd->hdr.width == 0 || rd->hdr.height == 0 || rd->hdr.depth == 0)
+  {
+    errno = EPROTO;
+    return -1;
+  }
+
+  rd->verify = (rd->hdr.flags & TBB_FILE_CRC32C) != 0;
+  rd->frame_bytes = (size_t)rd->hdr.width * rd->hdr.height * rd->hdr.depth;
+  rd->frame = malloc(rd->frame_bytes);
+  rd->next = malloc(rd->frame_bytes);
+  rd->payload_cap = codec_bound(rd->frame_bytes, CODEC_MAX_SLICES);
+  rd->payload = malloc(rd->payload_cap);
+  if (!rd->frame || !rd->next || !rd->payload)
+  {
+    tbb_reader_close(rd);
+    errno = ENOMEM;
+    return -1;
+  }
+  if (lseek(fd, rd->hdr.header_size, SEEK_SET) < 0)
+  {
+    tbb_reader_close(rd);
+    return -1;
+  }
+  return 1;
+}
+
+/*
+ * 손상된 record 는 버리고, 이어지는 delta 도 다음 key record 까지 건너뛰게 한다.
+ */
+static bool crc_ok(TbbReader *rd, const TbbFrameHeader *fh, const void *payload)
+{
+  if (!rd->verify || tbb_record_crc(fh, payload) == fh->crc)
+    return true;
+  rd->crc_errors++;
+  rd->have_frame = false;
+  return false;
+}
+
+/*
+ * 다음 record 를 rd->next 로 읽는다.
+ * 파일 끝이나 잘린 record 를 만나면 처음 record 로 돌아가고 *wrapped = 1.
+ */
+static int read_record(TbbReader *rd, TbbFrameHeader *fh, int *wrapped)
+{
+  int restarts = 0;
+
+  while (1)
+  {
+    // UI 재시작으로 offset 이 0 이 되었으면 header 를 건너뛴다
+    off_t pos = lseek(rd->fd, 0, SEEK_CUR);
+    if (pos >= 0 && pos < (off_t)rd->hdr.header_size)
+    {
+      if (lseek(rd->fd, rd->hdr.header_size, SEEK_SET) < 0)
+        return -1;
+      rd->have_frame = false;
+    }
+
+    ssize_t n = read_all(rd->fd, fh, sizeof(*fh));
+    if (n < 0)
+      return -1;
+
+    bool ok = n == sizeof(*fh) && fh->magic == TBB_FRAME_MAGIC;
+    if (ok && (fh->flags & TBB_FLAG_HOLD))
+    {
+      // payload 없는 hold record: 직전 화면이 이어짐
+      if (fh->payload_size != 0)
+      {
+        errno = EPROTO;
+        return -1;
+      }
+      if (rd->verify && tbb_record_crc(fh, NULL) != fh->crc)
+      {
+        rd->crc_errors++;
+        continue;
+      }
+      if (fh->skipped == 0 || !rd->have_frame)
+        continue;
+      return 0;
+    }
+    if (ok && fh->codec == TBB_CODEC_RAW && fh->payload_size == rd->frame_bytes)
+    {
+      n = read_all(rd->fd, rd->next, rd->frame_bytes);
+      if (n < 0)
+        return -1;
+      ok = (size_t)n == rd->frame_bytes;
+      if (ok && !crc_ok(rd, fh, rd->next))
+        continue;
+    }
+    else if (ok && (fh->codec == TBB_CODEC_RLE || fh->codec == TBB_CODEC_XOR_RLE) &&
+             fh->payload_size <= rd->payload_cap)
+    {
+      n = read_all(rd->fd, rd->payload, fh->payload_size);
+      if (n < 0)
+        return -1;
+      ok = (size_t)n == fh->payload_size;
+      if (ok && !crc_ok(rd, fh, rd->payload))
+        continue;
+      if (ok && fh->codec == TBB_CODEC_XOR_RLE && !rd->have_frame)
+        continue; // 기준 화면 없는 delta: 다음 key record 까지 건너뛴다
+      const uint8_t *ref = fh->codec == TBB_CODEC_XOR_RLE ? rd->frame : NULL;
+      if (ok && codec_decode_frame(rd->next, ref, rd->hdr.width * rd->hdr.depth, rd->hdr.height,
+                                   rd->payload, fh->payload_size) < 0)
+        return -1;
+    }
+    else if (ok)
+    {
+      errno = EPROTO;
+      return -1;
+    }
+    if (ok)
+      return 0;
+
+    // EOF 또는 기록 도중 끊긴 마지막 record: 처음부터 다시 재생
+    if (++restarts > 1)
+    {
+      errno = ENODATA;
+      return -1;
+    }
+    if (lseek(rd->fd, rd->hdr.header_size, SEEK_SET) < 0)
+      return -1;
+    rd->have_frame = false;
+    rd->repeat = 0;
+    *wrapped = 1;
+  }
+}
+
+int tbb_reader_read_frame(TbbReader *rd, void *out, size_t size)
+{
+  if (!rd || !rd->frame || !out || size != rd->frame_bytes)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  int wrapped = 0;
+  if (rd->repeat > 0)
+  {
+    rd->repeat--;
+  }
+  else if (rd->pending)
+  {
+    uint8_t *tmp = rd->frame;
+    rd->frame = rd->next;
+    rd->next = tmp;
+    rd->pending = false;
+  }
+  else
+  {
+    TbbFrameHeader fh;
+    if (read_record(rd, &fh, &wrapped) < 0)
+      return -1;
+
+    if (fh.flags & TBB_FLAG_HOLD)
+    {
+      rd->repeat = fh.skipped - 1;
+    }
+    else if (fh.skipped > 0 && rd->have_frame)
+    {
+      // 저장되지 않은 구간은 직전 화면을 skipped 번 반복
+      rd->repeat = fh.skipped - 1;
+      rd->pending = true;
+    }
+    else
+    {
+      uint8_t *tmp = rd->frame;
+      rd->frame = rd->next;
+      rd->next = tmp;
+      rd->have_frame = true;
+    }
+  }
+
+  memcpy(out, rd->frame, rd->frame_bytes);
+  return wrapped;
+}
+
+void tbb_reader_close(TbbReader *rd)
+{
+  if (!rd)
+    return;
+  free(rd->frame);
+  free(rd->next);
+  free(rd->payload);
+  rd->frame = NULL;
+  rd->next = NULL;
+  rd->payload = NULL;
+}
@@ -0,0 +1,147 @@
+/*
+ * @file crc32c.c
+ * @brief CRC-32C with hardware dispatch and slicing-by-8 fallback.
+ */
+#include "crc32c.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define CRC32C_X86 1
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#define CRC32C_ARM 1
+#endif
+
+#define CRC32C_POLY 0x82F63B78u // reflected Castagnoli polynomial
+
+static uint32_t table[8][256];
+static uint32_t (*crc_impl)(uint32_t, const uint8_t *, size_t);
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
+
+// crc 는 반전된 상태로 주고받는다 (초기값/최종 xor 는 crc32c() 에서)
+static uint32_t crc_sw(uint32_t crc, const uint8_t *p, size_t n)
+{
+  // 정렬 전 앞부분
+  while (n && ((uintptr_t)p & 7))
+  {
+    crc = table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    n--;
+  }
+  while (n >= 8)
+  {
+    uint32_t lo, hi;
+    memcpy(&lo, p, 4);
+    memcpy(&hi, p + 4, 4);
+    lo ^= crc;
+    crc = table[7][lo & 0xFF] ^ table[6][(lo >> 8) & 0xFF] ^ table[5][(lo >> 16) & 0xFF] ^
+          table[4][lo >> 24] ^ table[3][hi & 0xFF] ^ table[2][(hi >> 8) & 0xFF] ^
+          table[1][(hi >> 16) & 0xFF] ^ table[0][hi >> 24];
+    p += 8;
+    n -= 8;
+  }
+  while (n--)
+    crc = table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+  return crc;
+}
+
+#if defined(CRC32C_X86)
+__attribute__((target("sse4.2"))) static uint32_t crc_hw(uint32_t crc, const uint8_t *p, size_t n)
+{
+  while (n && ((uintptr_t)p & 7))
+  {
+    crc = _mm_crc32_u8(crc, *p++);
+    n--;
+  }
+#if defined(__x86_64__)
+  uint64_t c = crc;
+  while (n >= 8)
+  {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    c = _mm_crc32_u64(c, v);
+    p += 8;
+    n -= 8;
+  }
+  crc = (uint32_t)c;
+#endif
+  while (n >= 4)
+  {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    crc = _mm_crc32_u32(crc, v);
+    p += 4;
+    n -= 4;
+  }
+  while (n--)
+    crc = _mm_crc32_u8(crc, *p++);
+  return crc;
+}
+#elif defined(CRC32C_ARM)
+__attribute__((target("+crc"))) static uint32_t crc_hw(uint32_t crc, const uint8_t *p, size_t n)
+{
+  while (n && ((uintptr_t)p & 7))
+  {
+    crc = __crc32cb(crc, *p++);
+    n--;
+  }
+  while (n >= 8)
+  {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    crc = __crc32cd(crc, v);
+    p += 8;
+    n -= 8;
+  }
+  while (n--)
+    crc = __crc32cb(crc, *p++);
+  return crc;
+}
+#endif
+
+static void crc_init(void)
+{
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    uint32_t c = i;
+    for (int k = 0; k < 8; k++)
+      c = (c & 1) ? (c >> 1) ^ CRC32C_POLY : c >> 1;
+    table[0][i] = c;
+  }
+  // table[k][i]: byte i 뒤에 0 이 k 개 더 붙은 crc
+  for (uint32_t i = 0; i < 256; i++)
+    for (int k = 1; k < 8; k++)
+      table[k][i] = table[0][table[k - 1][i] & 0xFF] ^ (table[k - 1][i] >> 8);
+
+  crc_impl = crc_sw;
+#if defined(CRC32C_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.2"))
+    crc_impl = crc_hw;
+#elif defined(CRC32C_ARM)
+  if (getauxval(AT_HWCAP) & HWCAP_CRC32)
+    crc_impl = crc_hw;
+#endif
+}
+
+uint32_t crc32c(uint32_t crc, const void *buf, size_t n)
+{
+  pthread_once(&crc_once, crc_init);
+  return ~crc_impl(~crc, buf, n);
+}
+
+uint32_t crc32c_sw(uint32_t crc, const void *buf, size_t n)
+{
+  pthread_once(&crc_once, crc_init);
+  return ~crc_sw(~crc, buf, n);
+}
+
+bool crc32c_hw_available(void)
+{
+  pthread_once(&crc_once, crc_init);
+  return crc_impl != crc_sw;
+}
@@ -4,11 +4,106 @@
  */
 #include "display.h"
 
+/**
+ * @brief Render one menu button into the overlay layer.
+ * @param[in,out] ovl      Overlay layer.
+ * @param[in]     label    Laid-out label text.
+ * @param[in]     i        Button index.
+ * @param[in]     selected Draw as the active state.
+ */
+static void menu_render_button(OverlayLayer *ovl, const TextRun *label, int i, bool selected)
+{
+  OvlRect box = {.x = 8 + i * 110, .y = 8, .w = 100, .h = 24};
+
+  ovl_fill_rect(ovl, box, OVL_ARGB(0, 0, 0, 0));
+  if (selected)
+  {
+    // 선택된 버튼: 흰 배경 + 검은 텍스트
+    ovl_fill_rect(ovl, box, OVL_ARGB(255, 255, 255, 255));
+    ovl_draw_text(ovl, label, box.x + 2, box.y + 2, OVL_ARGB(255, 0, 0, 0));
+  }
+  else
+  {
+    // 비선택 버튼: 테두리 + 흰 텍스트
+    ovl_draw_rect(ovl, box, OVL_ARGB(255, 255, 255, 255));
+    ovl_draw_text(ovl, label, box.x + 2, box.y + 2, OVL_ARGB(255, 255, 255, 255));
+  }
+}
+
+/**
+ * @brief Outline the latest motion regions, scaled from frame to @p view.
+ * @param[in,out] dev   Framebuffer.
+ * @param[in]     board Shared motion board.
+ * @param[in]     frame Frame that was just drawn.
+ * @param[in]     view  Panel area the frame was drawn into.
+ * @return Number of boxes drawn.
+ */
+static int motion_draw_regions(dev_fb *dev, MotionBoard *board, const Frame *frame, OvlRect view)
+{
+  MotionEvent ev;
+
+  if (!atomic_load_explicit(&board->active, memory_order_acquire))
+    return 0;
+  md_board_snapshot(board, &ev);
+
+  for (int i = 0; i < ev.nregions; ++i)
+  {
+    const MotionRegion *r = &ev.regions[i];
+    pixel px = {.x = view.x + (int)((size_t)r->x * view.w / frame->width),
+                .y = view.y + (int)((size_t)r->y * view.h / frame->height)};
+    int w = (int)((size_t)r->w * view.w / frame->width);
+    int h = (int)((size_t)r->h * view.h / frame->height);
+    fb_drawBox(dev, px, w, h, (char)255, 0, 0);
+  }
+  return ev.nregions;
+}
+
+/**
+ * @brief Give a block back to the pool of the stream it came from.
+ * @param[in] ctx Shared context.
+ * @param[in] fb  Block (NULL safe).
+ */
+static void release_block(SharedCtx *ctx, FrameBlock *fb)
+{
+  if (fb)
+    fp_release(ctx->streams[fb->frame.stream].frame_pool, fb);
+}
+
+/**
+ * @brief Take every queued block and keep only the newest one per stream.
+ *
+ * Older frames of a stream are released right away; the kept ones are handed
+ * to the mosaic and stay referenced in @p latest until after the compose.
+ * @param[in]     ctx    Shared context.
+ * @param[in,out] mosaic Compositor.
+ * @param[out]    latest Newest block per stream (NULL: none).
+ * @return Number of blocks taken; 0 once capture has stopped.
+ */
+static size_t mosaic_take_latest(SharedCtx *ctx, Mosaic *mosaic, FrameBlock *latest[STREAM_MAX])
+{
+  FrameBlock *blocks[DISPLAY_BATCH_MAX];
+  size_t n = dequeue_n(ctx->display_q, (void **)blocks, DISPLAY_BATCH_MAX, QUEUE_WAIT_FOREVER);
+
+  for (size_t i = 0; i < n; i++)
+  {
+    FrameBlock *fb = blocks[i];
+    int s = fb->frame.stream;
+    // 밀린 frame 은 그리지 않고 건너뛴다
+    release_block(ctx, latest[s]);
+    latest[s] = fb;
+    if (mosaic_set_frame(mosaic, s, fb->frame.data, (int)fb->frame.width,
+                         (int)fb->frame.height) < 0)
+      perror("mosaic_set_frame");
+  }
+  return n;
+}
+
 /**
  * @brief Thread function for consuming and rendering frames.
  *
- * Dequeues FrameBlocks, draws grayscale image and UI overlay,
- * then releases block back to pool.
+ * Dequeues FrameBlocks, draws grayscale image (or, with several streams,
+ * a mosaic of all of them) and UI overlay, then releases blocks back to
+ * their pools.
  * @param[in] arg Pointer to SharedCtx with display_q and ui_arg.
  * @return NULL on exit.
  */
@@ -18,9 +113,20 @@ static void *display_thread(void *arg)
   // Initialize the record arguments
   dev_fb frame_dev;
   SharedCtx *disp_arg = (SharedCtx *)arg;
-  FramePool *frame_pool = disp_arg->frame_pool;
   FrameBlock *fb = NULL;
+  FrameBlock *latest[STREAM_MAX] = {0};
+  BandRenderer *renderer = NULL;
+  ThreadPool *mosaic_pool = NULL;
+  Mosaic *mosaic = NULL;
   const char *labels[MENU_COUNT] = {"Stop", "Running", "Exit"};
+  TextRun label_runs[MENU_COUNT] = {0};
+  OverlayLayer *menu = NULL;
+  int menu_state = -1;
+  PerfStage perf;
+
+  // renderer/mosaic worker 보다 먼저: worker 가 이 설정을 물려받는다
+  rt_thread_setup(&DISPLAY_SCHED, "display", SCHED_LATENCY_SAMPLES, SCHED_LATENCY_PERIOD_US);
+  perf_stage_init(&perf, "display");
 
   // Framebuffer initialization
   if (fb_init(&frame_dev) < 0)
@@ -30,45 +136,129 @@ static void *display_thread(void *arg)
     goto thread_exit;
   }
 
+  if (DISPLAY_MOSAIC && disp_arg->nstreams > 1)
+  {
+    // stream 마다 tile 하나: 새 frame 이 온 tile 만 worker 들이 나눠 scale 한다
+    mosaic_pool = tp_create(DISPLAY_RENDER_THREADS);
+    mosaic = mosaic_create(&frame_dev, disp_arg->nstreams, DISPLAY_SCALE_MODE, mosaic_pool);
+    if (mosaic == NULL)
+    {
+      fprintf(stderr, "%s:%d in %s() → failed to create mosaic: %s\n", __FILE__, __LINE__,
+              __func__, strerror(errno));
+      goto thread_exit;
+    }
+  }
+  else
+  {
+    // 고해상도 패널에서는 band 단위로 나눠 여러 코어에서 그린다
+    renderer = br_create(DISPLAY_RENDER_THREADS, RENDER_MT_MIN_PIXELS);
+    if (renderer == NULL)
+    {
+      fprintf(stderr, "%s:%d in %s() → band renderer unavailable, drawing single-threaded\n",
+              __FILE__, __LINE__, __func__);
+    }
+    br_set_scale_mode(renderer, DISPLAY_SCALE_MODE);
+  }
+
+  // 라벨은 바뀌지 않으므로 한 번만 layout 해 둔다
+  for (int i = 0; i < MENU_COUNT; ++i)
+  {
+    if (text_run_init(&label_runs[i], glyph_default_atlas(), labels[i], 15) < 0)
+    {
+      fprintf(stderr, "%s:%d in %s() → failed to lay out label\n", __FILE__, __LINE__, __func__);
+      goto thread_exit;
+    }
+  }
+
+  // 메뉴는 retained layer 에 그려 두고 상태가 바뀔 때만 다시 그린다
+  menu = ovl_create(MENU_OVERLAY_W, MENU_OVERLAY_H);
+  if (menu == NULL)
+  {
+    fprintf(stderr, "%s:%d in %s() → failed to create menu overlay\n", __FILE__, __LINE__,
+            __func__);
+    goto thread_exit;
+  }
+
   fprintf(stderr, "%s:%d in %s() → display thread start \n", __FILE__, __LINE__, __func__);
 
+  // band worker 몫은 세지 않는다: fb_drawGray 전체를 보려면 DISPLAY_RENDER_THREADS 1
+  if (PERF_STAGE_COUNTERS && perf_stage_open(&perf, "display") < 0)
+    fprintf(stderr, "%s:%d in %s() → no perf counters: %s\n", __FILE__, __LINE__, __func__,
+            strerror(errno));
+
   while (1)
   {
 
-    /* Dequeue next block */
-    pthread_mutex_lock(&disp_arg->display_q->mutex);
-    while (is_empty(disp_arg->display_q))
+    if (mosaic)
     {
-      pthread_cond_wait(&disp_arg->display_q->cond_not_empty, &disp_arg->display_q->mutex);
-    }
-    fb = dequeue(disp_arg->display_q);
-    pthread_cond_signal(&disp_arg->display_q->cond_not_full);
-    pthread_mutex_unlock(&disp_arg->display_q->mutex);
+      /* Take every queued frame, newest per stream (none once capture has stopped) */
+      if (mosaic_take_latest(disp_arg, mosaic, latest) == 0)
+      {
+        fprintf(stderr, "%s:%d in %s() → display thread exit\n", __FILE__, __LINE__, __func__);
+        goto thread_exit;
+      }
+      perf_stage_begin(&perf);
+
+      /* Scale the tiles that got a frame into the page shown next */
+      if (mosaic_compose(mosaic, &frame_dev) < 0)
+      {
+        fprintf(stderr, "%s:%d in %s() → failed to compose mosaic\n", __FILE__, __LINE__,
+                __func__);
+        goto thread_exit;
+      }
 
-    /* Draw frame */
-    if (fb_drawGray(&frame_dev, fb->frame.data, fb->frame.width, fb->frame.height) < 0)
+      /* Motion regions on the analysed stream's tile */
+      fb = latest[DISPLAY_STREAM];
+      OvlRect view = mosaic_tile_rect(mosaic, DISPLAY_STREAM);
+      if (DISPLAY_MOTION_BOXES && fb &&
+          motion_draw_regions(&frame_dev, &disp_arg->motion, &fb->frame, view) > 0)
+        mosaic_damage(mosaic, view);
+    }
+    else
     {
-      fprintf(stderr, "%s:%d in %s() → failed to draw frame\n", __FILE__, __LINE__, __func__);
-      goto thread_exit;
+      /* Newest block (NULL once capture has stopped) */
+      fb = disp_arg->display_mailbox ? mailbox_take(&disp_arg->display_mb, MAILBOX_WAIT_FOREVER)
+                                     : dequeue_wait(disp_arg->display_q, QUEUE_WAIT_FOREVER);
+      if (!fb)
+      {
+        fprintf(stderr, "%s:%d in %s() → display thread exit\n", __FILE__, __LINE__, __func__);
+        goto thread_exit;
+      }
+      latest[fb->frame.stream] = fb;
+      perf_stage_begin(&perf);
+
+      /* Draw frame */
+      if (br_draw_gray(renderer, &frame_dev, fb->frame.data, fb->frame.width, fb->frame.height) < 0)
+      {
+        fprintf(stderr, "%s:%d in %s() → failed to draw frame\n", __FILE__, __LINE__, __func__);
+        goto thread_exit;
+      }
+
+      /* Motion regions */
+      OvlRect view = {.w = frame_dev.vinfo.xres, .h = frame_dev.vinfo.yres};
+      if (DISPLAY_MOTION_BOXES)
+        motion_draw_regions(&frame_dev, &disp_arg->motion, &fb->frame, view);
     }
 
     /* Overlay UI menu */
-    for (int i = 0; i < MENU_COUNT; ++i)
+    int state = (int)disp_arg->ui_arg->state;
+    if (state != menu_state)
     {
-      pixel pos = {.x = 10 + i * 110, .y = 10};
-      if (i == (int)disp_arg->ui_arg->state)
+      // 선택이 바뀐 버튼만 다시 그린다 (처음에는 전부)
+      for (int i = 0; i < MENU_COUNT; ++i)
       {
-        // 선택된 버튼: 흰 배경 + 검은 텍스트
-        fb_fillBox(&frame_dev, (pixel){pos.x - 2, pos.y - 2}, 100, 24, 255, 255, 255);
-        fb_printStr(&frame_dev, labels[i], &pos, 15, 0, 0, 0);
-      }
-      else
-      {
-        // 비선택 버튼: 테두리 + 흰 텍스트
-        fb_drawBox(&frame_dev, (pixel){pos.x - 2, pos.y - 2}, 100, 24, 255, 255, 255);
-        fb_printStr(&frame_dev, labels[i], &pos, 15, 255, 255, 255);
+        if (menu_state < 0 || i == state || i == menu_state)
+          menu_render_button(menu, &label_runs[i], i, i == state);
       }
+      menu_state = state;
     }
+    ovl_composite(menu, &frame_dev, 0, 0);
+    mosaic_damage(mosaic, (OvlRect){.w = MENU_OVERLAY_W, .h = MENU_OVERLAY_H});
+
+    /* Show all tiles of this refresh at once */
+    if (mosaic && mosaic_present(mosaic, &frame_dev) < 0)
+      perror("mosaic_present");
+    perf_stage_end(&perf, 1);
 
     /* Exit check */
     if (disp_arg->ui_arg->state == STATE_EXIT)
@@ -85,13 +275,28 @@ static void *display_thread(void *arg)
     }
     pthread_mutex_unlock(&disp_arg->ui_arg->mutex);
 
-    // release the frame block
-    fp_release(frame_pool, fb);
+    // release the frame blocks
+    for (int i = 0; i < disp_arg->nstreams; ++i)
+    {
+      release_block(disp_arg, latest[i]);
+      latest[i] = NULL;
+    }
 
     usleep(FRAME_INTERVAL_US);
   }
 
 thread_exit:
+  if (PERF_STAGE_COUNTERS)
+    perf_stage_report(&perf, stderr);
+  perf_stage_close(&perf);
+  for (int i = 0; i < STREAM_MAX; ++i)
+    release_block(disp_arg, latest[i]);
+  ovl_destroy(menu);
+  for (int i = 0; i < MENU_COUNT; ++i)
+    text_run_free(&label_runs[i]);
+  br_destroy(renderer);
+  mosaic_destroy(mosaic);
+  tp_destroy(mosaic_pool);
   fb_close(&frame_dev);
   return NULL;
 }
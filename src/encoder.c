@@ -0,0 +1,267 @@
+/*
+ * @file encoder.c
+ * @brief Slice-parallel frame encoder with in-order write-back.
+ */
+#include "encoder.h"
+
+typedef struct SliceTask
+{
+  FrameEncoder *fe;
+  EncodeSlot *slot;
+  int index;
+} SliceTask;
+
+static void encode_slice(FrameEncoder *fe, EncodeSlot *slot, int i)
+{
+  size_t off, len;
+  codec_slice_range(fe->width, fe->height, fe->nslices, i, &off, &len);
+  slot->sizes[i] = (uint32_t)codec_encode_slice(slot->out + (size_t)i * fe->slice_cap,
+                                                slot->frame + off,
+                                                slot->ref ? slot->ref + off : NULL,
+                                                slot->residual + off, len);
+}
+
+static void slice_task(void *arg)
+{
+  SliceTask *t = arg;
+  encode_slice(t->fe, t->slot, t->index);
+}
+
+static EncodeSlot *slot_at(FrameEncoder *fe, uint64_t n)
+{
+  return &fe->slots[n % (uint64_t)fe->nslots];
+}
+
+static bool slot_done(const EncodeSlot *slot)
+{
+  return atomic_load_explicit(&slot->group.outstanding, memory_order_acquire) == 0;
+}
+
+// slot 하나를 container 에 기록
+static int write_slot(FrameEncoder *fe, EncodeSlot *slot, TbbWriter *wr)
+{
+  bool key = slot->ref == NULL;
+
+  if (fe->nslices > 0)
+  {
+    size_t total = sizeof(CodecHeader) + (size_t)fe->nslices * sizeof(uint32_t);
+    for (int i = 0; i < fe->nslices; i++)
+      total += slot->sizes[i];
+
+    if (total < fe->bytes)
+    {
+      struct iovec iov[TBB_MAX_IOV];
+      iov[0].iov_base = slot->head;
+      iov[0].iov_len = codec_write_header(slot->head, fe->bytes, fe->nslices, slot->sizes);
+      for (int i = 0; i < fe->nslices; i++)
+      {
+        iov[i + 1].iov_base = slot->out + (size_t)i * fe->slice_cap;
+        iov[i + 1].iov_len = slot->sizes[i];
+      }
+      return tbb_writer_appendv(wr, slot->seq, key ? TBB_CODEC_RLE : TBB_CODEC_XOR_RLE,
+                                slot->flags | (key ? TBB_FLAG_KEY : 0), slot->skipped, iov,
+                                fe->nslices + 1);
+    }
+    // 잡음이 많은 frame 처럼 줄지 않으면 raw (역시 key) 로 저장
+    fe->raw_fallbacks++;
+  }
+  return tbb_writer_append(wr, slot->seq, TBB_CODEC_RAW, slot->flags | TBB_FLAG_KEY,
+                           slot->skipped, slot->frame, (uint32_t)fe->bytes);
+}
+
+// pool 없이 slot ring 만 만든다
+static FrameEncoder *fe_alloc(size_t width, size_t height, int nslices, int inflight)
+{
+  if (width == 0 || height == 0 || nslices < 0 || nslices > CODEC_MAX_SLICES ||
+      (size_t)nslices > height || inflight < 2 || inflight > FE_MAX_INFLIGHT)
+  {
+    errno = EINVAL;
+    return NULL;
+  }
+
+  FrameEncoder *fe = calloc(1, sizeof(*fe));
+  if (!fe)
+  {
+    errno = ENOMEM;
+    return NULL;
+  }
+  fe->width = width;
+  fe->height = height;
+  fe->bytes = width * height;
+  fe->nslices = nslices;
+  fe->nslots = inflight;
+
+  if (nslices > 0)
+  {
+    // 가장 긴 slice 기준 (행 수가 나누어떨어지지 않으면 한 행 더)
+    size_t rows = (height + (size_t)nslices - 1) / (size_t)nslices;
+    fe->slice_cap = codec_bound(rows * width, 1);
+  }
+
+  fe->slots = calloc((size_t)inflight, sizeof(EncodeSlot));
+  if (!fe->slots)
+  {
+    free(fe);
+    errno = ENOMEM;
+    return NULL;
+  }
+  for (int i = 0; i < inflight; i++)
+    tg_init(&fe->slots[i].group);
+
+  for (int i = 0; i < inflight; i++)
+  {
+    EncodeSlot *slot = &fe->slots[i];
+    slot->frame = malloc(fe->bytes);
+    if (nslices > 0)
+    {
+      slot->residual = malloc(fe->bytes);
+      slot->out = malloc(fe->slice_cap * (size_t)nslices);
+    }
+    if (!slot->frame || (nslices > 0 && (!slot->residual || !slot->out)))
+      goto nomem;
+  }
+  return fe;
+
+nomem:
+  fe_destroy(fe);
+  errno = ENOMEM;
+  return NULL;
+}
+
+FrameEncoder *fe_create(size_t width, size_t height, int nslices, int nthreads, int inflight)
+{
+  FrameEncoder *fe = fe_alloc(width, height, nslices, inflight);
+  if (!fe)
+    return NULL;
+
+  if (nslices > 1 && nthreads != 1)
+  {
+    fe->pool = tp_create(nthreads > 0 ? (size_t)nthreads : 0);
+    if (!fe->pool)
+    {
+      int saved = errno;
+      fe_destroy(fe);
+      errno = saved;
+      return NULL;
+    }
+    fe->owns_pool = true;
+  }
+  return fe;
+}
+
+FrameEncoder *fe_create_shared(ThreadPool *pool, size_t width, size_t height, int nslices,
+                               int inflight)
+{
+  FrameEncoder *fe = fe_alloc(width, height, nslices, inflight);
+  if (fe && nslices > 1)
+    fe->pool = pool;
+  return fe;
+}
+
+void fe_destroy(FrameEncoder *fe)
+{
+  if (!fe)
+    return;
+  for (uint64_t n = fe->head; n < fe->tail; n++)
+    tg_wait(fe->pool, &slot_at(fe, n)->group);
+  if (fe->owns_pool)
+    tp_destroy(fe->pool);
+
+  for (int i = 0; i < fe->nslots; i++)
+  {
+    EncodeSlot *slot = &fe->slots[i];
+    free(slot->frame);
+    free(slot->residual);
+    free(slot->out);
+    tg_destroy(&slot->group);
+  }
+  free(fe->slots);
+  free(fe);
+}
+
+int fe_flush(FrameEncoder *fe, TbbWriter *wr, bool wait)
+{
+  int written = 0;
+
+  // 끝난 frame 들을 writev 한 번으로 모아 쓴다 (slot 은 이 함수 안에서 재사용되지 않는다)
+  tbb_writer_begin_batch(wr);
+  while (fe->head < fe->tail)
+  {
+    EncodeSlot *slot = slot_at(fe, fe->head);
+    if (!wait && !slot_done(slot))
+      break;
+    tg_wait(fe->pool, &slot->group);
+    if (write_slot(fe, slot, wr) < 0)
+    {
+      tbb_writer_end_batch(wr);
+      return -1;
+    }
+    fe->head++;
+    written++;
+  }
+  if (tbb_writer_end_batch(wr) < 0)
+    return -1;
+  return written;
+}
+
+int fe_submit(FrameEncoder *fe, TbbWriter *wr, const uint8_t *frame, uint64_t seq,
+              uint32_t skipped, uint8_t flags, bool key)
+{
+  if (!fe || !wr || !frame)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  /*
+   * 끝난 frame 은 ring 이 찰 때 (또는 호출자의 fe_flush 에서) 한꺼번에 내보낸다.
+   * 가득 차면 가장 오래된 것을 기다린 뒤 그때까지 끝난 것을 모두 기록.
+   */
+  while (fe->tail - fe->head >= (uint64_t)fe->nslots)
+  {
+    tg_wait(fe->pool, &slot_at(fe, fe->head)->group);
+    if (fe_flush(fe, wr, false) < 0)
+      return -1;
+  }
+
+  // 재사용할 slot 을 다음 slot 이 아직 reference 로 읽고 있을 수 있다
+  if (fe->tail >= (uint64_t)fe->nslots)
+    tg_wait(fe->pool, &slot_at(fe, fe->tail + 1)->group);
+
+  EncodeSlot *slot = slot_at(fe, fe->tail);
+  const uint8_t *ref = (!key && fe->have_ref && fe->tail > 0) ? slot_at(fe, fe->tail - 1)->frame
+                                                              : NULL;
+  memcpy(slot->frame, frame, fe->bytes);
+  slot->ref = ref;
+  slot->seq = seq;
+  slot->skipped = skipped;
+  slot->flags = flags & ~TBB_FLAG_KEY;
+
+  for (int i = 0; i < fe->nslices; i++)
+  {
+    if (fe->pool)
+    {
+      SliceTask t = {.fe = fe, .slot = slot, .index = i};
+      tp_submit(fe->pool, &slot->group, slice_task, &t, sizeof(t));
+    }
+    else
+    {
+      encode_slice(fe, slot, i);
+    }
+  }
+  fe->tail++;
+  fe->have_ref = true;
+  return 0;
+}
+
+void fe_reset(FrameEncoder *fe)
+{
+  fe->have_ref = false;
+}
+
+const uint8_t *fe_last_frame(const FrameEncoder *fe)
+{
+  if (!fe || !fe->have_ref || fe->tail == 0)
+    return NULL;
+  return fe->slots[(fe->tail - 1) % (uint64_t)fe->nslots].frame;
+}
@@ -1,4 +1,5 @@
 #include "fbDraw.h"
+#include "glyph.h"
 
 int fb_init(dev_fb *fb)
 {
@@ -51,7 +52,86 @@ int fb_init(dev_fb *fb)
   return 0;
 }
 
+int fb_initMemory(dev_fb *fb, int width, int height, int bpp)
+{
+  if (!fb || width <= 0 || height <= 0 || (bpp != 16 && bpp != 32))
+    return -1;
+
+  memset(fb, 0, sizeof(*fb));
+  fb->fbfd = -1;
+  fb->vinfo.xres = fb->vinfo.xres_virtual = width;
+  fb->vinfo.yres = fb->vinfo.yres_virtual = height;
+  fb->vinfo.bits_per_pixel = bpp;
+  if (bpp == 32)
+  {
+    // XRGB8888 (리틀엔디언 메모리 순서 B,G,R,X)
+    fb->vinfo.red = (struct fb_bitfield){.offset = 16, .length = 8};
+    fb->vinfo.green = (struct fb_bitfield){.offset = 8, .length = 8};
+    fb->vinfo.blue = (struct fb_bitfield){.offset = 0, .length = 8};
+    fb->vinfo.transp = (struct fb_bitfield){.offset = 24, .length = 8};
+  }
+  else
+  {
+    // RGB565
+    fb->vinfo.red = (struct fb_bitfield){.offset = 11, .length = 5};
+    fb->vinfo.green = (struct fb_bitfield){.offset = 5, .length = 6};
+    fb->vinfo.blue = (struct fb_bitfield){.offset = 0, .length = 5};
+  }
+  fb->finfo.line_length = width * (bpp / 8);
+  fb->screensize = (long)fb->finfo.line_length * height;
+
+  fb->fbp = (ubyte *)calloc(1, fb->screensize);
+  if (!fb->fbp)
+    return FB_MMAP_FAIL;
+  return 0;
+}
+
+uint32_t fb_grayToPixel(const dev_fb *fb, ubyte g)
+{
+  const struct fb_var_screeninfo *v = &fb->vinfo;
+  uint32_t r = (g >> (8 - v->red.length)) & ((1u << v->red.length) - 1);
+  uint32_t gg = (g >> (8 - v->green.length)) & ((1u << v->green.length) - 1);
+  uint32_t b = (g >> (8 - v->blue.length)) & ((1u << v->blue.length) - 1);
+  return (r << v->red.offset) | (gg << v->green.offset) | (b << v->blue.offset);
+}
+
+void fb_buildGrayLut(const dev_fb *fb, uint32_t lut[256])
+{
+  for (int i = 0; i < 256; i++)
+    lut[i] = fb_grayToPixel(fb, (ubyte)i);
+}
+
+void fb_putGraySpan(dev_fb *fb, int x, int y, const ubyte *line, int len, const uint32_t lut[256])
+{
+  ubyte *row = fb->fbp + locate(fb, x, y);
+
+  if (fb->vinfo.bits_per_pixel == 32)
+  {
+    uint32_t *dst = (uint32_t *)row;
+    for (int i = 0; i < len; i++)
+      dst[i] = lut[line[i]];
+  }
+  else if (fb->vinfo.bits_per_pixel == 16)
+  {
+    uint16_t *dst = (uint16_t *)row;
+    for (int i = 0; i < len; i++)
+      dst[i] = (uint16_t)lut[line[i]];
+  }
+}
+
+void fb_putGrayRow(dev_fb *fb, int y, const ubyte *line, const uint32_t lut[256])
+{
+  fb_putGraySpan(fb, 0, y, line, fb->vinfo.xres, lut);
+}
+
 int fb_drawGray(dev_fb *fb, const ubyte *gray, int raw_w, int raw_h)
+{
+  if (!fb || !fb->fbp)
+    return -1;
+  return fb_drawGrayRows(fb, gray, raw_w, raw_h, 0, fb->vinfo.yres);
+}
+
+int fb_drawGrayRows(dev_fb *fb, const ubyte *gray, int raw_w, int raw_h, int y_begin, int y_end)
 {
   if (!fb || !fb->fbp || !gray || raw_w <= 0 || raw_h <= 0)
     return -1;
@@ -60,58 +140,65 @@ int fb_drawGray(dev_fb *fb, const ubyte *gray, int raw_w, int raw_h)
   const int fb_h = fb->vinfo.yres;
   const int bpp = fb->vinfo.bits_per_pixel;
 
-  for (int y = 0; y < fb_h; y++)
-  {
-    int src_y = y * raw_h / fb_h;
-    for (int x = 0; x < fb_w; x++)
-    {
-      int src_x = x * raw_w / fb_w;
-      ubyte g = gray[src_y * raw_w + src_x];
-      /*
-        x = 0 → src_x = 0×1920/800 = ０
-        x = 1 → src_x = 1×1920/800 = 2.4 → 정수로 2
-        x = 2 → src_x = 2×1920/800 = 4.8 → 정수로 4
-        x = 100 → src_x = 100×1920/800 = 240
-        …
-        x = 799 → src_x = 799×1920/800 ≈ 1917.6 → 1917
-        800픽셀짜리 출력 영역을 1920픽셀짜리 원본 영상에 “nearest‐neighbor” 방식으로 맵핑 ->
-        출력 한칸에 원본 2~3픽셀을 대응시켜 전체 영상을 화면 크기에 맞춰 축소
-
-        x = 0 → 0.0 → src_x = 0
-        x = 1 → 0.416 → src_x = 0
-        x = 2 → 0.833 → src_x = 0
-        x = 3 → 1.25 → src_x = 1
-        x = 4 → 1.666 → src_x = 1
-        x = 5 → 2.083 → src_x = 2
-        …
-        x = 1919 → ≈799.166 → src_x = 799
-        즉 한 개의 원본 픽셀(예: raw[0], raw[1], raw[2]…)이 약 2~3번 출력 픽셀로 반복 매핑되면서
-        업샘플링
-      */
+  if (bpp != 32 && bpp != 16)
+    return -2; // 지원하지 않는 bpp
+  if (y_begin < 0)
+    y_begin = 0;
+  if (y_end > fb_h)
+    y_end = fb_h;
 
-      size_t loc = locate(
-          fb, x, y); // 픽셀 오프셋 계산
-                     // :contentReference[oaicite:0]{index=0}:contentReference[oaicite:1]{index=1}
+  /*
+    회색값 → framebuffer 픽셀 변환은 256가지뿐이므로 미리 packing 해 둔다.
+    src_x = x * raw_w / fb_w 도 나눗셈 없이 몫/나머지 누적으로 계산한다.
+    x = 0 → src_x = 0×1920/800 = ０
+    x = 1 → src_x = 1×1920/800 = 2.4 → 정수로 2
+    x = 2 → src_x = 2×1920/800 = 4.8 → 정수로 4
+    …
+    x = 799 → src_x = 799×1920/800 ≈ 1917.6 → 1917
+    800픽셀짜리 출력 영역을 1920픽셀짜리 원본 영상에 “nearest‐neighbor” 방식으로 맵핑 ->
+    출력 한칸에 원본 2~3픽셀을 대응시켜 전체 영상을 화면 크기에 맞춰 축소
+  */
+  uint32_t lut[256];
+  fb_buildGrayLut(fb, lut);
 
-      if (bpp == 32)
-      {
-        uint32_t pixel = ((g >> (8 - fb->vinfo.red.length)) << fb->vinfo.red.offset) |
-                         ((g >> (8 - fb->vinfo.green.length)) << fb->vinfo.green.offset) |
-                         ((g >> (8 - fb->vinfo.blue.length)) << fb->vinfo.blue.offset);
-        *(uint32_t *)(fb->fbp + loc) = pixel;
-      }
-      else if (bpp == 16)
+  const int step_q = raw_w / fb_w;
+  const int step_r = raw_w % fb_w;
+
+  for (int y = y_begin; y < y_end; y++)
+  {
+    const ubyte *src = gray + (size_t)(y * (long)raw_h / fb_h) * raw_w;
+    ubyte *row = fb->fbp + locate(fb, 0, y);
+    int src_x = 0;
+    int rem = 0;
+
+    if (bpp == 32)
+    {
+      uint32_t *dst = (uint32_t *)row;
+      for (int x = 0; x < fb_w; x++)
       {
-        uint16_t r5 = (g >> (8 - fb->vinfo.red.length)) & ((1 << fb->vinfo.red.length) - 1);
-        uint16_t g6 = (g >> (8 - fb->vinfo.green.length)) & ((1 << fb->vinfo.green.length) - 1);
-        uint16_t b5 = (g >> (8 - fb->vinfo.blue.length)) & ((1 << fb->vinfo.blue.length) - 1);
-        uint16_t pixel = (r5 << fb->vinfo.red.offset) | (g6 << fb->vinfo.green.offset) |
-                         (b5 << fb->vinfo.blue.offset);
-        *(uint16_t *)(fb->fbp + loc) = pixel;
+        dst[x] = lut[src[src_x]];
+        src_x += step_q;
+        rem += step_r;
+        if (rem >= fb_w)
+        {
+          rem -= fb_w;
+          src_x++;
+        }
       }
-      else
+    }
+    else
+    {
+      uint16_t *dst = (uint16_t *)row;
+      for (int x = 0; x < fb_w; x++)
       {
-        return -2; // 지원하지 않는 bpp
+        dst[x] = (uint16_t)lut[src[src_x]];
+        src_x += step_q;
+        rem += step_r;
+        if (rem >= fb_w)
+        {
+          rem -= fb_w;
+          src_x++;
+        }
       }
     }
   }
@@ -119,6 +206,91 @@ int fb_drawGray(dev_fb *fb, const ubyte *gray, int raw_w, int raw_h)
   return 0;
 }
 
+uint32_t fb_packColor(const dev_fb *fb, ubyte r, ubyte g, ubyte b)
+{
+  const struct fb_var_screeninfo *v = &fb->vinfo;
+  return ((uint32_t)(r >> (8 - v->red.length)) << v->red.offset) |
+         ((uint32_t)(g >> (8 - v->green.length)) << v->green.offset) |
+         ((uint32_t)(b >> (8 - v->blue.length)) << v->blue.offset);
+}
+
+/*
+ * 한 행을 packed pixel 로 채운다 (clip 은 호출자가 끝낸 상태).
+ * 모든 byte 가 같으면 memset, 아니면 8byte 단위 store.
+ * mmap 된 framebuffer 는 읽기가 느리므로 이전 행을 memcpy 하지 않는다.
+ */
+static void fill_row(ubyte *p, int len, uint32_t pixel, int bpp)
+{
+  size_t bytes = (size_t)len * (bpp / 8);
+  uint64_t wide;
+
+  if (bpp == 32)
+  {
+    if ((pixel & 0xFFu) * 0x01010101u == pixel)
+    {
+      memset(p, pixel & 0xFF, bytes);
+      return;
+    }
+    wide = ((uint64_t)pixel << 32) | pixel;
+  }
+  else
+  {
+    pixel &= 0xFFFFu;
+    if ((pixel & 0xFFu) * 0x0101u == pixel)
+    {
+      memset(p, pixel & 0xFF, bytes);
+      return;
+    }
+    wide = (uint64_t)pixel * 0x0001000100010001ull;
+  }
+
+  // 8byte 경계까지 pixel 단위로 맞춘다
+  while (bytes && ((uintptr_t)p & 7))
+  {
+    if (bpp == 32)
+      *(uint32_t *)p = pixel;
+    else
+      *(uint16_t *)p = (uint16_t)pixel;
+    p += bpp / 8;
+    bytes -= bpp / 8;
+  }
+  uint64_t *w = (uint64_t *)p;
+  for (size_t i = 0; i < bytes / 8; i++)
+    w[i] = wide;
+  p += bytes & ~(size_t)7;
+  bytes &= 7;
+  while (bytes)
+  {
+    if (bpp == 32)
+      *(uint32_t *)p = pixel;
+    else
+      *(uint16_t *)p = (uint16_t)pixel;
+    p += bpp / 8;
+    bytes -= bpp / 8;
+  }
+}
+
+void fb_fillSpan(dev_fb *fb, int x, int y, int len, uint32_t pixel)
+{
+  fb_fillRect(fb, x, y, len, 1, pixel);
+}
+
+void fb_fillRect(dev_fb *fb, int x, int y, int w, int h, uint32_t pixel)
+{
+  // 도형 당 한 번만 clip
+  int x0 = x < 0 ? 0 : x;
+  int y0 = y < 0 ? 0 : y;
+  int x1 = (w > (int)fb->vinfo.xres - x) ? (int)fb->vinfo.xres : x + w;
+  int y1 = (h > (int)fb->vinfo.yres - y) ? (int)fb->vinfo.yres : y + h;
+  if (w <= 0 || h <= 0 || x1 <= x0 || y1 <= y0)
+    return;
+
+  int bpp = fb->vinfo.bits_per_pixel;
+  ubyte *row = fb->fbp + locate(fb, x0, y0);
+  for (int yy = y0; yy < y1; yy++, row += fb->finfo.line_length)
+    fill_row(row, x1 - x0, pixel, bpp);
+}
+
 pixel fb_toPixel(int x, int y)
 {
   pixel px;
@@ -191,34 +363,24 @@ void fb_drawPixelwithAlpha(dev_fb *fb, int x, int y, char r, char g, char b, cha
 
 void fb_fillScr(dev_fb *fb, char r, char g, char b)
 {
-  int x, y;
-  size_t location;
-  for (y = 0; y < (int)fb->vinfo.yres; y++)
-  {
-    for (x = 0; x < (int)fb->vinfo.xres; x++)
-    {
-      location = locate(fb, x, y);
-      *(fb->fbp + location) = b;
-      *(fb->fbp + location + 1) = g;
-      *(fb->fbp + location + 2) = r;
-      *(fb->fbp + location + 3) = 0;
-    }
-  }
+  fb_fillRect(fb, 0, 0, fb->vinfo.xres, fb->vinfo.yres, fb_packColor(fb, r, g, b));
 }
 
 void fb_drawBox(dev_fb *fb, pixel px, int w, int h, char r, char g, char b)
 {
-  int x, y;
-
-  for (x = 0; x < w; x++)
-    fb_drawPixel(fb, px.x + x, px.y, r, g, b);
-  for (y = 1; y < (h - 1); y++)
+  uint32_t pixel = fb_packColor(fb, r, g, b);
+
+  if (w <= 0 || h <= 0)
+    return;
+  fb_fillRect(fb, px.x, px.y, w, 1, pixel);
+  if (h > 1)
+    fb_fillRect(fb, px.x, px.y + h - 1, w, 1, pixel);
+  if (h > 2)
   {
-    fb_drawPixel(fb, px.x, px.y + y, r, g, b);
-    fb_drawPixel(fb, px.x + (w - 1), px.y + y, r, g, b);
+    fb_fillRect(fb, px.x, px.y + 1, 1, h - 2, pixel);
+    if (w > 1)
+      fb_fillRect(fb, px.x + w - 1, px.y + 1, 1, h - 2, pixel);
   }
-  for (x = 0; x < w; x++)
-    fb_drawPixel(fb, px.x + x, px.y + (h - 1), r, g, b);
 }
 
 void fb_drawBoxWidthAlpa(dev_fb *fb, pixel px, int w, int h, char r, char g, char b, char a)
@@ -238,14 +400,7 @@ void fb_drawBoxWidthAlpa(dev_fb *fb, pixel px, int w, int h, char r, char g, cha
 
 void fb_fillBox(dev_fb *fb, pixel px, int w, int h, char r, char g, char b)
 {
-  int x, y;
-  for (y = 0; y < h; y++)
-  {
-    for (x = 0; x < w; x++)
-    {
-      fb_drawPixel(fb, px.x + x, px.y + y, r, g, b);
-    }
-  }
+  fb_fillRect(fb, px.x, px.y, w, h, fb_packColor(fb, r, g, b));
 }
 
 /*
@@ -325,6 +480,12 @@ void fb_drawLine(dev_fb *fb, pixel start, pixel end, char r, char g, char b)
 }
 
 void fb_drawChar(dev_fb *fb, char c, pixel start, short h, char r, char g, char b)
+{
+  // 글리프 아틀라스에서 (처음 한 번만 래스터화된) span 을 복사
+  glyph_draw(glyph_default_atlas(), fb, c, start, h, fb_packColor(fb, r, g, b));
+}
+
+void fb_strokeChar(dev_fb *fb, char c, pixel start, short h, char r, char g, char b)
 {
   short w = h / 3;
   if (w % 2)
@@ -769,6 +930,14 @@ int fb_displayGrayFrame(dev_fb *fb, const ubyte *gray, int raw_w, int raw_h)
 
 void fb_close(dev_fb *fb)
 {
-  munmap(fb->fbp, fb->screensize);
+  if (fb->fbfd < 0)
+  {
+    // fb_initMemory() 로 만든 off-screen 버퍼
+    free(fb->fbp);
+    fb->fbp = NULL;
+    return;
+  }
+  if (fb->fbp)
+    munmap(fb->fbp, fb->screensize);
   close(fb->fbfd);
 }
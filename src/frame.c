@@ -51,6 +51,7 @@ int frame_init(Frame *frame, size_t width, size_t height, DEPTH depth)
   frame->height = height;
   frame->depth = depth;
   frame->seq = 0;
+  frame->stream = 0;
   frame->data = buf;
 
   return 0;
@@ -1,5 +1,9 @@
 #include "frame_pool.h"
 
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 FramePool *frame_pool_create(size_t pool_size, size_t width, size_t height, DEPTH depth)
 {
   if (pool_size == 0 || depth == 0 || width == 0 || height == 0)
@@ -46,6 +50,10 @@ int frame_pool_init(FramePool *fp, size_t pool_size, size_t width, size_t height
   fp->blocks = NULL;
   fp->pool_data = NULL;
   fp->free_list = NULL;
+  fp->stalls = 0;
+  fp->limit = pool_size;
+  fp->in_use = 0;
+  fp->peak = 0;
 
   fp->blocks = calloc(pool_size, sizeof(FrameBlock));
   if (!fp->blocks)
@@ -73,8 +81,10 @@ int frame_pool_init(FramePool *fp, size_t pool_size, size_t width, size_t height
     f->frame.width = width;
     f->frame.height = height;
     f->frame.seq = 0;
+    f->frame.stream = 0;
     f->frame.depth = depth;
     f->frame.data = (void *)((char *)fp->pool_data + i * total_bytes_per_frame);
+    f->trimmed = false;
     f->next = fp->free_list;
     fp->free_list = f;
   }
@@ -112,8 +122,10 @@ FrameBlock *fp_alloc(FramePool *fp, int init_count)
     return NULL;
   }
   pthread_mutex_lock(&fp->mutex);
-  // free_list가 비어 있으면 cond로 대기
-  while (fp->free_list == NULL)
+  // free_list가 비었거나 limit 만큼 나가 있으면 cond로 대기
+  if (fp->free_list == NULL || fp->in_use >= fp->limit)
+    fp->stalls++;
+  while (fp->free_list == NULL || fp->in_use >= fp->limit)
   {
     pthread_cond_wait(&fp->cond, &fp->mutex);
   }
@@ -121,6 +133,9 @@ FrameBlock *fp_alloc(FramePool *fp, int init_count)
   if (f)
   {
     fp->free_list = f->next;
+    f->trimmed = false;
+    if (++fp->in_use > fp->peak)
+      fp->peak = fp->in_use;
   }
   pthread_mutex_unlock(&fp->mutex);
 
@@ -151,6 +166,7 @@ void fp_release(FramePool *fp, FrameBlock *blk)
     pthread_mutex_lock(&fp->mutex);
     blk->next = fp->free_list;
     fp->free_list = blk;
+    fp->in_use--;
     pthread_cond_signal(&fp->cond);
     pthread_mutex_unlock(&fp->mutex);
   }
@@ -196,11 +212,79 @@ size_t fp_total_bytes_per_frame_size(const FramePool *fp)
   return fp ? fp->total_bytes_per_frame : 0;
 }
 
+int fp_set_limit(FramePool *fp, size_t limit)
+{
+  if (!fp || limit == 0)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  pthread_mutex_lock(&fp->mutex);
+  bool raised = limit > fp->limit;
+  fp->limit = limit < fp->pool_size ? limit : fp->pool_size;
+  if (raised)
+    pthread_cond_broadcast(&fp->cond);
+  pthread_mutex_unlock(&fp->mutex);
+  return 0;
+}
+
+size_t fp_get_limit(const FramePool *fp)
+{
+  return fp ? fp->limit : 0;
+}
+
+size_t fp_stall_count(const FramePool *fp)
+{
+  if (!fp)
+    return 0;
+  pthread_mutex_lock((pthread_mutex_t *)&fp->mutex);
+  size_t stalls = fp->stalls;
+  pthread_mutex_unlock((pthread_mutex_t *)&fp->mutex);
+  return stalls;
+}
+
+size_t fp_take_peak(FramePool *fp)
+{
+  pthread_mutex_lock(&fp->mutex);
+  size_t peak = fp->peak;
+  fp->peak = fp->in_use;
+  pthread_mutex_unlock(&fp->mutex);
+  return peak;
+}
+
+size_t fp_trim(FramePool *fp)
+{
+  const uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+  size_t freed = 0;
+
+  pthread_mutex_lock(&fp->mutex);
+  // 앞쪽 (limit - in_use) 개는 곧 다시 쓰일 block: 그대로 둔다
+  size_t keep = fp->limit > fp->in_use ? fp->limit - fp->in_use : 0;
+  for (FrameBlock *f = fp->free_list; f; f = f->next)
+  {
+    if (keep > 0)
+    {
+      keep--;
+      continue;
+    }
+    if (f->trimmed)
+      continue;
+    // block 안에 온전히 들어 있는 page 만 (이웃 block 은 건드리지 않는다)
+    uintptr_t begin = ((uintptr_t)f->frame.data + page - 1) & ~(page - 1);
+    uintptr_t end = ((uintptr_t)f->frame.data + fp->total_bytes_per_frame) & ~(page - 1);
+    if (end > begin && madvise((void *)begin, end - begin, MADV_DONTNEED) == 0)
+      freed += end - begin;
+    f->trimmed = true;
+  }
+  pthread_mutex_unlock(&fp->mutex);
+  return freed;
+}
+
 void fp_debug_dump(const FramePool *fp, FILE *file_p)
 {
   if (!file_p)
     file_p = stdout;
-  if (!file_p)
+  if (!fp)
   {
     fprintf(file_p, "[FramePool] NULL\n");
     return;
@@ -210,4 +294,5 @@ void fp_debug_dump(const FramePool *fp, FILE *file_p)
   fprintf(file_p, "  Total Blocks : %zu\n", fp->pool_size);
   fprintf(file_p, "  total_bytes_per_frame_size   : %zu bytes\n", fp->total_bytes_per_frame);
   fprintf(file_p, "  Free Blocks  : %zu\n", fp_available_count(fp));
+  fprintf(file_p, "  Limit        : %zu\n", fp->limit);
 }
@@ -0,0 +1,264 @@
+/*
+ * @file glyph.c
+ * @brief Glyph atlas: stroke font rasterized once per height, drawn as spans.
+ */
+#include "glyph.h"
+
+static GlyphAtlas default_atlas;
+static pthread_once_t default_once = PTHREAD_ONCE_INIT;
+
+static void default_atlas_init(void)
+{
+  glyph_atlas_init(&default_atlas);
+}
+
+// fb_printStr 과 같은 규칙: 폭은 높이의 1/3 을 짝수로 올림
+static int glyph_width(short height)
+{
+  int w = height / 3;
+  if (w % 2)
+    w++;
+  return w;
+}
+
+static void glyph_free(Glyph *g)
+{
+  free(g->spans);
+  memset(g, 0, sizeof(*g));
+}
+
+static void set_free(GlyphSet *set)
+{
+  for (int i = 0; i < GLYPH_COUNT; i++)
+    glyph_free(&set->glyphs[i]);
+  set->height = 0;
+}
+
+/*
+ * 흰색으로 stroke 한 뒤 덮인 픽셀을 row span 목록으로 만든다.
+ * 선은 오른쪽/아래 끝점까지 찍히므로 셀은 (w+2) x (h+1).
+ */
+static int glyph_rasterize(Glyph *g, char c, short height)
+{
+  dev_fb canvas;
+  int cw = glyph_width(height) + 2;
+  int ch = height + 1;
+
+  if (fb_initMemory(&canvas, cw, ch, 32) != 0)
+  {
+    errno = ENOMEM;
+    return -1;
+  }
+  fb_strokeChar(&canvas, c, fb_toPixel(0, 0), height, (char)255, (char)255, (char)255);
+
+  // 최악의 경우 한 행에 cw/2+1 개의 span
+  g->spans = malloc(sizeof(GlyphSpan) * (size_t)ch * (cw / 2 + 1));
+  if (!g->spans)
+  {
+    fb_close(&canvas);
+    glyph_free(g);
+    errno = ENOMEM;
+    return -1;
+  }
+
+  const uint32_t *px = (const uint32_t *)canvas.fbp;
+  int n = 0;
+  for (int y = 0; y < ch; y++)
+  {
+    int run = -1;
+    for (int x = 0; x <= cw; x++)
+    {
+      bool on = (x < cw) && (px[y * cw + x] & 0x00FFFFFF);
+      if (on && run < 0)
+        run = x;
+      else if (!on && run >= 0)
+      {
+        g->spans[n++] = (GlyphSpan){.y = (int16_t)y, .x = (int16_t)run, .len = (int16_t)(x - run)};
+        run = -1;
+      }
+    }
+  }
+  fb_close(&canvas);
+
+  g->w = cw;
+  g->h = ch;
+  g->nspans = n;
+  g->ready = true;
+  return 0;
+}
+
+/*
+ * height 에 해당하는 set 을 찾거나 만들고 c 를 래스터화해서 돌려준다.
+ * atlas->mutex 를 잡은 상태에서 호출.
+ */
+static const Glyph *glyph_lookup(GlyphAtlas *atlas, char c, short height)
+{
+  unsigned char uc = (unsigned char)c;
+  if (height <= 0 || uc < GLYPH_FIRST || uc >= GLYPH_FIRST + GLYPH_COUNT)
+    return NULL;
+
+  GlyphSet *set = NULL;
+  for (int i = 0; i < GLYPH_MAX_SETS && !set; i++)
+  {
+    if (atlas->sets[i].height == height)
+      set = &atlas->sets[i];
+  }
+  if (!set)
+  {
+    for (int i = 0; i < GLYPH_MAX_SETS && !set; i++)
+    {
+      if (atlas->sets[i].height == 0)
+        set = &atlas->sets[i];
+    }
+  }
+  if (!set)
+  {
+    // 가득 찼으면 돌아가며 하나를 비운다
+    set = &atlas->sets[atlas->next_evict];
+    atlas->next_evict = (atlas->next_evict + 1) % GLYPH_MAX_SETS;
+    set_free(set);
+  }
+  if (set->height == 0)
+  {
+    set->height = height;
+    set->advance = 2 * glyph_width(height);
+    set->line_height = 3 * height / 2;
+  }
+
+  Glyph *g = &set->glyphs[uc - GLYPH_FIRST];
+  if (!g->ready && glyph_rasterize(g, c, height) != 0)
+    return NULL;
+  return g;
+}
+
+static int span_cmp(const void *a, const void *b)
+{
+  const GlyphSpan *sa = a, *sb = b;
+  if (sa->y != sb->y)
+    return sa->y - sb->y;
+  return sa->x - sb->x;
+}
+
+static void blit_spans(dev_fb *fb, const GlyphSpan *spans, int n, int ox, int oy, uint32_t pixel)
+{
+  for (int i = 0; i < n; i++)
+    fb_fillSpan(fb, ox + spans[i].x, oy + spans[i].y, spans[i].len, pixel);
+}
+
+void glyph_atlas_init(GlyphAtlas *atlas)
+{
+  memset(atlas->sets, 0, sizeof(atlas->sets));
+  atlas->next_evict = 0;
+  pthread_mutex_init(&atlas->mutex, NULL);
+}
+
+void glyph_atlas_free(GlyphAtlas *atlas)
+{
+  if (!atlas)
+    return;
+  for (int i = 0; i < GLYPH_MAX_SETS; i++)
+    set_free(&atlas->sets[i]);
+  pthread_mutex_destroy(&atlas->mutex);
+}
+
+GlyphAtlas *glyph_default_atlas(void)
+{
+  pthread_once(&default_once, default_atlas_init);
+  return &default_atlas;
+}
+
+void glyph_draw(GlyphAtlas *atlas, dev_fb *fb, char c, pixel start, short height,
+                uint32_t pixel)
+{
+  if (!atlas || !fb)
+    return;
+
+  // blit 도 lock 안에서: 다른 스레드가 set 을 evict 할 수 있다
+  pthread_mutex_lock(&atlas->mutex);
+  const Glyph *g = glyph_lookup(atlas, c, height);
+  if (g)
+    blit_spans(fb, g->spans, g->nspans, start.x, start.y, pixel);
+  pthread_mutex_unlock(&atlas->mutex);
+}
+
+int text_run_init(TextRun *run, GlyphAtlas *atlas, const char *str, short height)
+{
+  if (!run || !atlas || !str || height <= 0)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  memset(run, 0, sizeof(*run));
+  run->height = height;
+
+  int cap = 0;
+  int x = 0, y = 0;
+  int advance = 2 * glyph_width(height);
+  int line_height = 3 * height / 2;
+
+  pthread_mutex_lock(&atlas->mutex);
+  for (const char *p = str; *p; p++)
+  {
+    if (*p == '\n')
+    {
+      x = 0;
+      y += line_height;
+      continue;
+    }
+
+    const Glyph *g = glyph_lookup(atlas, *p, height);
+    if (g && g->nspans > 0)
+    {
+      if (run->nspans + g->nspans > cap)
+      {
+        int ncap = cap ? cap * 2 : 64;
+        while (ncap < run->nspans + g->nspans)
+          ncap *= 2;
+        GlyphSpan *ns = realloc(run->spans, sizeof(GlyphSpan) * ncap);
+        if (!ns)
+        {
+          pthread_mutex_unlock(&atlas->mutex);
+          text_run_free(run);
+          errno = ENOMEM;
+          return -1;
+        }
+        run->spans = ns;
+        cap = ncap;
+      }
+      for (int i = 0; i < g->nspans; i++)
+      {
+        GlyphSpan s = g->spans[i];
+        s.x = (int16_t)(s.x + x);
+        s.y = (int16_t)(s.y + y);
+        run->spans[run->nspans++] = s;
+      }
+      if (x + g->w > run->w)
+        run->w = x + g->w;
+      if (y + g->h > run->h)
+        run->h = y + g->h;
+    }
+    x += advance;
+  }
+  pthread_mutex_unlock(&atlas->mutex);
+
+  // 행 순서로 정렬해 두면 그릴 때 framebuffer 를 위에서 아래로 한 번 훑는다
+  if (run->nspans > 1)
+    qsort(run->spans, run->nspans, sizeof(GlyphSpan), span_cmp);
+  return 0;
+}
+
+void text_run_draw(dev_fb *fb, const TextRun *run, pixel origin, char r, char g, char b)
+{
+  if (!fb || !run)
+    return;
+  blit_spans(fb, run->spans, run->nspans, origin.x, origin.y, fb_packColor(fb, r, g, b));
+}
+
+void text_run_free(TextRun *run)
+{
+  if (!run)
+    return;
+  free(run->spans);
+  run->spans = NULL;
+  run->nspans = 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * @file mailbox.c
+ * @brief Latest-frame mailbox: atomic exchange hand-over, semaphore wakeup.
+ */
+#define _GNU_SOURCE
+#include "mailbox.h"
+
+#include <string.h>
+#include <time.h>
+
+int mailbox_init(FrameMailbox *mb, FramePool *pool)
+{
+  if (!mb || !pool)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  memset(mb, 0, sizeof(*mb));
+  atomic_init(&mb->slot, NULL);
+  atomic_init(&mb->closed, false);
+  atomic_init(&mb->published, 0);
+  atomic_init(&mb->superseded, 0);
+  mb->pool = pool;
+  if (sem_init(&mb->ready, 0, 0) < 0)
+    return -1;
+  return 0;
+}
+
+void mailbox_destroy(FrameMailbox *mb)
+{
+  if (!mb || !mb->pool)
+    return;
+  FrameBlock *left = atomic_exchange(&mb->slot, NULL);
+  if (left)
+    fp_release(mb->pool, left);
+  sem_destroy(&mb->ready);
+  mb->pool = NULL;
+}
+
+int mailbox_put(FrameMailbox *mb, FrameBlock *fb)
+{
+  if (atomic_load_explicit(&mb->closed, memory_order_acquire))
+  {
+    errno = ECANCELED;
+    return -1;
+  }
+  atomic_fetch_add_explicit(&mb->published, 1, memory_order_relaxed);
+
+  // acq_rel: consumer 가 block 내용을, 우리는 밀려난 block 을 온전히 본다
+  FrameBlock *old = atomic_exchange_explicit(&mb->slot, fb, memory_order_acq_rel);
+  if (old)
+  {
+    // 아직 안 가져간 frame 은 새 frame 으로 대체: consumer 는 이미 깨어 있다
+    atomic_fetch_add_explicit(&mb->superseded, 1, memory_order_relaxed);
+    fp_release(mb->pool, old);
+  }
+  else
+    sem_post(&mb->ready);
+  return 0;
+}
+
+FrameBlock *mailbox_take(FrameMailbox *mb, int timeout_ms)
+{
+  struct timespec deadline;
+  if (timeout_ms > 0)
+  {
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+  }
+
+  // post 는 slot 이 비었다가 찰 때마다 하나: 기다린 뒤에 가져가면 개수가 맞는다
+  for (;;)
+  {
+    int rc = timeout_ms == 0  ? sem_trywait(&mb->ready)
+             : timeout_ms < 0 ? sem_wait(&mb->ready)
+                              : sem_clockwait(&mb->ready, CLOCK_MONOTONIC, &deadline);
+    if (rc < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      errno = ETIMEDOUT; // sem_trywait 는 EAGAIN
+      return NULL;
+    }
+
+    FrameBlock *fb = atomic_exchange_explicit(&mb->slot, NULL, memory_order_acq_rel);
+    if (fb)
+      return fb;
+    if (atomic_load_explicit(&mb->closed, memory_order_acquire))
+    {
+      sem_post(&mb->ready); // 다음 호출도 바로 끝나도록 close 의 post 를 되돌려 둔다
+      errno = ECANCELED;
+      return NULL;
+    }
+  }
+}
+
+void mailbox_close(FrameMailbox *mb)
+{
+  atomic_store_explicit(&mb->closed, true, memory_order_release);
+  sem_post(&mb->ready);
+}
+
+size_t mailbox_superseded(const FrameMailbox *mb)
+{
+  return mb ? atomic_load_explicit(&mb->superseded, memory_order_relaxed) : 0;
+}
@@ -2,55 +2,182 @@
  * @file main.c
  * @brief Application entry: setup threads and shared resources.
  */
+#include "adapt.h"
+#include "analysis.h"
 #include "capture.h"
 #include "display.h"
 #include "record.h"
 #include "thread_arg.h"
 
+#if STREAM_COUNT < 1 || STREAM_COUNT > STREAM_MAX || DISPLAY_STREAM >= STREAM_COUNT
+#error "STREAM_COUNT must be 1..STREAM_MAX and DISPLAY_STREAM one of the streams"
+#endif
+#if ADAPT_POOL && (ADAPT_POOL_MAX < POOL_SIZE || ADAPT_POOL_MAX > QUEUE_SIZE)
+#error "ADAPT_POOL needs POOL_SIZE <= ADAPT_POOL_MAX <= QUEUE_SIZE"
+#endif
+
+// 자동 조절이면 최대치만큼 잡아 두고 (닿지 않은 page 는 메모리를 쓰지 않는다) POOL_SIZE 부터 시작
+#define POOL_CAPACITY (ADAPT_POOL ? ADAPT_POOL_MAX : POOL_SIZE)
+
+/**
+ * @brief Create a pool for @p nstreams streams, limited to POOL_SIZE blocks each.
+ * @return Pool, or NULL on error.
+ */
+static FramePool *stream_pool_create(int nstreams)
+{
+  FramePool *fp = frame_pool_create((size_t)POOL_CAPACITY * nstreams, WIDTH, HEIGHT, TYPE);
+  if (fp)
+    fp_set_limit(fp, (size_t)POOL_SIZE * nstreams);
+  return fp;
+}
+
+/**
+ * @brief QueueDropFn of the frame queues: give an evicted block back to its stream's pool.
+ * @param[in] item FrameBlock.
+ * @param[in] ctx  SharedCtx.
+ */
+static void drop_frame(void *item, void *ctx)
+{
+  FrameBlock *fb = (FrameBlock *)item;
+  SharedCtx *sh_ctx = (SharedCtx *)ctx;
+  fp_release(sh_ctx->streams[fb->frame.stream].frame_pool, fb);
+}
+
+/**
+ * @brief Fill in one stream's paths, wrap semaphore, record queue and pool.
+ * @return 0 on success, -1 on error.
+ */
+static int stream_init(SharedCtx *sh_ctx, int id)
+{
+  StreamCtx *st = &sh_ctx->streams[id];
+  st->id = id;
+  st->shared = sh_ctx;
+  if (CAPTURE_SYNTH)
+    snprintf(st->capture_file, sizeof(st->capture_file), "%s,seed=%d", CAPTURE_SYNTH_SPEC, id + 1);
+  else
+    snprintf(st->capture_file, sizeof(st->capture_file), CAPTURE_FILE_FMT, id + 1);
+  snprintf(st->record_file, sizeof(st->record_file), RECORD_FILE_FMT, id + 1);
+
+  if (sem_init(&st->wrap_sem, 0, 0) < 0)
+  {
+    perror("sem_init");
+    return -1;
+  }
+  st->record_q = queue_init(QUEUE_SIZE);
+  if (st->record_q == NULL)
+    return -1;
+
+  // 공유 pool 이면 한 stream 이 잠깐 몰려도 다른 stream 의 여유 블록을 쓴다
+  st->frame_pool = STREAM_POOL_SHARED ? sh_ctx->frame_pool : stream_pool_create(1);
+  if (st->frame_pool == NULL)
+    return -1;
+
+  // 녹화는 자기 몫까지만 쌓는다: 나머지 블록은 display/analysis 가 쓸 수 있게 남긴다
+  int sharing = STREAM_POOL_SHARED ? STREAM_COUNT : 1;
+  size_t headroom = RECORD_POOL_HEADROOM((size_t)sharing);
+  size_t limit = fp_get_limit(st->frame_pool);
+  size_t share = (limit > headroom ? limit - headroom : 0) / (size_t)sharing;
+  queue_set_limit(st->record_q, share > 0 ? share : 1);
+  return queue_set_policy(st->record_q, RECORD_QUEUE_POLICY, drop_frame, sh_ctx);
+}
+
 int main(void)
 {
-  pthread_t capture_thread;
+  pthread_t capture_thread[STREAM_MAX];
+  pthread_t record_thread[STREAM_MAX];
   pthread_t display_thread;
-  pthread_t record_thread;
+  pthread_t analysis_thread;
+  pthread_t adapt_thread;
   pthread_t ui_thread;
 
-  SharedCtx *sh_ctx = malloc(sizeof(SharedCtx));
+  SharedCtx *sh_ctx = calloc(1, sizeof(SharedCtx));
   if (sh_ctx == NULL)
   {
     fprintf(stderr, "%s:%d in %s() → Failed to allocate memory for SharedCtx\n", __FILE__, __LINE__,
             __func__);
     return EXIT_FAILURE;
   }
+  sh_ctx->nstreams = STREAM_COUNT;
 
   /* Open input/output raw files */
   sh_ctx->fd_in = open("in.raw", O_RDONLY);
   sh_ctx->fd_out = open("out.raw", O_RDWR | O_CREAT, 0666);
 
-  /* Init wrap semaphore */
-  if (sem_init(&sh_ctx->wrap_sem, 0, 0) < 0)
+  /* Create queues and pools */
+  sh_ctx->display_q = queue_init(QUEUE_SIZE);
+  sh_ctx->motion_q = queue_init(MOTION_QUEUE_SIZE);
+  if (sh_ctx->display_q == NULL || sh_ctx->motion_q == NULL)
   {
-    perror("sem_init");
+    fprintf(stderr, "%s:%d in %s() → Failed to allocate memory for queues\n", __FILE__, __LINE__,
+            __func__);
     return EXIT_FAILURE;
   }
 
-  /* Create queues and pool */
-  sh_ctx->display_q = queue_init(QUEUE_SIZE);
-  sh_ctx->record_q = queue_init(QUEUE_SIZE);
-  if (sh_ctx->display_q == NULL || sh_ctx->record_q == NULL)
+  // display 는 디스크 속도와 무관하게 최신 frame 을, analysis 는 여유가 있을 때만
+  queue_set_limit(sh_ctx->display_q, DISPLAY_QUEUE_DEPTH);
+  if (queue_set_policy(sh_ctx->display_q, DISPLAY_QUEUE_POLICY, drop_frame, sh_ctx) < 0 ||
+      queue_set_policy(sh_ctx->motion_q, QUEUE_DROP_NEWEST, NULL, NULL) < 0)
   {
-    fprintf(stderr, "%s:%d in %s() → Failed to allocate memory for queues\n", __FILE__, __LINE__,
-            __func__);
+    perror("queue_set_policy");
     return EXIT_FAILURE;
   }
 
-  sh_ctx->frame_pool = frame_pool_create(POOL_SIZE, WIDTH, HEIGHT, TYPE);
-  if (sh_ctx->frame_pool == NULL)
+  md_board_init(&sh_ctx->motion);
+
+  if (STREAM_POOL_SHARED)
   {
-    fprintf(stderr, "%s:%d in %s() → Failed to allocate memory for FramePool\n", __FILE__, __LINE__,
-            __func__);
+    sh_ctx->frame_pool = stream_pool_create(STREAM_COUNT);
+    if (sh_ctx->frame_pool == NULL)
+    {
+      fprintf(stderr, "%s:%d in %s() → Failed to allocate memory for FramePool\n", __FILE__,
+              __LINE__, __func__);
+      return EXIT_FAILURE;
+    }
+  }
+  for (int i = 0; i < sh_ctx->nstreams; i++)
+  {
+    if (stream_init(sh_ctx, i) < 0)
+    {
+      fprintf(stderr, "%s:%d in %s() → Failed to set up stream %d\n", __FILE__, __LINE__,
+              __func__, i);
+      return EXIT_FAILURE;
+    }
+  }
+
+  // 한 stream 만 보이면 display 는 mailbox 에서 최신 frame 만: 밀려도 한 frame 이상 늦지 않는다
+  sh_ctx->display_mailbox = DISPLAY_MAILBOX && !(DISPLAY_MOSAIC && sh_ctx->nstreams > 1);
+  if (sh_ctx->display_mailbox &&
+      mailbox_init(&sh_ctx->display_mb, sh_ctx->streams[DISPLAY_STREAM].frame_pool) < 0)
+  {
+    perror("mailbox_init");
     return EXIT_FAILURE;
   }
 
+  // 모든 recorder 의 slice 인코딩은 pool 하나에서: stream 수만큼 thread 가 늘지 않는다
+  if (RECORD_CODEC)
+  {
+    sh_ctx->encode_pool = tp_create(STREAM_ENCODE_THREADS);
+    if (sh_ctx->encode_pool == NULL)
+    {
+      perror("tp_create");
+      return EXIT_FAILURE;
+    }
+  }
+
+  /* Budget: frame memory and threads for all streams */
+  size_t blocks = (size_t)POOL_SIZE * STREAM_COUNT;
+  size_t reserve = (size_t)POOL_CAPACITY * STREAM_COUNT;
+  size_t frame_bytes = fp_total_bytes_per_frame_size(sh_ctx->streams[0].frame_pool);
+  fprintf(stderr, "%s:%d in %s() → %d streams: %zu frame blocks (%.1f MB, up to %zu reserved), %d threads + %zu encode workers\n",
+          __FILE__, __LINE__, __func__, sh_ctx->nstreams, blocks, blocks * frame_bytes / 1e6,
+          reserve, 2 * sh_ctx->nstreams + 3 + ADAPT_POOL,
+          sh_ctx->encode_pool ? tp_worker_count(sh_ctx->encode_pool) : 0);
+
+  // 녹화 중 page fault 로 멈추지 않도록 (RLIMIT_MEMLOCK 이 모자라면 경고만)
+  if (SCHED_MLOCKALL && rt_lock_memory() < 0)
+    fprintf(stderr, "%s:%d in %s() → mlockall failed: %s\n", __FILE__, __LINE__, __func__,
+            strerror(errno));
+
   /* Start UI thread */
   if (ui_run(&sh_ctx->ui_arg, &ui_thread) == false)
   {
@@ -61,34 +188,79 @@ int main(void)
   // UI Thread가 초기화될 때까지 대기
 
   /* Start worker threads */
-  if (capture_run(sh_ctx, &capture_thread) == false)
+  for (int i = 0; i < sh_ctx->nstreams; i++)
+  {
+    if (capture_run(&sh_ctx->streams[i], &capture_thread[i]) == false)
+    {
+      return EXIT_FAILURE;
+    }
+
+    if (record_run(&sh_ctx->streams[i], &record_thread[i]) == false)
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (display_run(sh_ctx, &display_thread) == false)
   {
     return EXIT_FAILURE;
   }
 
-  if (record_run(sh_ctx, &record_thread) == false)
+  if (analysis_run(sh_ctx, &analysis_thread) == false)
   {
     return EXIT_FAILURE;
   }
 
-  if (display_run(sh_ctx, &display_thread) == false)
+  if (ADAPT_POOL && adapt_run(sh_ctx, &adapt_thread) == false)
   {
     return EXIT_FAILURE;
   }
 
   /* Join and cleanup */
-  pthread_join(capture_thread, NULL);
-  pthread_join(record_thread, NULL);
+  for (int i = 0; i < sh_ctx->nstreams; i++)
+  {
+    pthread_join(capture_thread[i], NULL);
+    pthread_join(record_thread[i], NULL);
+  }
   pthread_join(display_thread, NULL);
+  pthread_join(analysis_thread, NULL);
+  if (ADAPT_POOL)
+    pthread_join(adapt_thread, NULL);
   pthread_join(ui_thread, NULL);
 
+  /* Frames each consumer lost to its backpressure policy */
+  for (int i = 0; i < sh_ctx->nstreams; i++)
+    fprintf(stderr, "%s:%d in %s() → record %d (%s): %zu frames dropped\n", __FILE__, __LINE__,
+            __func__, i, queue_policy_name(sh_ctx->streams[i].record_q->policy),
+            queue_drop_count(sh_ctx->streams[i].record_q));
+  fprintf(stderr, "%s:%d in %s() → display (%s): %zu frames dropped, analysis (%s): %zu skipped\n",
+          __FILE__, __LINE__, __func__,
+          sh_ctx->display_mailbox ? "mailbox" : queue_policy_name(sh_ctx->display_q->policy),
+          sh_ctx->display_mailbox ? mailbox_superseded(&sh_ctx->display_mb)
+                                  : queue_drop_count(sh_ctx->display_q),
+          queue_policy_name(sh_ctx->motion_q->policy), queue_drop_count(sh_ctx->motion_q));
+
+  // 남은 frame 을 pool 에 돌려주므로 pool 보다 먼저
+  if (sh_ctx->display_mailbox)
+    mailbox_destroy(&sh_ctx->display_mb);
+  for (int i = 0; i < sh_ctx->nstreams; i++)
+  {
+    StreamCtx *st = &sh_ctx->streams[i];
+    queue_destroy(st->record_q);
+    sem_destroy(&st->wrap_sem);
+    if (!STREAM_POOL_SHARED)
+      frame_pool_destroy(st->frame_pool);
+  }
   queue_destroy(sh_ctx->display_q);
-  queue_destroy(sh_ctx->record_q);
-  frame_pool_destroy(sh_ctx->frame_pool);
+  queue_destroy(sh_ctx->motion_q);
+  md_board_destroy(&sh_ctx->motion);
+  if (STREAM_POOL_SHARED)
+    frame_pool_destroy(sh_ctx->frame_pool);
+  tp_destroy(sh_ctx->encode_pool);
 
   if (sh_ctx)
     free(sh_ctx);
   sh_ctx = NULL;
 
   return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
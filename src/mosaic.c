@@ -0,0 +1,253 @@
+/*
+ * @file mosaic.c
+ * @brief Grid compositor: dirty-tile scaling and paged presentation.
+ */
+#include "mosaic.h"
+
+/* compose 한 번에 scale 할 tile 과 전체 행 번호의 시작 */
+typedef struct ComposeJob
+{
+  Mosaic *m;
+  int tiles[MOSAIC_MAX_TILES];
+  size_t first_row[MOSAIC_MAX_TILES + 1];
+  int njobs;
+} ComposeJob;
+
+// panel 에서 page 의 시작 행
+static int page_yoffset(const Mosaic *m, int page)
+{
+  return page * (int)m->back.vinfo.yres;
+}
+
+static void scale_range(size_t begin, size_t end, void *ctx)
+{
+  ComposeJob *job = ctx;
+  Mosaic *m = job->m;
+  uint8_t *line = malloc(m->back.vinfo.xres);
+  uint16_t *tmp = NULL;
+  size_t tmp_cap = 0;
+  if (!line)
+    goto fail;
+
+  int j = 0;
+  for (size_t row = begin; row < end; row++)
+  {
+    while (row >= job->first_row[j + 1])
+      j++;
+    MosaicTile *t = &m->tiles[job->tiles[j]];
+    size_t need = scaler_tmp_size(&t->scaler);
+    if (need > tmp_cap)
+    {
+      free(tmp);
+      tmp = malloc(need * sizeof(uint16_t));
+      tmp_cap = need;
+      if (!tmp)
+        goto fail;
+    }
+    int y = (int)(row - job->first_row[j]);
+    scaler_scale_row(&t->scaler, t->gray, (size_t)t->src_w, y, line, tmp);
+    fb_putGraySpan(&m->back, t->rect.x, t->rect.y + y, line, t->rect.w, m->lut);
+  }
+  free(tmp);
+  free(line);
+  return;
+
+fail:
+  free(tmp);
+  free(line);
+  atomic_store_explicit(&m->error, ENOMEM, memory_order_relaxed);
+}
+
+// back buffer 의 tile 영역을 panel 의 page 로
+static void copy_tile(Mosaic *m, dev_fb *panel, const MosaicTile *t)
+{
+  size_t bpp = m->back.vinfo.bits_per_pixel / 8;
+  size_t bytes = (size_t)t->rect.w * bpp;
+  for (int y = t->rect.y; y < t->rect.y + t->rect.h; y++)
+    memcpy(panel->fbp + locate(panel, t->rect.x, y), m->back.fbp + locate(&m->back, t->rect.x, y),
+           bytes);
+}
+
+Mosaic *mosaic_create(const dev_fb *panel, int ntiles, ScaleMode mode, ThreadPool *pool)
+{
+  if (!panel || !panel->fbp || ntiles < 1 || ntiles > MOSAIC_MAX_TILES ||
+      (panel->vinfo.bits_per_pixel != 32 && panel->vinfo.bits_per_pixel != 16))
+  {
+    errno = EINVAL;
+    return NULL;
+  }
+
+  Mosaic *m = calloc(1, sizeof(*m));
+  if (!m)
+  {
+    errno = ENOMEM;
+    return NULL;
+  }
+  const int w = panel->vinfo.xres;
+  const int h = panel->vinfo.yres;
+  if (fb_initMemory(&m->back, w, h, panel->vinfo.bits_per_pixel) != 0)
+  {
+    free(m);
+    errno = ENOMEM;
+    return NULL;
+  }
+  // back buffer 는 panel 로 byte 그대로 복사되므로 pixel 배치도 panel 을 따른다
+  m->back.vinfo.red = panel->vinfo.red;
+  m->back.vinfo.green = panel->vinfo.green;
+  m->back.vinfo.blue = panel->vinfo.blue;
+  m->back.vinfo.transp = panel->vinfo.transp;
+  fb_buildGrayLut(panel, m->lut);
+
+  m->ntiles = ntiles;
+  m->mode = mode;
+  m->pool = pool;
+  m->cols = 1;
+  while (m->cols * m->cols < ntiles)
+    m->cols++;
+  m->rows = (ntiles + m->cols - 1) / m->cols;
+  for (int i = 0; i < ntiles; i++)
+  {
+    int c = i % m->cols, r = i / m->cols;
+    int x0 = w * c / m->cols, x1 = w * (c + 1) / m->cols;
+    int y0 = h * r / m->rows, y1 = h * (r + 1) / m->rows;
+    m->tiles[i].rect = (OvlRect){.x = x0, .y = y0, .w = x1 - x0, .h = y1 - y0};
+  }
+
+  // 두 번째 page 가 있으면 숨은 page 에 그린 뒤 pan 으로 한 번에 보여준다
+  m->npages = (panel->vinfo.yres_virtual >= 2 * panel->vinfo.yres) ? 2 : 1;
+  m->page = (m->npages == 2 && (int)panel->vinfo.yoffset >= h) ? 1 : 0;
+  // 처음에는 빈 칸도 검게 지운다
+  m->stale[0] = m->stale[1] = (1u << ntiles) - 1;
+  return m;
+}
+
+void mosaic_destroy(Mosaic *m)
+{
+  if (!m)
+    return;
+  for (int i = 0; i < m->ntiles; i++)
+    scaler_free(&m->tiles[i].scaler);
+  fb_close(&m->back);
+  free(m);
+}
+
+int mosaic_set_frame(Mosaic *m, int tile, const uint8_t *gray, int w, int h)
+{
+  if (!m || !gray || tile < 0 || tile >= m->ntiles || w <= 0 || h <= 0)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  MosaicTile *t = &m->tiles[tile];
+  if (!scaler_matches(&t->scaler, w, h, t->rect.w, t->rect.h, m->mode))
+  {
+    scaler_free(&t->scaler);
+    if (scaler_init(&t->scaler, w, h, t->rect.w, t->rect.h, m->mode) != 0)
+      return -1;
+  }
+  t->gray = gray;
+  t->src_w = w;
+  t->src_h = h;
+  m->dirty |= 1u << tile;
+  return 0;
+}
+
+void mosaic_damage(Mosaic *m, OvlRect r)
+{
+  if (!m)
+    return;
+  for (int i = 0; i < m->ntiles; i++)
+  {
+    const OvlRect *c = &m->tiles[i].rect;
+    if (r.x < c->x + c->w && c->x < r.x + r.w && r.y < c->y + c->h && c->y < r.y + r.h)
+      m->stale[m->page] |= 1u << i;
+  }
+}
+
+int mosaic_compose(Mosaic *m, dev_fb *panel)
+{
+  if (!m || !panel || !panel->fbp)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  /* 1. Scale every dirty tile into the back buffer, rows of all tiles in one pass */
+  ComposeJob job = {.m = m};
+  for (int i = 0; i < m->ntiles; i++)
+  {
+    if (!(m->dirty & (1u << i)))
+      continue;
+    job.tiles[job.njobs] = i;
+    job.first_row[job.njobs + 1] = job.first_row[job.njobs] + (size_t)m->tiles[i].rect.h;
+    job.njobs++;
+  }
+  if (job.njobs > 0)
+  {
+    atomic_store_explicit(&m->error, 0, memory_order_relaxed);
+    tp_parallel_for(m->pool, 0, job.first_row[job.njobs], 0, scale_range, &job);
+    int err = atomic_load_explicit(&m->error, memory_order_relaxed);
+    if (err)
+    {
+      errno = err;
+      return -1;
+    }
+    for (int j = 0; j < job.njobs; j++)
+    {
+      MosaicTile *t = &m->tiles[job.tiles[j]];
+      t->gray = NULL;
+      t->updates++;
+    }
+    m->stale[0] |= m->dirty;
+    m->stale[1] |= m->dirty;
+    m->dirty = 0;
+    m->composes++;
+  }
+
+  /* 2. Bring the next page up to date */
+  int page = (m->npages == 2) ? m->page ^ 1 : 0;
+  panel->vinfo.yoffset = (uint32_t)page_yoffset(m, page);
+  if (!(m->cleared & (1u << page)))
+  {
+    // grid 의 남는 칸은 page 마다 한 번만 지운다
+    for (int i = m->ntiles; i < m->cols * m->rows; i++)
+    {
+      int c = i % m->cols, r = i / m->cols;
+      int x0 = (int)panel->vinfo.xres * c / m->cols, x1 = (int)panel->vinfo.xres * (c + 1) / m->cols;
+      int y0 = (int)panel->vinfo.yres * r / m->rows, y1 = (int)panel->vinfo.yres * (r + 1) / m->rows;
+      fb_fillRect(panel, x0, y0, x1 - x0, y1 - y0, 0);
+    }
+    m->cleared |= 1u << page;
+  }
+  for (int i = 0; i < m->ntiles; i++)
+  {
+    if (m->stale[page] & (1u << i))
+      copy_tile(m, panel, &m->tiles[i]);
+  }
+  m->stale[page] = 0;
+  m->page = page;
+  return job.njobs;
+}
+
+int mosaic_present(Mosaic *m, dev_fb *panel)
+{
+  if (!m || !panel)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  if (m->npages < 2 || panel->fbfd < 0)
+    return 0; // 한 page 이거나 off-screen panel: 이미 보이는 곳에 그렸다
+  panel->vinfo.xoffset = 0;
+  panel->vinfo.yoffset = (uint32_t)page_yoffset(m, m->page);
+  if (ioctl(panel->fbfd, FBIOPAN_DISPLAY, &panel->vinfo) < 0)
+    return -1;
+  return 0;
+}
+
+OvlRect mosaic_tile_rect(const Mosaic *m, int tile)
+{
+  if (!m || tile < 0 || tile >= m->ntiles)
+    return (OvlRect){0};
+  return m->tiles[tile].rect;
+}
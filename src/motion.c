@@ -0,0 +1,423 @@
+/*
+ * @file motion.c
+ * @brief Block SAD motion detector with adaptive background.
+ */
+#include "motion.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define MD_RECENT_FRAMES 4 // 프레임 간 변화가 멈춘 뒤 정지한 전경으로 보기까지의 프레임 수
+
+static void config_defaults(MotionConfig *c)
+{
+  if (c->downsample_shift < 1 || c->downsample_shift > 3)
+    c->downsample_shift = MD_DEFAULT_SHIFT;
+  if (c->min_mean_diff <= 0)
+    c->min_mean_diff = 6;
+  if (c->noise_gain <= 0)
+    c->noise_gain = 12;
+  if (c->bg_shift_still <= 0)
+    c->bg_shift_still = 4;
+  if (c->bg_shift_moving <= 0)
+    c->bg_shift_moving = 8;
+  if (c->bg_shift_static <= 0)
+    c->bg_shift_static = 2;
+  if (c->min_blocks <= 0)
+    c->min_blocks = 2;
+  if (c->hold_frames <= 0)
+    c->hold_frames = 15;
+}
+
+uint32_t md_sad_block(const uint8_t *a, const uint8_t *b, int stride, int w, int h)
+{
+  uint32_t sad = 0;
+
+#if defined(__SSE2__)
+  __m128i acc = _mm_setzero_si128();
+  for (int y = 0; y < h; y++, a += stride, b += stride)
+  {
+    int x = 0;
+    for (; x + 16 <= w; x += 16)
+    {
+      __m128i va = _mm_loadu_si128((const __m128i *)(a + x));
+      __m128i vb = _mm_loadu_si128((const __m128i *)(b + x));
+      acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    for (; x + 8 <= w; x += 8)
+    {
+      __m128i va = _mm_loadl_epi64((const __m128i *)(a + x));
+      __m128i vb = _mm_loadl_epi64((const __m128i *)(b + x));
+      acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    for (; x < w; x++)
+      sad += (uint32_t)abs(a[x] - b[x]);
+  }
+  // psadbw 는 두 64bit lane 에 부분합을 남긴다
+  sad += (uint32_t)_mm_cvtsi128_si32(acc) + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#elif defined(__ARM_NEON)
+  uint32x4_t acc = vdupq_n_u32(0);
+  for (int y = 0; y < h; y++, a += stride, b += stride)
+  {
+    int x = 0;
+    uint16x8_t row = vdupq_n_u16(0);
+    for (; x + 16 <= w; x += 16)
+      row = vpadalq_u8(row, vabdq_u8(vld1q_u8(a + x), vld1q_u8(b + x)));
+    // 행마다 32bit 로 넓혀 넘침 방지
+    acc = vpadalq_u16(acc, row);
+    for (; x < w; x++)
+      sad += (uint32_t)abs(a[x] - b[x]);
+  }
+  sad += vgetq_lane_u32(acc, 0) + vgetq_lane_u32(acc, 1) + vgetq_lane_u32(acc, 2) +
+         vgetq_lane_u32(acc, 3);
+#else
+  for (int y = 0; y < h; y++, a += stride, b += stride)
+  {
+    for (int x = 0; x < w; x++)
+      sad += (uint32_t)abs(a[x] - b[x]);
+  }
+#endif
+  return sad;
+}
+
+MotionDetector *md_create(int width, int height, const MotionConfig *cfg)
+{
+  MotionConfig c = {0};
+  if (cfg)
+    c = *cfg;
+  config_defaults(&c);
+
+  int w = width >> c.downsample_shift;
+  int h = height >> c.downsample_shift;
+  if (width <= 0 || height <= 0 || w < 1 || h < 1)
+  {
+    errno = EINVAL;
+    return NULL;
+  }
+
+  MotionDetector *md = calloc(1, sizeof(*md));
+  if (!md)
+  {
+    errno = ENOMEM;
+    return NULL;
+  }
+  md->cfg = c;
+  md->src_w = width;
+  md->src_h = height;
+  md->w = w;
+  md->h = h;
+  md->bw = (w + MD_BLOCK - 1) / MD_BLOCK;
+  md->bh = (h + MD_BLOCK - 1) / MD_BLOCK;
+
+  size_t plane = (size_t)w * h;
+  size_t nblocks = (size_t)md->bw * md->bh;
+  md->acc = malloc(sizeof(uint16_t) * ((size_t)w << c.downsample_shift));
+  md->cur = malloc(plane);
+  md->prev = malloc(plane);
+  md->bg = malloc(sizeof(uint16_t) * plane);
+  md->bg8 = malloc(plane);
+  md->noise = malloc(sizeof(uint32_t) * nblocks);
+  md->sad = malloc(sizeof(uint32_t) * nblocks);
+  md->recent = calloc(nblocks, 1);
+  md->active = malloc(nblocks);
+  md->stack = malloc(sizeof(int) * nblocks);
+  if (!md->acc || !md->cur || !md->prev || !md->bg || !md->bg8 || !md->noise || !md->sad ||
+      !md->recent || !md->active || !md->stack)
+  {
+    md_destroy(md);
+    errno = ENOMEM;
+    return NULL;
+  }
+  return md;
+}
+
+void md_destroy(MotionDetector *md)
+{
+  if (!md)
+    return;
+  free(md->acc);
+  free(md->cur);
+  free(md->prev);
+  free(md->bg);
+  free(md->bg8);
+  free(md->noise);
+  free(md->sad);
+  free(md->recent);
+  free(md->active);
+  free(md->stack);
+  free(md);
+}
+
+// f x f box filter: 열 방향 합을 먼저 누적하고 가로로 f 개씩 묶는다
+static void downsample(MotionDetector *md, const uint8_t *gray)
+{
+  int s = md->cfg.downsample_shift;
+  int f = 1 << s;
+  int cols = md->w << s;
+
+  for (int oy = 0; oy < md->h; oy++)
+  {
+    const uint8_t *src = gray + (size_t)(oy << s) * md->src_w;
+    for (int x = 0; x < cols; x++)
+      md->acc[x] = src[x];
+    for (int r = 1; r < f; r++)
+    {
+      src += md->src_w;
+      for (int x = 0; x < cols; x++)
+        md->acc[x] += src[x];
+    }
+
+    uint8_t *dst = md->cur + (size_t)oy * md->w;
+    const uint16_t *a = md->acc;
+    for (int ox = 0; ox < md->w; ox++, a += f)
+    {
+      uint32_t sum = 0;
+      for (int k = 0; k < f; k++)
+        sum += a[k];
+      dst[ox] = (uint8_t)(sum >> (2 * s));
+    }
+  }
+}
+
+static void bg_update_block(MotionDetector *md, int x0, int y0, int bw, int bh, int shift)
+{
+  for (int y = y0; y < y0 + bh; y++)
+  {
+    size_t off = (size_t)y * md->w + x0;
+    uint16_t *bg = md->bg + off;
+    uint8_t *bg8 = md->bg8 + off;
+    const uint8_t *cur = md->cur + off;
+    for (int x = 0; x < bw; x++)
+    {
+      int v = bg[x] + ((((int)cur[x] << 8) - (int)bg[x]) >> shift);
+      bg[x] = (uint16_t)v;
+      bg8[x] = (uint8_t)((v + 128) >> 8);
+    }
+  }
+}
+
+// 8-연결 flood fill 로 active block 을 region 으로 묶는다
+static void collect_regions(MotionDetector *md, MotionEvent *ev)
+{
+  int s = md->cfg.downsample_shift;
+  ev->nregions = 0;
+
+  for (int start = 0; start < md->bw * md->bh; start++)
+  {
+    if (md->active[start] != 1)
+      continue;
+
+    int bx0 = md->bw, by0 = md->bh, bx1 = -1, by1 = -1, nblk = 0;
+    uint64_t sad = 0, npx = 0;
+    int sp = 0;
+    md->stack[sp++] = start;
+    md->active[start] = 2;
+    while (sp > 0)
+    {
+      int i = md->stack[--sp];
+      int bx = i % md->bw, by = i / md->bw;
+      int pw = (bx + 1) * MD_BLOCK > md->w ? md->w - bx * MD_BLOCK : MD_BLOCK;
+      int ph = (by + 1) * MD_BLOCK > md->h ? md->h - by * MD_BLOCK : MD_BLOCK;
+      nblk++;
+      sad += md->sad[i];
+      npx += (uint64_t)pw * ph;
+      if (bx < bx0)
+        bx0 = bx;
+      if (bx > bx1)
+        bx1 = bx;
+      if (by < by0)
+        by0 = by;
+      if (by > by1)
+        by1 = by;
+
+      for (int dy = -1; dy <= 1; dy++)
+      {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+          int nx = bx + dx, ny = by + dy;
+          if (nx < 0 || ny < 0 || nx >= md->bw || ny >= md->bh)
+            continue;
+          int n = ny * md->bw + nx;
+          if (md->active[n] == 1)
+          {
+            md->active[n] = 2;
+            md->stack[sp++] = n;
+          }
+        }
+      }
+    }
+
+    MotionRegion r;
+    r.x = (bx0 * MD_BLOCK) << s;
+    r.y = (by0 * MD_BLOCK) << s;
+    int x1 = ((bx1 + 1) * MD_BLOCK > md->w ? md->w : (bx1 + 1) * MD_BLOCK) << s;
+    int y1 = ((by1 + 1) * MD_BLOCK > md->h ? md->h : (by1 + 1) * MD_BLOCK) << s;
+    r.w = x1 - r.x;
+    r.h = y1 - r.y;
+    r.blocks = nblk;
+    r.score = npx ? (float)sad / (float)npx : 0.0f;
+
+    // block 수 기준 내림차순으로 상위 MD_MAX_REGIONS 개만 유지
+    int pos = ev->nregions;
+    if (pos == MD_MAX_REGIONS)
+    {
+      if (ev->regions[MD_MAX_REGIONS - 1].blocks >= nblk)
+        continue;
+      pos = MD_MAX_REGIONS - 1;
+    }
+    else
+    {
+      ev->nregions++;
+    }
+    while (pos > 0 && ev->regions[pos - 1].blocks < nblk)
+    {
+      ev->regions[pos] = ev->regions[pos - 1];
+      pos--;
+    }
+    ev->regions[pos] = r;
+  }
+}
+
+int md_process(MotionDetector *md, const uint8_t *gray, size_t seq, MotionEvent *ev)
+{
+  if (!md || !gray || !ev)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  uint8_t *tmp = md->prev;
+  md->prev = md->cur;
+  md->cur = tmp;
+  downsample(md, gray);
+
+  memset(ev, 0, sizeof(*ev));
+  ev->seq = seq;
+
+  size_t nblocks = (size_t)md->bw * md->bh;
+  if (md->frames++ == 0)
+  {
+    // 첫 프레임이 배경의 초기값
+    for (size_t i = 0; i < (size_t)md->w * md->h; i++)
+    {
+      md->bg[i] = (uint16_t)(md->cur[i] << 8);
+      md->bg8[i] = md->cur[i];
+    }
+    for (size_t i = 0; i < nblocks; i++)
+      md->noise[i] = (uint32_t)(MD_BLOCK * MD_BLOCK * 2) << 8;
+    return 0;
+  }
+
+  int nactive = 0;
+
+  for (int by = 0; by < md->bh; by++)
+  {
+    for (int bx = 0; bx < md->bw; bx++)
+    {
+      int i = by * md->bw + bx;
+      int x0 = bx * MD_BLOCK, y0 = by * MD_BLOCK;
+      int pw = x0 + MD_BLOCK > md->w ? md->w - x0 : MD_BLOCK;
+      int ph = y0 + MD_BLOCK > md->h ? md->h - y0 : MD_BLOCK;
+      size_t off = (size_t)y0 * md->w + x0;
+      uint32_t npx = (uint32_t)(pw * ph);
+
+      uint32_t sad_bg = md_sad_block(md->cur + off, md->bg8 + off, md->w, pw, ph);
+      uint32_t sad_prev = md_sad_block(md->cur + off, md->prev + off, md->w, pw, ph);
+
+      uint32_t floor_thr = (uint32_t)md->cfg.min_mean_diff * npx;
+      uint32_t noise_thr = (uint32_t)(((uint64_t)md->noise[i] * md->cfg.noise_gain / 4) >> 8);
+      uint32_t thr = noise_thr > floor_thr ? noise_thr : floor_thr;
+
+      bool changed = sad_bg > thr;
+      bool moving = sad_prev > thr;
+
+      if (moving)
+        md->recent[i] = MD_RECENT_FRAMES;
+      else if (md->recent[i] > 0)
+        md->recent[i]--;
+
+      md->active[i] = changed ? 1 : 0;
+      md->sad[i] = sad_bg;
+      if (changed)
+        nactive++;
+      else
+        md->noise[i] += (int32_t)((sad_bg << 8) - md->noise[i]) >> 5; // 잡음 수준 EMA
+
+      // 움직이는 block 은 천천히, 정지한 block 은 보통 속도로, 배경과 다르지만
+      // 더 이상 변하지 않는 block (지나간 자리, 멈춘 물체) 은 빠르게 흡수
+      int shift = md->cfg.bg_shift_still;
+      if (moving)
+        shift = md->cfg.bg_shift_moving;
+      else if (changed && md->recent[i] == 0)
+        shift = md->cfg.bg_shift_static;
+      bg_update_block(md, x0, y0, pw, ph, shift);
+    }
+  }
+
+  ev->score = (float)nactive / (float)nblocks;
+
+  bool was_active = md->hold > 0;
+  bool motion_now = nactive >= md->cfg.min_blocks;
+  if (motion_now)
+  {
+    collect_regions(md, ev);
+    md->hold = md->cfg.hold_frames;
+  }
+  else if (md->hold > 0)
+  {
+    md->hold--;
+  }
+
+  ev->active = md->hold > 0;
+  ev->started = ev->active && !was_active;
+  ev->ended = was_active && !ev->active;
+  return ev->active ? 1 : 0;
+}
+
+void md_board_init(MotionBoard *board)
+{
+  pthread_mutex_init(&board->mutex, NULL);
+  memset(&board->last, 0, sizeof(board->last));
+  atomic_init(&board->active, false);
+  atomic_init(&board->last_motion_seq, 0);
+  atomic_init(&board->seen, false);
+}
+
+void md_board_destroy(MotionBoard *board)
+{
+  if (!board)
+    return;
+  pthread_mutex_destroy(&board->mutex);
+}
+
+void md_board_publish(MotionBoard *board, const MotionEvent *ev)
+{
+  pthread_mutex_lock(&board->mutex);
+  board->last = *ev;
+  pthread_mutex_unlock(&board->mutex);
+
+  atomic_store_explicit(&board->active, ev->active, memory_order_release);
+  if (ev->active)
+  {
+    atomic_store_explicit(&board->last_motion_seq, ev->seq, memory_order_release);
+    atomic_store_explicit(&board->seen, true, memory_order_release);
+  }
+}
+
+void md_board_snapshot(MotionBoard *board, MotionEvent *ev)
+{
+  pthread_mutex_lock(&board->mutex);
+  *ev = board->last;
+  pthread_mutex_unlock(&board->mutex);
+}
+
+bool md_board_recent(MotionBoard *board, size_t seq, size_t window)
+{
+  if (!board || !atomic_load_explicit(&board->seen, memory_order_acquire))
+    return false;
+  size_t last = atomic_load_explicit(&board->last_motion_seq, memory_order_acquire);
+  return seq >= last ? seq - last <= window : true;
+}
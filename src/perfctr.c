@@ -0,0 +1,227 @@
+/*
+ * @file perfctr.c
+ * @brief perf_event_open counter groups per stage thread.
+ */
+#define _GNU_SOURCE
+#include "perfctr.h"
+
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const struct
+{
+  const char *name;
+  uint32_t type;
+  uint64_t config;
+} events[PERF_NEVENTS] = {
+    [PERF_CYCLES] = {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    [PERF_INSTRUCTIONS] = {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    [PERF_CACHE_MISSES] = {"cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    [PERF_BRANCH_MISSES] = {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    [PERF_PAGE_FAULTS] = {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+
+static int perf_open(const struct perf_event_attr *attr, int group_fd)
+{
+  // pid 0, cpu -1: 호출한 thread 를 어느 CPU 에서든
+  return (int)syscall(SYS_perf_event_open, attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+const char *perf_event_name(PerfEvent ev)
+{
+  return (ev >= 0 && ev < PERF_NEVENTS) ? events[ev].name : "?";
+}
+
+void perf_stage_init(PerfStage *st, const char *name)
+{
+  memset(st, 0, sizeof(*st));
+  st->name = name;
+  for (int i = 0; i < PERF_NEVENTS; i++)
+  {
+    st->fd[i] = -1;
+    st->slot[i] = -1;
+  }
+}
+
+int perf_stage_open(PerfStage *st, const char *name)
+{
+  perf_stage_init(st, name);
+
+  // 처음 열린 event 가 group leader: 한 번의 read 로 전부 같은 구간 값을 읽는다
+  int leader = -1, err = ENOENT;
+  for (int i = 0; i < PERF_NEVENTS; i++)
+  {
+    struct perf_event_attr attr = {
+        .size = sizeof(attr),
+        .type = events[i].type,
+        .config = events[i].config,
+        .exclude_kernel = 1,
+        .exclude_hv = 1,
+        .read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING,
+    };
+    int fd = perf_open(&attr, leader);
+    if (fd < 0)
+    {
+      err = errno;
+      continue;
+    }
+    if (leader < 0)
+      leader = fd;
+    st->fd[i] = fd;
+    st->slot[i] = st->nslots++;
+  }
+
+  if (st->nslots == 0)
+  {
+    errno = err;
+    return -1;
+  }
+  return st->nslots;
+}
+
+void perf_stage_close(PerfStage *st)
+{
+  if (!st)
+    return;
+  // leader 는 마지막에 닫는다
+  for (int i = PERF_NEVENTS - 1; i >= 0; i--)
+  {
+    if (st->fd[i] >= 0)
+      close(st->fd[i]);
+    st->fd[i] = -1;
+  }
+  st->nslots = 0;
+}
+
+// group 값을 읽어 event 순서로 v[] 에 (multiplex 되었으면 켜져 있던 시간으로 보정)
+static int read_group(PerfStage *st, uint64_t v[PERF_NEVENTS])
+{
+  uint64_t buf[3 + PERF_NEVENTS];
+  int leader = -1;
+  for (int i = 0; i < PERF_NEVENTS && leader < 0; i++)
+    leader = st->fd[i];
+
+  ssize_t want = (ssize_t)((3 + st->nslots) * sizeof(uint64_t));
+  if (read(leader, buf, sizeof(buf)) < want || buf[0] != (uint64_t)st->nslots)
+    return -1;
+
+  uint64_t enabled = buf[1], running = buf[2];
+  for (int i = 0; i < PERF_NEVENTS; i++)
+  {
+    if (st->slot[i] < 0)
+      continue;
+    uint64_t raw = buf[3 + st->slot[i]];
+    if (running && running < enabled)
+    {
+      raw = (uint64_t)((double)raw * enabled / running);
+      st->multiplexed = true;
+    }
+    v[i] = raw;
+  }
+  return 0;
+}
+
+void perf_stage_begin(PerfStage *st)
+{
+  if (st->nslots == 0)
+    return;
+  if (read_group(st, st->start) < 0)
+    perf_stage_close(st); // 읽을 수 없는 counter 는 더 쓰지 않는다
+}
+
+void perf_stage_end(PerfStage *st, unsigned frames)
+{
+  if (st->nslots == 0)
+    return;
+  uint64_t now[PERF_NEVENTS];
+  if (read_group(st, now) < 0)
+  {
+    perf_stage_close(st);
+    return;
+  }
+  for (int i = 0; i < PERF_NEVENTS; i++)
+    if (st->slot[i] >= 0 && now[i] >= st->start[i])
+      st->total[i] += now[i] - st->start[i];
+  st->frames += frames;
+  st->spans++;
+}
+
+bool perf_stage_has(const PerfStage *st, PerfEvent ev)
+{
+  return ev >= 0 && ev < PERF_NEVENTS && st->slot[ev] >= 0;
+}
+
+double perf_stage_per_frame(const PerfStage *st, PerfEvent ev)
+{
+  if (!perf_stage_has(st, ev) || st->frames == 0)
+    return -1;
+  return (double)st->total[ev] / (double)st->frames;
+}
+
+// 1234567 → "1.23M"
+static const char *human(double v, char *buf, size_t n)
+{
+  if (v >= 1e9)
+    snprintf(buf, n, "%.2fG", v / 1e9);
+  else if (v >= 1e6)
+    snprintf(buf, n, "%.2fM", v / 1e6);
+  else if (v >= 1e3)
+    snprintf(buf, n, "%.1fk", v / 1e3);
+  else
+    snprintf(buf, n, "%.1f", v);
+  return buf;
+}
+
+void perf_stage_report(const PerfStage *st, FILE *out)
+{
+  if (!out)
+    out = stderr;
+  if (st->spans == 0 || st->frames == 0)
+  {
+    fprintf(out, "%s: no counter samples\n", st->name ? st->name : "stage");
+    return;
+  }
+
+  char line[512], num[32];
+  int len = snprintf(line, sizeof(line), "%s: %llu frames, per frame", st->name ? st->name : "stage",
+                     (unsigned long long)st->frames);
+  for (int i = 0; i < PERF_NEVENTS && len < (int)sizeof(line); i++)
+  {
+    double v = perf_stage_per_frame(st, (PerfEvent)i);
+    if (v >= 0)
+      len += snprintf(line + len, sizeof(line) - (size_t)len, " %s %s", human(v, num, sizeof(num)),
+                      events[i].name);
+  }
+
+  double cyc = perf_stage_per_frame(st, PERF_CYCLES);
+  double ins = perf_stage_per_frame(st, PERF_INSTRUCTIONS);
+  double llc = perf_stage_per_frame(st, PERF_CACHE_MISSES);
+  if (cyc > 0 && ins >= 0 && len < (int)sizeof(line))
+    len += snprintf(line + len, sizeof(line) - (size_t)len, ", IPC %.2f", ins / cyc);
+  if (ins > 0 && llc >= 0 && len < (int)sizeof(line))
+    len += snprintf(line + len, sizeof(line) - (size_t)len, ", %.2f cache misses/1k instr",
+                    llc * 1000 / ins);
+  if (st->multiplexed && len < (int)sizeof(line))
+    snprintf(line + len, sizeof(line) - (size_t)len, " (multiplexed)");
+  fprintf(out, "%s\n", line);
+}
+
+void perf_stage_write_json(const PerfStage *st, FILE *out)
+{
+  if (st->spans == 0 || st->frames == 0)
+  {
+    fputs("null", out);
+    return;
+  }
+  fprintf(out, "{\"frames\":%llu", (unsigned long long)st->frames);
+  for (int i = 0; i < PERF_NEVENTS; i++)
+  {
+    double v = perf_stage_per_frame(st, (PerfEvent)i);
+    if (v >= 0)
+      fprintf(out, ",\"%s\":%.1f", events[i].name, v);
+  }
+  fprintf(out, ",\"multiplexed\":%s}", st->multiplexed ? "true" : "false");
+}
@@ -7,26 +7,45 @@ Queue *queue_init(size_t capacity)
 {
 
   if (capacity == 0)
+  {
+    errno = EINVAL;
     return NULL;
+  }
 
   Queue *queue = (Queue *)malloc(sizeof(Queue));
   if (!queue)
+  {
+    errno = ENOMEM;
     return NULL;
+  }
 
   queue->buffer = (void **)calloc(capacity, sizeof(void *));
   if (!queue->buffer)
   {
     free(queue);
+    errno = ENOMEM;
     return NULL;
   }
 
   queue->capacity = capacity;
+  queue->limit = capacity;
   queue->head = 0;
   queue->tail = 0;
   queue->count = 0;
+  queue->peak = 0;
+  queue->policy = QUEUE_BLOCK;
+  queue->drop_fn = NULL;
+  queue->drop_ctx = NULL;
+  queue->dropped = 0;
   pthread_mutex_init(&queue->mutex, NULL);
-  pthread_cond_init(&queue->cond_not_full, NULL);
-  pthread_cond_init(&queue->cond_not_empty, NULL);
+
+  // timeout 은 monotonic clock 기준 (시계 조정에 영향받지 않게)
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&queue->cond_not_full, &attr);
+  pthread_cond_init(&queue->cond_not_empty, &attr);
+  pthread_condattr_destroy(&attr);
 
   queue->done = false;
 
@@ -35,11 +54,14 @@ Queue *queue_init(size_t capacity)
 
 void queue_destroy(Queue *queue)
 {
-  safe_free((void **)&queue->buffer);
-  safe_free((void **)&queue);
+  if (!queue)
+    return;
+  // 동기화 객체를 먼저 정리한 뒤 메모리 해제
   pthread_mutex_destroy(&queue->mutex);
   pthread_cond_destroy(&queue->cond_not_full);
   pthread_cond_destroy(&queue->cond_not_empty);
+  safe_free((void **)&queue->buffer);
+  safe_free((void **)&queue);
 }
 
 int is_empty(const Queue *queue)
@@ -49,14 +71,15 @@ int is_empty(const Queue *queue)
 
 int is_full(const Queue *queue)
 {
-  return queue->count == queue->capacity;
+  return queue->count >= queue->limit;
 }
 
 void enqueue(Queue *queue, void *item)
 {
   queue->buffer[queue->tail] = item;
   queue->tail = (queue->tail + 1) % queue->capacity;
-  queue->count++;
+  if (++queue->count > queue->peak)
+    queue->peak = queue->count;
 }
 
 void *dequeue(Queue *queue)
@@ -67,6 +90,212 @@ void *dequeue(Queue *queue)
   return item;
 }
 
+static void deadline_after(struct timespec *ts, int timeout_ms)
+{
+  clock_gettime(CLOCK_MONOTONIC, ts);
+  ts->tv_sec += timeout_ms / 1000;
+  ts->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+  if (ts->tv_nsec >= 1000000000L)
+  {
+    ts->tv_sec++;
+    ts->tv_nsec -= 1000000000L;
+  }
+}
+
+/*
+ * mutex 를 잡은 상태에서 자리(for_space) 또는 item 이 생길 때까지 기다린다.
+ * 0: 가능, -1: errno = ETIMEDOUT / ECANCELED
+ */
+static int wait_until(Queue *queue, pthread_cond_t *cond, bool for_space, int timeout_ms)
+{
+  struct timespec deadline;
+  bool timed_out = false;
+  if (timeout_ms > 0)
+    deadline_after(&deadline, timeout_ms);
+
+  for (;;)
+  {
+    // 끝난 queue 에는 넣을 수 없지만 남은 item 은 꺼낼 수 있다
+    if (queue->done && (for_space || is_empty(queue)))
+    {
+      errno = ECANCELED;
+      return -1;
+    }
+    if (for_space ? !is_full(queue) : !is_empty(queue))
+      return 0;
+    if (timeout_ms == 0 || timed_out)
+    {
+      errno = ETIMEDOUT;
+      return -1;
+    }
+    if (timeout_ms < 0)
+      pthread_cond_wait(cond, &queue->mutex);
+    else
+      timed_out = pthread_cond_timedwait(cond, &queue->mutex, &deadline) == ETIMEDOUT;
+  }
+}
+
+int enqueue_wait(Queue *queue, void *item, int timeout_ms)
+{
+  return enqueue_n(queue, &item, 1, timeout_ms) == 1 ? 0 : -1;
+}
+
+void *dequeue_wait(Queue *queue, int timeout_ms)
+{
+  void *item = NULL;
+  return dequeue_n(queue, &item, 1, timeout_ms) == 1 ? item : NULL;
+}
+
+size_t enqueue_n(Queue *queue, void *const *items, size_t n, int timeout_ms)
+{
+  if (!queue || (n && !items))
+  {
+    errno = EINVAL;
+    return 0;
+  }
+  if (n == 0)
+    return 0;
+
+  pthread_mutex_lock(&queue->mutex);
+  size_t moved = 0;
+  QueuePolicy policy = queue->policy;
+  if (policy == QUEUE_DROP_OLDEST || policy == QUEUE_LATEST_ONLY)
+  {
+    if (queue->done)
+      errno = ECANCELED;
+    // producer 는 기다리지 않는다: 밀린 item 을 내보내고 자리를 만든다
+    while (!queue->done && moved < n)
+    {
+      while (!is_empty(queue) && (policy == QUEUE_LATEST_ONLY || is_full(queue)))
+      {
+        queue->dropped++;
+        queue->drop_fn(dequeue(queue), queue->drop_ctx);
+      }
+      enqueue(queue, items[moved++]);
+    }
+  }
+  else if (wait_until(queue, &queue->cond_not_full, true,
+                      policy == QUEUE_DROP_NEWEST ? 0 : timeout_ms) < 0)
+  {
+    if (errno == ETIMEDOUT)
+    {
+      queue->dropped += n;
+      if (policy == QUEUE_DROP_NEWEST)
+        errno = EAGAIN;
+    }
+  }
+  else
+  {
+    while (moved < n && !is_full(queue))
+      enqueue(queue, items[moved++]);
+    if (policy == QUEUE_DROP_NEWEST)
+      queue->dropped += n - moved;
+  }
+  if (moved > 0)
+  {
+    // 여러 개를 넣었으면 기다리는 consumer 를 모두 깨운다
+    if (moved > 1)
+      pthread_cond_broadcast(&queue->cond_not_empty);
+    else
+      pthread_cond_signal(&queue->cond_not_empty);
+  }
+  pthread_mutex_unlock(&queue->mutex);
+  return moved;
+}
+
+size_t dequeue_n(Queue *queue, void **items, size_t max, int timeout_ms)
+{
+  if (!queue || (max && !items))
+  {
+    errno = EINVAL;
+    return 0;
+  }
+  if (max == 0)
+    return 0;
+
+  pthread_mutex_lock(&queue->mutex);
+  size_t moved = 0;
+  if (wait_until(queue, &queue->cond_not_empty, false, timeout_ms) == 0)
+  {
+    while (moved < max && !is_empty(queue))
+      items[moved++] = dequeue(queue);
+    if (moved > 1)
+      pthread_cond_broadcast(&queue->cond_not_full);
+    else
+      pthread_cond_signal(&queue->cond_not_full);
+  }
+  pthread_mutex_unlock(&queue->mutex);
+  return moved;
+}
+
+int queue_set_limit(Queue *queue, size_t limit)
+{
+  if (!queue || limit == 0)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  pthread_mutex_lock(&queue->mutex);
+  bool raised = limit > queue->limit;
+  queue->limit = limit < queue->capacity ? limit : queue->capacity;
+  if (raised)
+    pthread_cond_broadcast(&queue->cond_not_full);
+  pthread_mutex_unlock(&queue->mutex);
+  return 0;
+}
+
+size_t queue_take_peak(Queue *queue)
+{
+  pthread_mutex_lock(&queue->mutex);
+  size_t peak = queue->peak;
+  queue->peak = queue->count;
+  pthread_mutex_unlock(&queue->mutex);
+  return peak;
+}
+
+int queue_set_policy(Queue *queue, QueuePolicy policy, QueueDropFn drop, void *ctx)
+{
+  bool evicts = policy == QUEUE_DROP_OLDEST || policy == QUEUE_LATEST_ONLY;
+  if (!queue || policy < QUEUE_BLOCK || policy > QUEUE_LATEST_ONLY || (evicts && !drop))
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  pthread_mutex_lock(&queue->mutex);
+  queue->policy = policy;
+  queue->drop_fn = drop;
+  queue->drop_ctx = ctx;
+  pthread_mutex_unlock(&queue->mutex);
+  return 0;
+}
+
+size_t queue_drop_count(const Queue *queue)
+{
+  if (!queue)
+    return 0;
+  pthread_mutex_lock((pthread_mutex_t *)&queue->mutex);
+  size_t dropped = queue->dropped;
+  pthread_mutex_unlock((pthread_mutex_t *)&queue->mutex);
+  return dropped;
+}
+
+const char *queue_policy_name(QueuePolicy policy)
+{
+  switch (policy)
+  {
+  case QUEUE_BLOCK:
+    return "block";
+  case QUEUE_DROP_NEWEST:
+    return "drop-newest";
+  case QUEUE_DROP_OLDEST:
+    return "drop-oldest";
+  case QUEUE_LATEST_ONLY:
+    return "latest-only";
+  default:
+    return "?";
+  }
+}
+
 void queue_set_done(Queue *queue)
 {
   pthread_mutex_lock(&queue->mutex);
@@ -4,64 +4,195 @@
  */
 #include "record.h"
 
+/*
+ * 이전 실행이 남긴 녹화를 복구(잘린 꼬리 제거, index 재구성)하고 *.prev 로 옮긴다.
+ * 새 녹화가 O_TRUNC 로 덮어쓰기 전에 호출.
+ */
+static void keep_previous(const char *path)
+{
+  TbbRecovery rec;
+  if (tbb_recover(path, &rec) < 0)
+  {
+    if (errno != ENOENT)
+      perror("tbb_recover");
+    return;
+  }
+  if (rec.records == 0)
+    return;
+  fprintf(stderr, "%s:%d in %s() → previous recording: %llu records (%llu indexed), %llu bytes dropped\n",
+          __FILE__, __LINE__, __func__, (unsigned long long)rec.records, (unsigned long long)rec.indexed,
+          (unsigned long long)rec.dropped_bytes);
+
+  char from[4096], to[4096];
+  snprintf(to, sizeof(to), "%s.prev", path);
+  if (rename(path, to) < 0)
+    perror("rename");
+  snprintf(from, sizeof(from), "%s%s", path, TBB_INDEX_SUFFIX);
+  snprintf(to, sizeof(to), "%s.prev%s", path, TBB_INDEX_SUFFIX);
+  if (rename(from, to) < 0)
+    perror("rename");
+}
+
+static void release_blocks(FramePool *pool, FrameBlock **blocks, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    fp_release(pool, blocks[i]);
+}
+
 /**
  * @brief Thread function for dequeuing and writing frames.
  *
- * Dequeues blocks, handles wrap semaphores, writes raw frames,
- * and releases blocks back to pool.
- * @param[in] arg Pointer to SharedCtx.
+ * Dequeues all ready blocks at once, handles wrap semaphores, stores changed
+ * frames (and a keep-alive frame now and then) into the .tbb recording, and
+ * releases blocks back to pool. Frames finished by the encoder are written
+ * in one batch per dequeue.
+ * @param[in] arg Pointer to the StreamCtx to record.
  * @return NULL on thread exit.
  */
 static void *record_thread(void *arg)
 {
+  // Initialize the record arguments
+  StreamCtx *stream = (StreamCtx *)arg;
+  SharedCtx *rec_arg = stream->shared;
+  FramePool *frame_pool = stream->frame_pool;
+  FrameBlock *blocks[RECORD_BATCH_MAX];
+  TbbWriter writer;
+  RecordGate gate;
+  FrameEncoder *enc = NULL;
+  PerfStage perf;
+  char perf_name[32];
+  bool failed = false;
+  size_t nblocks;
 
-  /* Open file for writing (create or truncate) */
-  int fd = open(RECORD_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-  if (fd < 0)
+  snprintf(perf_name, sizeof(perf_name), "record %d", stream->id);
+  rt_thread_setup(&RECORD_SCHED, perf_name, SCHED_LATENCY_SAMPLES, SCHED_LATENCY_PERIOD_US);
+  perf_stage_init(&perf, perf_name);
+
+  if (RECORD_KEEP_PREVIOUS)
+    keep_previous(stream->record_file);
+
+  /* Open recording (create or truncate) */
+  if (tbb_writer_open(&writer, stream->record_file, WIDTH, HEIGHT, TYPE, RECORD_FRAME_INTERVAL_US) < 0)
   {
-    perror("raw_video_writer_open: open");
+    perror("tbb_writer_open");
+    goto drain;
+  }
+  // page cache 를 녹화로 채우지 않는다 (O_DIRECT 를 못 쓰는 fs 면 sync 후 버리기)
+  if (tbb_writer_set_io(&writer, RECORD_IO_MODE, RECORD_IO_WRITE_SIZE) < 0 &&
+      (RECORD_IO_MODE != TBB_IO_DIRECT || tbb_writer_set_io(&writer, TBB_IO_DONTNEED, 0) < 0))
+    perror("tbb_writer_set_io");
+  TbbSyncPolicy policy = {
+      .every_frames = RECORD_SYNC_FRAMES,
+      .every_ms = RECORD_SYNC_MS,
+      .writeback = RECORD_SYNC_WRITEBACK,
+      .background = RECORD_SYNC_BACKGROUND,
+  };
+  if (tbb_writer_set_sync(&writer, &policy) < 0)
+    perror("tbb_writer_set_sync");
+  record_gate_init(&gate, WIDTH, HEIGHT);
+  // slice 는 모든 stream 이 공유하는 pool 에서 (없으면 이 encoder 만의 pool)
+  if (rec_arg->encode_pool)
+    enc = fe_create_shared(rec_arg->encode_pool, WIDTH * TYPE, HEIGHT,
+                           RECORD_CODEC ? RECORD_CODEC_SLICES : 0, RECORD_ENCODE_INFLIGHT);
+  else
+    enc = fe_create(WIDTH * TYPE, HEIGHT, RECORD_CODEC ? RECORD_CODEC_SLICES : 0,
+                    RECORD_ENCODE_THREADS, RECORD_ENCODE_INFLIGHT);
+  if (!enc)
+  {
+    perror("fe_create");
+    failed = true;
     goto thread_exit;
   }
 
-  // Initialize the record arguments
-  SharedCtx *rec_arg = (SharedCtx *)arg;
-  FramePool *frame_pool = rec_arg->frame_pool;
-  FrameBlock *fb = NULL;
-
-  pthread_mutex_lock(&rec_arg->ui_arg->mutex);
-  rec_arg->ui_arg->fds[0] = fd;
-  pthread_mutex_unlock(&rec_arg->ui_arg->mutex);
+  fprintf(stderr, "%s:%d in %s() → record thread start (stream %d)\n", __FILE__, __LINE__, __func__,
+          stream->id);
 
-  fprintf(stderr, "%s:%d in %s() → record thread start \n", __FILE__, __LINE__, __func__);
+  // slice 인코딩 worker 몫은 세지 않는다 (gate, 제출, 쓰기만)
+  if (PERF_STAGE_COUNTERS && perf_stage_open(&perf, perf_name) < 0)
+    fprintf(stderr, "%s:%d in %s() → no perf counters: %s\n", __FILE__, __LINE__, __func__,
+            strerror(errno));
 
   while (1)
   {
-    /* Dequeue block */
-    pthread_mutex_lock(&rec_arg->record_q->mutex);
-    while (is_empty(rec_arg->record_q))
+    /* Dequeue every ready block (up to RECORD_BATCH_MAX) at once */
+    // 밀려 있을수록 많이 가져간다: 한가할 때는 frame 하나씩, 밀리면 write 를 모아서
+    nblocks = dequeue_n(stream->record_q, (void **)blocks, RECORD_BATCH_MAX,
+                               QUEUE_WAIT_FOREVER);
+    if (nblocks == 0)
     {
-      pthread_cond_wait(&rec_arg->record_q->cond_not_empty, &rec_arg->record_q->mutex);
+      fprintf(stderr, "%s:%d in %s() → record thread exit (stream %d: stored %zu, skipped %zu)\n",
+              __FILE__, __LINE__, __func__, stream->id, gate.stored, gate.dropped);
+      goto thread_exit;
     }
-    fb = dequeue(rec_arg->record_q);
-    pthread_cond_signal(&rec_arg->record_q->cond_not_full);
-    pthread_mutex_unlock(&rec_arg->record_q->mutex);
+    perf_stage_begin(&perf);
 
-    /* Handle wrap semaphores */
-    while (sem_trywait(&rec_arg->wrap_sem) == 0)
+    for (size_t b = 0; b < nblocks; b++)
     {
-      if (lseek(fd, 0, SEEK_SET) < 0)
+      FrameBlock *fb = blocks[b];
+
+      /* Handle wrap semaphores (input wrapped, or UI restart) */
+      bool rewind = false;
+      while (sem_trywait(&stream->wrap_sem) == 0)
+        rewind = true;
+      if (rewind)
+      {
+        // 진행 중인 frame 은 이전 회차 것: 기록을 마친 뒤 함께 잘라낸다
+        if (fe_flush(enc, &writer, true) < 0 || tbb_writer_rewind(&writer) < 0)
+          perror("record: rewind");
+        fe_reset(enc);
+        record_gate_reset(&gate);
+      }
+
+      /* Decide whether this frame is stored */
+      const uint8_t *data = fb->frame.data;
+      const uint8_t *last = fe_last_frame(enc);
+      size_t seq = fb->frame.seq;
+      gate.seen_seq = seq;
+      bool keepalive = gate.have_last && seq - gate.last_seq >= RECORD_KEEPALIVE_FRAMES;
+      bool changed = !RECORD_GATE || !gate.have_last || !last ||
+                     record_change_score(last, data, gate.width, gate.height) >=
+                         RECORD_CHANGE_SEGMENTS;
+      // motion 분석은 DISPLAY_STREAM 만 받는다
+      if (RECORD_ON_MOTION && stream->id == DISPLAY_STREAM && gate.have_last &&
+          !md_board_recent(&rec_arg->motion, seq, RECORD_MOTION_WINDOW))
+        changed = false;
+
+      if (changed || keepalive)
       {
-        perror("record: lseek rewind");
-        break;
+        uint32_t skipped = gate.have_last ? (uint32_t)(seq - gate.last_seq - 1) : 0;
+        // keep-alive 는 key frame 으로 두어 중간부터 재생할 수 있게 한다
+        bool key = !gate.have_last || keepalive || gate.since_key >= RECORD_KEY_INTERVAL;
+
+        /* Hand the frame to the encoder (it copies the pixels) */
+        if (fe_submit(enc, &writer, data, seq, skipped, changed ? 0 : TBB_FLAG_KEEPALIVE, key) < 0)
+        {
+          fprintf(stderr, "%s:%d in %s() → failed to write frame\n", __FILE__, __LINE__, __func__);
+          release_blocks(frame_pool, blocks + b, nblocks - b);
+          failed = true;
+          goto thread_exit;
+        }
+        gate.since_key = key ? 0 : gate.since_key + 1;
+        gate.have_last = true;
+        gate.last_seq = seq;
+        gate.stored++;
+      }
+      else
+      {
+        gate.dropped++;
       }
+
+      // release the frame block
+      fp_release(frame_pool, fb);
     }
 
-    /* Write frame */
-    if (raw_video_write_frame(fd, fb->frame.data, frame_pool->total_bytes_per_frame) < 0)
+    /* Write every frame finished so far, in one batch */
+    if (fe_flush(enc, &writer, false) < 0)
     {
       fprintf(stderr, "%s:%d in %s() → failed to write frame\n", __FILE__, __LINE__, __func__);
+      failed = true;
       goto thread_exit;
     }
+    perf_stage_end(&perf, (unsigned)nblocks);
 
      /* Wait if stopped */
     pthread_mutex_lock(&rec_arg->ui_arg->mutex);
@@ -72,23 +203,47 @@ static void *record_thread(void *arg)
     }
     if (rec_arg->ui_arg->state == STATE_EXIT)
     {
-
-      fprintf(stderr, "%s:%d in %s() → record thread exit\n", __FILE__, __LINE__, __func__);
+      pthread_mutex_unlock(&rec_arg->ui_arg->mutex);
+      fprintf(stderr, "%s:%d in %s() → record thread exit (stream %d: stored %zu, skipped %zu)\n",
+              __FILE__, __LINE__, __func__, stream->id, gate.stored, gate.dropped);
       goto thread_exit;
     }
 
     pthread_mutex_unlock(&rec_arg->ui_arg->mutex);
-
-    // release the frame block
-    fp_release(frame_pool, fb);
   }
 
 thread_exit:
-  close(fd);
+  if (enc)
+  {
+    fe_flush(enc, &writer, true);
+    // 마지막 저장 이후 건너뛴 구간을 hold record 로 닫는다
+    if (gate.have_last && gate.seen_seq > gate.last_seq)
+      tbb_writer_append(&writer, gate.seen_seq, TBB_CODEC_RAW, TBB_FLAG_HOLD,
+                        (uint32_t)(gate.seen_seq - gate.last_seq), NULL, 0);
+  }
+  fe_destroy(enc);
+  tbb_writer_close(&writer);
+  fprintf(stderr, "%s:%d in %s() → stream %d: %llu records durable in %llu syncs (max %.1f ms), append stall max %.1f ms\n",
+          __FILE__, __LINE__, __func__, stream->id, (unsigned long long)writer.stats.durable,
+          (unsigned long long)writer.stats.syncs, writer.stats.sync_ns_max / 1e6,
+          writer.stats.stall_ns_max / 1e6);
+  if (PERF_STAGE_COUNTERS)
+    perf_stage_report(&perf, stderr);
+  perf_stage_close(&perf);
+  if (!failed)
+    return NULL;
+
+drain:
+  // 녹화를 못 해도 capture 가 막히지 않도록 queue 가 끝날 때까지 block 을 돌려준다
+  fprintf(stderr, "%s:%d in %s() → record stream %d failed: releasing its frames\n", __FILE__,
+          __LINE__, __func__, stream->id);
+  while ((nblocks = dequeue_n(stream->record_q, (void **)blocks, RECORD_BATCH_MAX,
+                              QUEUE_WAIT_FOREVER)) > 0)
+    release_blocks(frame_pool, blocks, nblocks);
   return NULL;
 }
 
-bool record_run(SharedCtx *arg, pthread_t *tid)
+bool record_run(StreamCtx *arg, pthread_t *tid)
 {
   if (pthread_create(tid, NULL, record_thread, (void *)arg) != 0)
   {
@@ -168,3 +323,40 @@ int raw_video_write_frame(int fd, const unsigned char *buffer, size_t frame_size
 
   return 0;
 }
+
+size_t record_change_score(const uint8_t *a, const uint8_t *b, size_t width, size_t height)
+{
+  size_t changed = 0;
+  uint32_t limit = RECORD_CHANGE_MEAN * RECORD_SAMPLE_SEG;
+
+  for (size_t y = RECORD_SAMPLE_ROW_STEP / 2; y < height; y += RECORD_SAMPLE_ROW_STEP)
+  {
+    const uint8_t *ra = a + y * width;
+    const uint8_t *rb = b + y * width;
+    for (size_t x = 0; x + RECORD_SAMPLE_SEG <= width; x += RECORD_SAMPLE_SEG)
+    {
+      // motion 의 SIMD SAD 를 한 행짜리 block 으로 사용
+      if (md_sad_block(ra + x, rb + x, (int)width, RECORD_SAMPLE_SEG, 1) > limit)
+        changed++;
+    }
+  }
+  return changed;
+}
+
+int record_gate_init(RecordGate *gate, size_t width, size_t height)
+{
+  if (!gate || width == 0 || height == 0)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  memset(gate, 0, sizeof(*gate));
+  gate->width = width;
+  gate->height = height;
+  return 0;
+}
+
+void record_gate_reset(RecordGate *gate)
+{
+  gate->have_last = false;
+}
@@ -0,0 +1,242 @@
+/*
+ * @file render.c
+ * @brief Banded multi-threaded framebuffer rendering.
+ */
+#include "render.h"
+
+#include <unistd.h>
+
+// band 의 출력 행 범위 [y0, y1)
+static void band_rows(int fb_h, int nbands, int band, int *y0, int *y1)
+{
+  *y0 = (int)((long)fb_h * band / nbands);
+  *y1 = (int)((long)fb_h * (band + 1) / nbands);
+}
+
+// slot: 사용할 scratch 버퍼 번호 (band 와 동일)
+static int render_rows(BandRenderer *br, int slot, int y0, int y1)
+{
+  if (br->mode == SCALE_NEAREST)
+    return fb_drawGrayRows(br->fb, br->gray, br->raw_w, br->raw_h, y0, y1);
+
+  for (int y = y0; y < y1; y++)
+  {
+    scaler_scale_row(&br->scaler, br->gray, br->raw_w, y, br->line[slot], br->tmp[slot]);
+    fb_putGrayRow(br->fb, y, br->line[slot], br->lut);
+  }
+  return 0;
+}
+
+static int render_band(BandRenderer *br, int band)
+{
+  int y0, y1;
+  band_rows(br->fb->vinfo.yres, br->nthreads, band, &y0, &y1);
+  return render_rows(br, band, y0, y1);
+}
+
+// 필터 스케일링용 계수 테이블과 band 별 scratch 를 현재 geometry 에 맞춘다
+static int prepare_scaler(BandRenderer *br, dev_fb *fb, int raw_w, int raw_h)
+{
+  const int fb_w = fb->vinfo.xres;
+  const int fb_h = fb->vinfo.yres;
+
+  if (fb->vinfo.bits_per_pixel != 32 && fb->vinfo.bits_per_pixel != 16)
+    return -2;
+
+  if (!scaler_matches(&br->scaler, raw_w, raw_h, fb_w, fb_h, br->mode))
+  {
+    scaler_free(&br->scaler);
+    if (scaler_init(&br->scaler, raw_w, raw_h, fb_w, fb_h, br->mode) != 0)
+      return -1;
+  }
+
+  if (br->line_cap < (size_t)fb_w || br->tmp_cap < scaler_tmp_size(&br->scaler))
+  {
+    size_t line_cap = fb_w;
+    size_t tmp_cap = scaler_tmp_size(&br->scaler);
+    for (int i = 0; i < br->nthreads; ++i)
+    {
+      free(br->line[i]);
+      free(br->tmp[i]);
+      br->line[i] = malloc(line_cap);
+      br->tmp[i] = malloc(tmp_cap * sizeof(uint16_t));
+      if (!br->line[i] || !br->tmp[i])
+      {
+        br->line_cap = br->tmp_cap = 0;
+        return -1;
+      }
+    }
+    br->line_cap = line_cap;
+    br->tmp_cap = tmp_cap;
+  }
+
+  fb_buildGrayLut(fb, br->lut);
+  return 0;
+}
+
+static void *band_worker(void *arg)
+{
+  BandWorker *w = (BandWorker *)arg;
+  BandRenderer *br = w->br;
+
+  // 모든 워커가 뜨고 barrier 크기가 확정될 때까지 대기
+  pthread_mutex_lock(&br->mutex);
+  while (!br->ready)
+    pthread_cond_wait(&br->cond, &br->mutex);
+  pthread_mutex_unlock(&br->mutex);
+
+  while (1)
+  {
+    pthread_barrier_wait(&br->start);
+    if (br->quit)
+      break;
+    br->result[w->band] = render_band(br, w->band);
+    pthread_barrier_wait(&br->done);
+  }
+  return NULL;
+}
+
+BandRenderer *br_create(int nthreads, size_t min_pixels)
+{
+  if (nthreads <= 0)
+  {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = (ncpu > 0) ? (int)ncpu : 1;
+  }
+  if (nthreads > RENDER_MAX_THREADS)
+    nthreads = RENDER_MAX_THREADS;
+
+  BandRenderer *br = calloc(1, sizeof(*br));
+  if (!br)
+  {
+    errno = ENOMEM;
+    return NULL;
+  }
+  br->nthreads = nthreads;
+  br->min_pixels = min_pixels;
+  br->quit = false;
+  br->mode = SCALE_NEAREST;
+
+  if (nthreads == 1)
+    return br; // 워커 없이 호출자만 그림
+
+  br->workers = calloc(nthreads - 1, sizeof(BandWorker));
+  if (!br->workers)
+  {
+    free(br);
+    errno = ENOMEM;
+    return NULL;
+  }
+
+  pthread_mutex_init(&br->mutex, NULL);
+  pthread_cond_init(&br->cond, NULL);
+  br->ready = false;
+
+  int started = 0;
+  for (int i = 0; i < nthreads - 1; ++i)
+  {
+    BandWorker *w = &br->workers[i];
+    w->br = br;
+    w->band = i + 1; // band 0 은 호출자 몫
+    if (pthread_create(&w->tid, NULL, band_worker, w) != 0)
+    {
+      perror("pthread_create");
+      break; // 띄운 만큼의 band 로 동작
+    }
+    started++;
+  }
+
+  br->nthreads = started + 1;
+  if (started > 0)
+  {
+    pthread_barrier_init(&br->start, NULL, br->nthreads);
+    pthread_barrier_init(&br->done, NULL, br->nthreads);
+  }
+
+  pthread_mutex_lock(&br->mutex);
+  br->ready = true;
+  pthread_cond_broadcast(&br->cond);
+  pthread_mutex_unlock(&br->mutex);
+
+  if (started == 0)
+  {
+    pthread_mutex_destroy(&br->mutex);
+    pthread_cond_destroy(&br->cond);
+    free(br->workers);
+    br->workers = NULL;
+  }
+  return br;
+}
+
+void br_destroy(BandRenderer *br)
+{
+  if (!br)
+    return;
+  if (br->workers)
+  {
+    br->quit = true;
+    pthread_barrier_wait(&br->start);
+    for (int i = 0; i < br->nthreads - 1; ++i)
+      pthread_join(br->workers[i].tid, NULL);
+    pthread_barrier_destroy(&br->start);
+    pthread_barrier_destroy(&br->done);
+    pthread_mutex_destroy(&br->mutex);
+    pthread_cond_destroy(&br->cond);
+    free(br->workers);
+  }
+  for (int i = 0; i < RENDER_MAX_THREADS; ++i)
+  {
+    free(br->line[i]);
+    free(br->tmp[i]);
+  }
+  scaler_free(&br->scaler);
+  free(br);
+}
+
+int br_draw_gray(BandRenderer *br, dev_fb *fb, const ubyte *gray, int raw_w, int raw_h)
+{
+  if (!fb || !fb->fbp || !gray || raw_w <= 0 || raw_h <= 0)
+    return -1;
+
+  if (!br)
+    return fb_drawGray(fb, gray, raw_w, raw_h);
+
+  if (br->mode != SCALE_NEAREST)
+  {
+    int ret = prepare_scaler(br, fb, raw_w, raw_h);
+    if (ret < 0)
+      return ret;
+  }
+
+  br->fb = fb;
+  br->gray = gray;
+  br->raw_w = raw_w;
+  br->raw_h = raw_h;
+
+  size_t out_pixels = (size_t)fb->vinfo.xres * fb->vinfo.yres;
+  if (br->nthreads <= 1 || out_pixels < br->min_pixels)
+    return render_rows(br, 0, 0, fb->vinfo.yres);
+
+  // barrier 가 job 필드의 메모리 가시성을 보장한다
+  pthread_barrier_wait(&br->start);
+  br->result[0] = render_band(br, 0);
+  pthread_barrier_wait(&br->done);
+
+  for (int i = 0; i < br->nthreads; ++i)
+  {
+    if (br->result[i] < 0)
+      return br->result[i];
+  }
+  return 0;
+}
+
+void br_set_scale_mode(BandRenderer *br, ScaleMode mode)
+{
+  if (br)
+    br->mode = mode;
+}
+
+int br_thread_count(const BandRenderer *br)
+{
+  return br ? br->nthreads : 1;
+}
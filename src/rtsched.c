@@ -0,0 +1,153 @@
+/*
+ * @file rtsched.c
+ * @brief Thread affinity / policy / nice setup and wakeup latency measurement.
+ */
+#define _GNU_SOURCE
+#include "rtsched.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "util.h"
+
+const char *rt_policy_name(int policy)
+{
+  switch (policy)
+  {
+  case SCHED_OTHER:
+    return "SCHED_OTHER";
+  case SCHED_FIFO:
+    return "SCHED_FIFO";
+  case SCHED_RR:
+    return "SCHED_RR";
+  case SCHED_BATCH:
+    return "SCHED_BATCH";
+  case SCHED_IDLE:
+    return "SCHED_IDLE";
+  default:
+    return "SCHED_?";
+  }
+}
+
+int rt_apply(const RtSched *cfg)
+{
+  if (!cfg)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  int err = 0;
+
+  if (cfg->cpus != RT_CPUS_ANY)
+  {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < 64; cpu++)
+      if (cfg->cpus & (1ull << cpu))
+        CPU_SET(cpu, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0 && !err)
+      err = rc;
+  }
+
+  struct sched_param param = {
+      .sched_priority = (cfg->policy == SCHED_FIFO || cfg->policy == SCHED_RR) ? cfg->priority : 0};
+  int rc = pthread_setschedparam(pthread_self(), cfg->policy, &param);
+  if (rc != 0 && !err)
+    err = rc;
+
+  // nice 는 thread 단위 (Linux): tid 로 지정
+  if (cfg->policy == SCHED_OTHER &&
+      setpriority(PRIO_PROCESS, (id_t)gettid(), cfg->nice) < 0 && !err)
+    err = errno;
+
+  if (err)
+  {
+    errno = err;
+    return -1;
+  }
+  return 0;
+}
+
+int rt_measure_latency(int samples, int period_us, RtLatency *out)
+{
+  if (samples <= 0 || period_us <= 0 || !out)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  uint64_t *late = malloc(sizeof(uint64_t) * (size_t)samples);
+  if (!late)
+  {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  // 절대 시각으로 잠들어야 앞선 지연이 다음 측정에 쌓이지 않는다
+  const uint64_t period = (uint64_t)period_us * 1000;
+  uint64_t deadline = now_ns() + period;
+  uint64_t sum = 0;
+  for (int i = 0; i < samples; i++, deadline += period)
+  {
+    struct timespec ts = {.tv_sec = (time_t)(deadline / 1000000000ull),
+                          .tv_nsec = (long)(deadline % 1000000000ull)};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+      ;
+    uint64_t now = now_ns();
+    late[i] = now > deadline ? now - deadline : 0;
+    sum += late[i];
+  }
+
+  qsort(late, (size_t)samples, sizeof(uint64_t), cmp_u64);
+  out->samples = samples;
+  out->avg_us = sum / 1e3 / samples;
+  out->p99_us = late[(samples * 99 + 99) / 100 - 1] / 1e3;
+  out->max_us = late[samples - 1] / 1e3;
+  free(late);
+  return 0;
+}
+
+void rt_thread_setup(const RtSched *cfg, const char *name, int samples, int period_us)
+{
+  char comm[16];
+  snprintf(comm, sizeof(comm), "%s", name);
+  pthread_setname_np(pthread_self(), comm);
+
+  if (rt_apply(cfg) < 0)
+    fprintf(stderr, "%s:%d in %s() → %s: %s priority %d nice %d cpus 0x%llx not fully applied: %s\n",
+            __FILE__, __LINE__, __func__, name, rt_policy_name(cfg->policy), cfg->priority,
+            cfg->nice, (unsigned long long)cfg->cpus, strerror(errno));
+
+  /* Report what is in effect, not what was asked for */
+  int policy = SCHED_OTHER;
+  struct sched_param param = {0};
+  pthread_getschedparam(pthread_self(), &policy, &param);
+  errno = 0;
+  int nice = getpriority(PRIO_PROCESS, (id_t)gettid());
+  cpu_set_t set;
+  unsigned long long mask = 0;
+  if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+    for (int cpu = 0; cpu < 64; cpu++)
+      if (CPU_ISSET(cpu, &set))
+        mask |= 1ull << cpu;
+
+  char lat[128] = "";
+  RtLatency l;
+  if (samples > 0 && rt_measure_latency(samples, period_us, &l) == 0)
+    snprintf(lat, sizeof(lat), ", wakeup latency avg %.1f us, p99 %.1f us, max %.1f us (%d x %d us)",
+             l.avg_us, l.p99_us, l.max_us, l.samples, period_us);
+  fprintf(stderr, "%s:%d in %s() → %s: %s priority %d nice %d cpus 0x%llx%s\n", __FILE__, __LINE__,
+          __func__, name, rt_policy_name(policy), param.sched_priority, nice, mask, lat);
+}
+
+int rt_lock_memory(void)
+{
+  // 이후에 늘어나는 heap/stack 도 (MCL_FUTURE): 녹화 중 page fault 로 멈추지 않는다
+  return mlockall(MCL_CURRENT | MCL_FUTURE);
+}
@@ -0,0 +1,283 @@
+/*
+ * @file scale.c
+ * @brief Fixed-point separable gray scalers.
+ */
+#include "scale.h"
+
+#include <string.h>
+
+static void taps_free(ScaleTaps *t)
+{
+  free(t->start);
+  free(t->len);
+  free(t->coef);
+  t->start = NULL;
+  t->len = NULL;
+  t->coef = NULL;
+  t->max_taps = 0;
+}
+
+static int taps_alloc(ScaleTaps *t, int dst_n, int max_taps)
+{
+  t->max_taps = max_taps;
+  t->start = calloc(dst_n, sizeof(int));
+  t->len = calloc(dst_n, sizeof(int));
+  t->coef = calloc((size_t)dst_n * max_taps, sizeof(uint16_t));
+  if (!t->start || !t->len || !t->coef)
+  {
+    taps_free(t);
+    errno = ENOMEM;
+    return -1;
+  }
+  return 0;
+}
+
+/*
+ * 한 축(가로 또는 세로)의 tap 테이블 생성.
+ * 모든 출력의 계수 합은 정확히 SCALE_COEF_ONE 이 되도록 보정한다
+ * (균일한 영상은 스케일 후에도 값이 변하지 않아야 함).
+ */
+static int taps_build(ScaleTaps *t, int src_n, int dst_n, ScaleMode mode)
+{
+  switch (mode)
+  {
+  case SCALE_NEAREST:
+    if (taps_alloc(t, dst_n, 1) != 0)
+      return -1;
+    for (int i = 0; i < dst_n; ++i)
+    {
+      t->start[i] = (int)((long)i * src_n / dst_n);
+      t->len[i] = 1;
+      t->coef[i] = SCALE_COEF_ONE;
+    }
+    return 0;
+
+  case SCALE_BILINEAR:
+  {
+    int taps = (src_n >= 2) ? 2 : 1;
+    if (taps_alloc(t, dst_n, taps) != 0)
+      return -1;
+    for (int i = 0; i < dst_n; ++i)
+    {
+      uint16_t *c = &t->coef[(size_t)i * taps];
+      t->len[i] = taps;
+      if (taps == 1)
+      {
+        t->start[i] = 0;
+        c[0] = SCALE_COEF_ONE;
+        continue;
+      }
+      // 픽셀 중심 정렬: src = (i + 0.5) * src_n / dst_n - 0.5  (Q8)
+      long pos = ((long)(2 * i + 1) * src_n * SCALE_COEF_ONE) / (2L * dst_n) - SCALE_COEF_ONE / 2;
+      if (pos < 0)
+        pos = 0;
+      int idx = (int)(pos >> SCALE_COEF_BITS);
+      int frac = (int)(pos & (SCALE_COEF_ONE - 1));
+      if (idx >= src_n - 1)
+      {
+        // 오른쪽 끝: 항상 두 tap 을 읽도록 start 를 한 칸 당김
+        idx = src_n - 2;
+        frac = SCALE_COEF_ONE;
+      }
+      t->start[i] = idx;
+      c[0] = (uint16_t)(SCALE_COEF_ONE - frac);
+      c[1] = (uint16_t)frac;
+    }
+    return 0;
+  }
+
+  case SCALE_AREA:
+  {
+    // 출력 i 가 덮는 원본 구간: [i*src_n, (i+1)*src_n) / dst_n
+    int taps = src_n / dst_n + 2;
+    if (taps_alloc(t, dst_n, taps) != 0)
+      return -1;
+    for (int i = 0; i < dst_n; ++i)
+    {
+      uint16_t *c = &t->coef[(size_t)i * taps];
+      long lo = (long)i * src_n;
+      long hi = (long)(i + 1) * src_n;
+      int first = (int)(lo / dst_n);
+      int last = (int)((hi - 1) / dst_n);
+      int n = last - first + 1;
+      int sum = 0;
+      int big = 0;
+
+      for (int k = 0; k < n; ++k)
+      {
+        long a = (long)(first + k) * dst_n;
+        long b = a + dst_n;
+        long overlap = ((hi < b) ? hi : b) - ((lo > a) ? lo : a);
+        c[k] = (uint16_t)((overlap * SCALE_COEF_ONE + src_n / 2) / src_n);
+        sum += c[k];
+        if (c[k] > c[big])
+          big = k;
+      }
+      c[big] = (uint16_t)(c[big] + (SCALE_COEF_ONE - sum));
+      t->start[i] = first;
+      t->len[i] = n;
+    }
+    return 0;
+  }
+  }
+
+  errno = EINVAL;
+  return -1;
+}
+
+int scaler_init(Scaler *sc, int src_w, int src_h, int dst_w, int dst_h, ScaleMode mode)
+{
+  if (!sc || src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  memset(sc, 0, sizeof(*sc));
+  sc->mode = mode;
+  sc->src_w = src_w;
+  sc->src_h = src_h;
+  sc->dst_w = dst_w;
+  sc->dst_h = dst_h;
+
+  if (taps_build(&sc->x, src_w, dst_w, mode) != 0)
+    return -1;
+  if (taps_build(&sc->y, src_h, dst_h, mode) != 0)
+  {
+    taps_free(&sc->x);
+    return -1;
+  }
+  return 0;
+}
+
+void scaler_free(Scaler *sc)
+{
+  if (!sc)
+    return;
+  taps_free(&sc->x);
+  taps_free(&sc->y);
+}
+
+int scaler_matches(const Scaler *sc, int src_w, int src_h, int dst_w, int dst_h, ScaleMode mode)
+{
+  return sc && sc->x.start && sc->mode == mode && sc->src_w == src_w && sc->src_h == src_h &&
+         sc->dst_w == dst_w && sc->dst_h == dst_h;
+}
+
+size_t scaler_tmp_size(const Scaler *sc)
+{
+  return sc ? (size_t)sc->src_w : 0;
+}
+
+// 세로 pass: 기여하는 원본 행들을 Q8 계수로 섞어 16비트 라인 생성 (연속 접근, 벡터화 대상)
+static void vertical_pass(const Scaler *sc, const uint8_t *src, size_t src_stride, int y,
+                          uint16_t *restrict tmp)
+{
+  const int w = sc->src_w;
+  const int n = sc->y.len[y];
+  const uint16_t *c = &sc->y.coef[(size_t)y * sc->y.max_taps];
+  const uint8_t *restrict r = src + (size_t)sc->y.start[y] * src_stride;
+
+  const uint16_t c0 = c[0];
+  for (int i = 0; i < w; ++i)
+    tmp[i] = (uint16_t)(r[i] * c0);
+
+  for (int k = 1; k < n; ++k)
+  {
+    const uint16_t ck = c[k];
+    if (ck == 0)
+      continue;
+    r = src + (size_t)(sc->y.start[y] + k) * src_stride;
+    for (int i = 0; i < w; ++i)
+      tmp[i] = (uint16_t)(tmp[i] + r[i] * ck);
+  }
+}
+
+// 가로 pass: 열 tap 적용 후 Q16 → 8비트 반올림
+static void horizontal_pass(const Scaler *sc, const uint16_t *restrict tmp, uint8_t *restrict out)
+{
+  const int w = sc->dst_w;
+  const int *start = sc->x.start;
+  const uint16_t *coef = sc->x.coef;
+  const uint32_t round = 1u << (2 * SCALE_COEF_BITS - 1);
+
+  // bilinear 만 모든 출력이 정확히 두 tap: AREA 확대는 max_taps 가 2 여도 끝 픽셀이 한 tap
+  if (sc->mode == SCALE_BILINEAR && sc->x.max_taps == 2)
+  {
+    for (int x = 0; x < w; ++x)
+    {
+      const uint16_t *t = tmp + start[x];
+      const uint16_t *c = coef + 2 * x;
+      out[x] = (uint8_t)(((uint32_t)t[0] * c[0] + (uint32_t)t[1] * c[1] + round) >>
+                         (2 * SCALE_COEF_BITS));
+    }
+    return;
+  }
+
+  const int stride = sc->x.max_taps;
+  for (int x = 0; x < w; ++x)
+  {
+    const uint16_t *t = tmp + start[x];
+    const uint16_t *c = coef + (size_t)x * stride;
+    const int n = sc->x.len[x];
+    uint32_t acc = round;
+    for (int k = 0; k < n; ++k)
+      acc += (uint32_t)t[k] * c[k];
+    out[x] = (uint8_t)(acc >> (2 * SCALE_COEF_BITS));
+  }
+}
+
+void scaler_scale_row(const Scaler *sc, const uint8_t *src, size_t src_stride, int y,
+                      uint8_t *out, uint16_t *tmp)
+{
+  if (sc->mode == SCALE_NEAREST)
+  {
+    const uint8_t *row = src + (size_t)sc->y.start[y] * src_stride;
+    const int *start = sc->x.start;
+    for (int x = 0; x < sc->dst_w; ++x)
+      out[x] = row[start[x]];
+    return;
+  }
+
+  vertical_pass(sc, src, src_stride, y, tmp);
+  horizontal_pass(sc, tmp, out);
+}
+
+void scaler_scale_rows(const Scaler *sc, const uint8_t *src, size_t src_stride, uint8_t *dst,
+                       size_t dst_stride, int y_begin, int y_end, uint16_t *tmp)
+{
+  if (y_begin < 0)
+    y_begin = 0;
+  if (y_end > sc->dst_h)
+    y_end = sc->dst_h;
+  for (int y = y_begin; y < y_end; ++y)
+    scaler_scale_row(sc, src, src_stride, y, dst + (size_t)y * dst_stride, tmp);
+}
+
+int scale_gray(const uint8_t *src, int src_w, int src_h, uint8_t *dst, int dst_w, int dst_h,
+               ScaleMode mode)
+{
+  if (!src || !dst)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  Scaler sc;
+  if (scaler_init(&sc, src_w, src_h, dst_w, dst_h, mode) != 0)
+    return -1;
+
+  uint16_t *tmp = malloc(scaler_tmp_size(&sc) * sizeof(uint16_t));
+  if (!tmp)
+  {
+    scaler_free(&sc);
+    errno = ENOMEM;
+    return -1;
+  }
+
+  scaler_scale_rows(&sc, src, src_w, dst, dst_w, 0, dst_h, tmp);
+
+  free(tmp);
+  scaler_free(&sc);
+  return 0;
+}
@@ -0,0 +1,279 @@
+/*
+ * @file synth.c
+ * @brief Synthetic gray video source: gradient, bouncing boxes, noise, timecode.
+ */
+#define _GNU_SOURCE
+#include "synth.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#include "util.h"
+
+// 32-bit 정수 hash (splitmix 계열): seq/row 로부터 noise offset 을 뽑는다
+static uint32_t mix32(uint64_t x)
+{
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ull;
+  x ^= x >> 33;
+  return (uint32_t)x;
+}
+
+// 0 .. len 을 왕복하는 위치 (len <= 0 이면 0)
+static int bounce(uint64_t t, int len)
+{
+  if (len <= 0)
+    return 0;
+  uint64_t p = t % (uint64_t)(2 * len);
+  return (int)(p < (uint64_t)len ? p : 2 * (uint64_t)len - p);
+}
+
+void synth_config_default(SynthConfig *cfg, int width, int height)
+{
+  *cfg = (SynthConfig){
+      .width = width,
+      .height = height,
+      .fps = 30,
+      .motion = 6,
+      .objects = 1,
+      .drift = 0,
+      .noise = 4,
+      .timecode = true,
+      .seed = 1,
+  };
+}
+
+bool synth_is_spec(const char *path)
+{
+  return path && strncmp(path, SYNTH_PREFIX, strlen(SYNTH_PREFIX)) == 0;
+}
+
+int synth_parse(const char *spec, SynthConfig *cfg)
+{
+  if (!spec || !cfg)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  if (synth_is_spec(spec))
+    spec += strlen(SYNTH_PREFIX);
+
+  while (*spec)
+  {
+    char key[16];
+    long value;
+    int used = 0;
+    if (sscanf(spec, "%15[a-z]=%ld%n", key, &value, &used) != 2 || value < 0 ||
+        value > 1 << 16)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+    if (!strcmp(key, "w"))
+      cfg->width = (int)value;
+    else if (!strcmp(key, "h"))
+      cfg->height = (int)value;
+    else if (!strcmp(key, "fps"))
+      cfg->fps = (int)value;
+    else if (!strcmp(key, "motion"))
+      cfg->motion = (int)value;
+    else if (!strcmp(key, "objects"))
+      cfg->objects = (int)value;
+    else if (!strcmp(key, "drift"))
+      cfg->drift = (int)value;
+    else if (!strcmp(key, "noise"))
+      cfg->noise = (int)value;
+    else if (!strcmp(key, "timecode"))
+      cfg->timecode = value != 0;
+    else if (!strcmp(key, "seed"))
+      cfg->seed = (uint32_t)value;
+    else
+    {
+      errno = EINVAL;
+      return -1;
+    }
+    spec += used;
+    if (*spec == ',')
+      spec++;
+    else if (*spec)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+SynthSource *synth_create(const SynthConfig *cfg)
+{
+  if (!cfg || cfg->width <= 0 || cfg->height <= 0 || cfg->fps < 0 || cfg->objects < 0 ||
+      cfg->objects > SYNTH_MAX_OBJECTS || cfg->noise < 0 || cfg->noise > 127)
+  {
+    errno = EINVAL;
+    return NULL;
+  }
+
+  SynthSource *src = calloc(1, sizeof(*src));
+  if (!src)
+  {
+    errno = ENOMEM;
+    return NULL;
+  }
+  src->cfg = *cfg;
+  const int w = cfg->width;
+
+  // 밝기가 0→255→0 으로 도는 삼각파 두 주기: 어느 offset 에서도 한 줄을 memcpy 로
+  src->ramp = malloc((size_t)4 * w);
+  src->noise = malloc(sizeof(int16_t) * ((size_t)w + SYNTH_NOISE_SPAN));
+  if (!src->ramp || !src->noise)
+  {
+    synth_destroy(src);
+    errno = ENOMEM;
+    return NULL;
+  }
+  for (int i = 0; i < 2 * w; i++)
+  {
+    int v = (i < w) ? i * 255 / w : (2 * w - i) * 255 / w;
+    src->ramp[i] = src->ramp[i + 2 * w] = (uint8_t)v;
+  }
+
+  uint64_t state = cfg->seed;
+  int span = 2 * cfg->noise + 1;
+  for (int i = 0; i < w + SYNTH_NOISE_SPAN; i++)
+    src->noise[i] = (int16_t)((int)(mix32(state++) % (uint32_t)span) - cfg->noise);
+
+  for (int k = 0; k < SYNTH_MAX_OBJECTS; k++)
+  {
+    src->phase[k][0] = (int)(mix32(state++) % (uint32_t)(2 * w));
+    src->phase[k][1] = (int)(mix32(state++) % (uint32_t)(2 * cfg->height));
+  }
+  return src;
+}
+
+void synth_destroy(SynthSource *src)
+{
+  if (!src)
+    return;
+  free(src->ramp);
+  free(src->noise);
+  free(src);
+}
+
+// seq 번 frame 의 시각을 박스 위에 흰 글자로
+static void burn_timecode(const SynthSource *src, uint64_t seq, uint8_t *dst)
+{
+  const int w = src->cfg.width, h = src->cfg.height;
+  int fps = src->cfg.fps ? src->cfg.fps : 30;
+  uint64_t sec = seq / (uint64_t)fps;
+  char text[96];
+  snprintf(text, sizeof(text), "%08llu %02llu:%02llu:%02llu.%02llu", (unsigned long long)seq,
+           (unsigned long long)(sec / 3600), (unsigned long long)(sec / 60 % 60),
+           (unsigned long long)(sec % 60), (unsigned long long)(seq % (uint64_t)fps));
+
+  short height = (short)(h / 30 > 12 ? h / 30 : 12);
+  TextRun run;
+  if (text_run_init(&run, glyph_default_atlas(), text, height) < 0)
+    return;
+
+  const int ox = 8, oy = 8, pad = 4;
+  int x1 = ox + run.w + 2 * pad < w ? ox + run.w + 2 * pad : w;
+  int y1 = oy + run.h + 2 * pad < h ? oy + run.h + 2 * pad : h;
+  for (int y = oy; y < y1; y++)
+    memset(dst + (size_t)y * w + ox, 0, (size_t)(x1 > ox ? x1 - ox : 0));
+  for (int i = 0; i < run.nspans; i++)
+  {
+    const GlyphSpan *s = &run.spans[i];
+    int x = ox + pad + s->x, y = oy + pad + s->y, len = s->len;
+    if (y >= h || x >= w)
+      continue;
+    if (x + len > w)
+      len = w - x;
+    memset(dst + (size_t)y * w + x, 255, (size_t)len);
+  }
+  text_run_free(&run);
+}
+
+void synth_render(const SynthSource *src, uint64_t seq, uint8_t *dst)
+{
+  const SynthConfig *cfg = &src->cfg;
+  const int w = cfg->width, h = cfg->height;
+  const uint64_t shift = seq * (uint64_t)cfg->drift;
+
+  /* Background: diagonal gradient, optionally drifting */
+  for (int y = 0; y < h; y++)
+  {
+    size_t off = (size_t)((shift + (uint64_t)y) % (uint64_t)(2 * w));
+    memcpy(dst + (size_t)y * w, src->ramp + off, (size_t)w);
+  }
+
+  /* Bouncing boxes */
+  int bw = w / 8 > 1 ? w / 8 : 1, bh = h / 8 > 1 ? h / 8 : 1;
+  for (int k = 0; k < cfg->objects; k++)
+  {
+    uint64_t t = seq * (uint64_t)cfg->motion;
+    int x0 = bounce(t + (uint64_t)src->phase[k][0], w - bw);
+    int y0 = bounce(t * 3 / 4 + (uint64_t)src->phase[k][1], h - bh);
+    // 밝은 박스와 어두운 박스를 번갈아: 어느 배경 위에서도 대비가 남는다
+    uint8_t level = (uint8_t)((k & 1) ? 12 * k : 255 - 12 * k);
+    for (int y = y0; y < y0 + bh && y < h; y++)
+      memset(dst + (size_t)y * w + x0, level, (size_t)(x0 + bw <= w ? bw : w - x0));
+  }
+
+  /* Noise: the strip read at a per-row, per-frame offset */
+  if (cfg->noise > 0)
+  {
+    for (int y = 0; y < h; y++)
+    {
+      const int16_t *n = src->noise + mix32(seq * 0x10001ull + (uint64_t)y) % SYNTH_NOISE_SPAN;
+      uint8_t *row = dst + (size_t)y * w;
+      for (int x = 0; x < w; x++)
+      {
+        int v = row[x] + n[x];
+        row[x] = (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+      }
+    }
+  }
+
+  if (cfg->timecode)
+    burn_timecode(src, seq, dst);
+}
+
+int synth_read_frame(SynthSource *src, uint8_t *dst, size_t size)
+{
+  if (!src || !dst || size != (size_t)src->cfg.width * src->cfg.height)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  if (src->cfg.fps > 0)
+  {
+    uint64_t period = 1000000000ull / (uint64_t)src->cfg.fps;
+    uint64_t now = now_ns();
+    if (src->start_ns == 0)
+    {
+      src->start_ns = now;
+      src->paced_from = src->seq;
+    }
+    uint64_t deadline = src->start_ns + (src->seq - src->paced_from) * period;
+    if (now > deadline + period)
+    {
+      // 한 frame 넘게 밀렸으면 따라잡으려 몰아 보내지 않고 시계를 다시 맞춘다
+      src->late++;
+      src->start_ns = now;
+      src->paced_from = src->seq;
+    }
+    else if (now < deadline)
+    {
+      struct timespec ts = {.tv_sec = (time_t)(deadline / 1000000000ull),
+                            .tv_nsec = (long)(deadline % 1000000000ull)};
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+    }
+  }
+
+  synth_render(src, src->seq++, dst);
+  return 0;
+}
@@ -1,60 +1,399 @@
 #include "task.h"
 
+#include <time.h>
+#include <unistd.h>
 
-// 1. TaskQueue 초기화
-void task_queue_init(TaskQueue* q) {
-    memset(q, 0,sizeof(TaskQueue));
-    q->front = 0;
-    q->rear = 0;
-    q->count = 0;
-    pthread_mutex_init(&q->mutex, NULL);
-    pthread_cond_init(&q->cond, NULL);
+// 현재 스레드가 속한 worker (worker 스레드가 아니면 NULL)
+static __thread TaskWorker *tls_worker = NULL;
+
+typedef struct
+{
+  RangeFn fn;
+  void *ctx;
+  size_t begin;
+  size_t end;
+} RangeTask;
+
+static int deque_init(TaskDeque *dq)
+{
+  dq->slots = calloc(TP_DEQUE_CAPACITY, sizeof(Task));
+  if (!dq->slots)
+  {
+    errno = ENOMEM;
+    return -1;
+  }
+  dq->top = 0;
+  dq->bottom = 0;
+  pthread_mutex_init(&dq->mutex, NULL);
+  return 0;
+}
+
+static void deque_free(TaskDeque *dq)
+{
+  pthread_mutex_destroy(&dq->mutex);
+  free(dq->slots);
+  dq->slots = NULL;
+}
+
+// owner 쪽(bottom)에 push, 가득 차면 false
+static bool deque_push(TaskDeque *dq, const Task *task)
+{
+  bool ok = false;
+  pthread_mutex_lock(&dq->mutex);
+  if (dq->bottom - dq->top < TP_DEQUE_CAPACITY)
+  {
+    dq->slots[dq->bottom & (TP_DEQUE_CAPACITY - 1)] = *task;
+    dq->bottom++;
+    ok = true;
+  }
+  pthread_mutex_unlock(&dq->mutex);
+  return ok;
+}
+
+// owner 쪽(bottom)에서 pop: 가장 최근에 넣은 작업 (LIFO)
+static bool deque_pop(TaskDeque *dq, Task *out)
+{
+  bool ok = false;
+  pthread_mutex_lock(&dq->mutex);
+  if (dq->bottom != dq->top)
+  {
+    dq->bottom--;
+    *out = dq->slots[dq->bottom & (TP_DEQUE_CAPACITY - 1)];
+    ok = true;
+  }
+  pthread_mutex_unlock(&dq->mutex);
+  return ok;
+}
+
+// thief 쪽(top)에서 steal: 가장 오래된 작업 (FIFO)
+static bool deque_steal(TaskDeque *dq, Task *out)
+{
+  bool ok = false;
+  if (pthread_mutex_trylock(&dq->mutex) != 0)
+    return false; // 경합 중이면 다른 victim 시도
+  if (dq->bottom != dq->top)
+  {
+    *out = dq->slots[dq->top & (TP_DEQUE_CAPACITY - 1)];
+    dq->top++;
+    ok = true;
+  }
+  pthread_mutex_unlock(&dq->mutex);
+  return ok;
+}
+
+static void task_finish(TaskGroup *group)
+{
+  if (!group)
+    return;
+  // mutex 안에서 감소시켜야 waiter 가 0 을 보고 group 을 파괴하는 동안
+  // broadcast 가 끼어드는 일이 없다
+  pthread_mutex_lock(&group->mutex);
+  if (atomic_fetch_sub_explicit(&group->outstanding, 1, memory_order_acq_rel) == 1)
+    pthread_cond_broadcast(&group->cond);
+  pthread_mutex_unlock(&group->mutex);
+}
+
+static void task_execute(Task *task)
+{
+  task->fn(task->arg);
+  task_finish(task->group);
+}
+
+/*
+ * 자신의 deque → 다른 worker deque 순서로 작업 하나를 가져온다.
+ * self == NULL 이면 (외부 스레드) steal 만 시도.
+ */
+static bool find_task(ThreadPool *pool, TaskWorker *self, Task *out)
+{
+  if (self && deque_pop(&self->deque, out))
+    goto found;
+
+  size_t n = pool->nworkers;
+  size_t start;
+  if (self)
+  {
+    self->rng = self->rng * 1103515245u + 12345u;
+    start = (self->rng >> 16) % n;
+  }
+  else
+  {
+    start = atomic_load_explicit(&pool->next, memory_order_relaxed) % n;
+  }
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    TaskWorker *victim = &pool->workers[(start + i) % n];
+    if (victim != self && deque_steal(&victim->deque, out))
+      goto found;
+  }
+  return false;
+
+found:
+  atomic_fetch_sub_explicit(&pool->pending, 1, memory_order_relaxed);
+  return true;
 }
 
-// 2. 작업 추가 (enqueue)
-// main thread (epoll 루프)에서 작업을 넣을 때 호출
-void task_queue_push(TaskQueue* q, Task task) {
-    pthread_mutex_lock(&q->mutex);
+static void *worker_main(void *arg)
+{
+  TaskWorker *self = (TaskWorker *)arg;
+  ThreadPool *pool = self->pool;
+  Task task;
 
-    // 큐가 가득 찼으면 대기 (단순 구현: wait → 버퍼가 비면 signal 받음)
-    while (q->count == TASK_QUEUE_CAPACITY) {
-        pthread_cond_wait(&q->cond, &q->mutex);
+  tls_worker = self;
+
+  while (1)
+  {
+    if (find_task(pool, self, &task))
+    {
+      task_execute(&task);
+      continue;
     }
 
-    q->queue[q->rear] = task;
-    q->rear = (q->rear + 1) % TASK_QUEUE_CAPACITY;
-    q->count++;
+    pthread_mutex_lock(&pool->mutex);
+    while (atomic_load(&pool->pending) == 0 && !pool->done)
+    {
+      pthread_cond_wait(&pool->cond, &pool->mutex);
+    }
+    if (pool->done && atomic_load(&pool->pending) == 0)
+    {
+      pthread_mutex_unlock(&pool->mutex);
+      break;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+  }
 
-    pthread_cond_signal(&q->cond);  // 대기 중인 worker thread 깨움
-    pthread_mutex_unlock(&q->mutex);
+  tls_worker = NULL;
+  return NULL;
 }
 
-// 3. 작업 꺼내기 (dequeue)
-// worker thread가 작업을 받아 처리할 때 호출
-Task task_queue_pop(TaskQueue* q) {
-    pthread_mutex_lock(&q->mutex);
+static void pool_free(ThreadPool *pool)
+{
+  for (size_t i = 0; i < pool->nworkers; ++i)
+  {
+    if (pool->workers[i].deque.slots)
+      deque_free(&pool->workers[i].deque);
+  }
+  pthread_mutex_destroy(&pool->mutex);
+  pthread_cond_destroy(&pool->cond);
+  free(pool->workers);
+  free(pool);
+}
+
+static void pool_stop(ThreadPool *pool, size_t nstarted)
+{
+  pthread_mutex_lock(&pool->mutex);
+  pool->done = true;
+  pthread_cond_broadcast(&pool->cond);
+  pthread_mutex_unlock(&pool->mutex);
+
+  for (size_t i = 0; i < nstarted; ++i)
+    pthread_join(pool->workers[i].tid, NULL);
+}
+
+ThreadPool *tp_create(size_t nworkers)
+{
+  if (nworkers == 0)
+  {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    nworkers = (ncpu > 0) ? (size_t)ncpu : 1;
+  }
+  if (nworkers > TP_MAX_WORKERS)
+    nworkers = TP_MAX_WORKERS;
+
+  ThreadPool *pool = malloc(sizeof(*pool));
+  if (!pool)
+  {
+    errno = ENOMEM;
+    return NULL;
+  }
+
+  pool->workers = calloc(nworkers, sizeof(TaskWorker));
+  if (!pool->workers)
+  {
+    free(pool);
+    errno = ENOMEM;
+    return NULL;
+  }
+
+  pool->nworkers = nworkers;
+  atomic_init(&pool->next, 0);
+  atomic_init(&pool->pending, 0);
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->cond, NULL);
+  pool->done = false;
 
-    // 큐가 비었으면 대기
-    while (q->count == 0 && keep_running) {
-        pthread_cond_wait(&q->cond, &q->mutex);
+  for (size_t i = 0; i < nworkers; ++i)
+  {
+    TaskWorker *w = &pool->workers[i];
+    w->pool = pool;
+    w->id = i;
+    w->rng = (unsigned int)(i * 2654435761u + 1);
+    if (deque_init(&w->deque) != 0)
+    {
+      pool_free(pool);
+      errno = ENOMEM;
+      return NULL;
     }
-    if (!keep_running) {
-        pthread_mutex_unlock(&q->mutex);
+  }
+
+  // deque 가 모두 준비된 뒤에 스레드를 띄워야 steal 시 안전
+  for (size_t i = 0; i < nworkers; ++i)
+  {
+    if (pthread_create(&pool->workers[i].tid, NULL, worker_main, &pool->workers[i]) != 0)
+    {
+      perror("pthread_create");
+      pool_stop(pool, i);
+      pool_free(pool);
+      errno = EAGAIN;
+      return NULL;
     }
+  }
+  return pool;
+}
+
+void tp_destroy(ThreadPool *pool)
+{
+  if (!pool)
+    return;
+  pool_stop(pool, pool->nworkers);
+  pool_free(pool);
+}
+
+int tp_submit(ThreadPool *pool, TaskGroup *group, TaskFn fn, const void *arg, size_t arg_size)
+{
+  if (!pool || !fn || arg_size > TP_TASK_INLINE || (arg_size && !arg))
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  Task task;
+  task.fn = fn;
+  task.group = group;
+  if (arg_size)
+    memcpy(task.arg, arg, arg_size);
+
+  if (group)
+    atomic_fetch_add_explicit(&group->outstanding, 1, memory_order_relaxed);
+
+  TaskWorker *target = tls_worker;
+  if (!target || target->pool != pool)
+  {
+    size_t idx = atomic_fetch_add_explicit(&pool->next, 1, memory_order_relaxed);
+    target = &pool->workers[idx % pool->nworkers];
+  }
+
+  // push 전에 pending 을 올려야 thief 가 먼저 가져가도 음수가 되지 않음
+  atomic_fetch_add_explicit(&pool->pending, 1, memory_order_relaxed);
+  if (!deque_push(&target->deque, &task))
+  {
+    // deque 가 가득 참: 호출자가 직접 실행 (backpressure)
+    atomic_fetch_sub_explicit(&pool->pending, 1, memory_order_relaxed);
+    task_execute(&task);
+    return 0;
+  }
+
+  pthread_mutex_lock(&pool->mutex);
+  pthread_cond_signal(&pool->cond);
+  pthread_mutex_unlock(&pool->mutex);
+  return 0;
+}
+
+static void range_task(void *arg)
+{
+  RangeTask *rt = (RangeTask *)arg;
+  rt->fn(rt->begin, rt->end, rt->ctx);
+}
+
+void tp_parallel_for(ThreadPool *pool, size_t begin, size_t end, size_t grain, RangeFn fn,
+                     void *ctx)
+{
+  if (!fn || end <= begin)
+    return;
+
+  size_t total = end - begin;
+  if (grain == 0)
+  {
+    size_t parts = pool ? pool->nworkers : 1;
+    grain = (total + parts - 1) / parts;
+  }
+  if (!pool || total <= grain)
+  {
+    fn(begin, end, ctx);
+    return;
+  }
 
-    Task task = q->queue[q->front];
-    q->front = (q->front + 1) % TASK_QUEUE_CAPACITY;
-    q->count--;
+  TaskGroup group;
+  tg_init(&group);
 
-    pthread_cond_signal(&q->cond);  // enqueue 대기 중일 수 있음
-    pthread_mutex_unlock(&q->mutex);
+  // 첫 chunk 는 호출자가 직접 처리
+  size_t first_end = begin + grain;
+  for (size_t b = first_end; b < end; b += grain)
+  {
+    RangeTask rt = {.fn = fn, .ctx = ctx, .begin = b, .end = (end - b > grain) ? b + grain : end};
+    tp_submit(pool, &group, range_task, &rt, sizeof(rt));
+  }
+  fn(begin, first_end, ctx);
 
-    return task;
+  tg_wait(pool, &group);
+  tg_destroy(&group);
 }
 
-void task_queue_destroy(TaskQueue* q) {
-    pthread_mutex_destroy(&q->mutex);
-    pthread_cond_destroy(&q->cond);
-    printf( COLOR_GREEN "Mutex 'mutex, cond' has been destroyed." COLOR_RESET);
-    free(q);
-}
\ No newline at end of file
+size_t tp_worker_count(const ThreadPool *pool)
+{
+  return pool ? pool->nworkers : 0;
+}
+
+int tp_current_worker(void)
+{
+  return tls_worker ? (int)tls_worker->id : -1;
+}
+
+void tg_init(TaskGroup *group)
+{
+  atomic_init(&group->outstanding, 0);
+  pthread_mutex_init(&group->mutex, NULL);
+  pthread_cond_init(&group->cond, NULL);
+}
+
+void tg_wait(ThreadPool *pool, TaskGroup *group)
+{
+  Task task;
+  TaskWorker *self = (tls_worker && tls_worker->pool == pool) ? tls_worker : NULL;
+
+  while (atomic_load_explicit(&group->outstanding, memory_order_acquire) > 0)
+  {
+    // 기다리는 동안 놀지 않고 대기 중인 작업을 돕는다
+    if (pool && find_task(pool, self, &task))
+    {
+      task_execute(&task);
+      continue;
+    }
+
+    // 남은 작업은 모두 다른 worker 에서 실행 중: 짧게 대기 후 다시 확인
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += 1000000; // 1ms
+    if (ts.tv_nsec >= 1000000000L)
+    {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000L;
+    }
+    pthread_mutex_lock(&group->mutex);
+    if (atomic_load_explicit(&group->outstanding, memory_order_acquire) > 0)
+      pthread_cond_timedwait(&group->cond, &group->mutex, &ts);
+    pthread_mutex_unlock(&group->mutex);
+  }
+
+  // 마지막 task_finish() 가 mutex 를 놓을 때까지 기다린 뒤 반환
+  pthread_mutex_lock(&group->mutex);
+  pthread_mutex_unlock(&group->mutex);
+}
+
+void tg_destroy(TaskGroup *group)
+{
+  if (!group)
+    return;
+  pthread_mutex_destroy(&group->mutex);
+  pthread_cond_destroy(&group->cond);
+}
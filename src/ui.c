@@ -32,6 +32,7 @@ static void *ui_thread_func(void *arg)
 {
   UiArgs *ui_arg = (UiArgs *)arg;
 
+  rt_thread_setup(&UI_SCHED, "ui", 0, 0); // 키 입력은 지연을 재지 않는다
   while (1)
   {
     char c = 0;
@@ -58,8 +59,12 @@ static void *ui_thread_func(void *arg)
       case '3':
         ui_arg->state = STATE_STOPPED;
         printf("[UI] Restarting: reset...\n");
-        ui_arg->reset_callback(ui_arg->fds[0]);
-        ui_arg->reset_callback(ui_arg->fds[1]);
+        ui_arg->restarts++;
+        for (int i = 0; i < UI_MAX_FDS; ++i)
+        {
+          if (ui_arg->fds[i] >= 0)
+            ui_arg->reset_callback(ui_arg->fds[i]);
+        }
         ui_arg->state = STATE_RUNNING;
         pthread_cond_broadcast(&ui_arg->cond);
         // printf("[UI] Restarted\n");
@@ -111,8 +116,9 @@ UiArgs *ui_init()
     return NULL;
   }
 
-  args->fds[0] = -1;
-  args->fds[1] = -1;
+  for (int i = 0; i < UI_MAX_FDS; ++i)
+    args->fds[i] = -1;
+  args->restarts = 0;
 
   // Initialize the state to STATE_STOPPED
   args->state = STATE_STOPPED;
@@ -0,0 +1,165 @@
+// test/test_codec.c
+// Check 프레임워크를 사용한 codec (XOR delta + RLE) 모듈 단위 테스트
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <check.h>
+#include "codec.h"         // codec API 인터페이스
+
+#define W 64
+#define H 48
+
+// 결정적인 의사 난수 (테스트마다 같은 입력)
+static void fill_noise(uint8_t *buf, size_t n, unsigned seed) {
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245u + 12345u;
+        buf[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+// test_rle_roundtrip:
+// - run 과 literal 이 섞인 입력 (짧은 run, 경계의 run 포함) 이
+//   encode → decode 후 원본과 같아야 하고
+// - 긴 run 은 입력보다 작게 coding 되어야 함.
+START_TEST(test_rle_roundtrip) {
+    uint8_t src[1000], enc[1100], dec[1000];
+    fill_noise(src, sizeof(src), 1);
+    memset(src, 0, 300);                              // 앞쪽 긴 run
+    memset(src + 500, 7, 5);                          // CODEC_MIN_RUN 보다 짧은 run
+    memset(src + 900, 9, 100);                        // 끝까지 이어지는 run
+
+    size_t n = codec_rle_encode(enc, src, sizeof(src));
+    ck_assert_uint_le(n, codec_bound(sizeof(src), 1));
+    ck_assert_uint_lt(n, sizeof(src));                // run 덕분에 줄어야 함
+    ck_assert_int_eq(codec_rle_decode(dec, sizeof(dec), enc, n), 0);
+    ck_assert_mem_eq(dec, src, sizeof(src));
+}
+END_TEST
+
+// test_rle_incompressible:
+// - 반복이 없는 입력도 bound 안에 들어가고 그대로 복원되어야 함.
+START_TEST(test_rle_incompressible) {
+    uint8_t src[257], enc[400], dec[257];
+    for (size_t i = 0; i < sizeof(src); i++)
+        src[i] = (uint8_t)i;
+
+    size_t n = codec_rle_encode(enc, src, sizeof(src));
+    ck_assert_uint_le(n, codec_bound(sizeof(src), 1));
+    ck_assert_int_eq(codec_rle_decode(dec, sizeof(dec), enc, n), 0);
+    ck_assert_mem_eq(dec, src, sizeof(src));
+}
+END_TEST
+
+// test_rle_malformed:
+// - 잘린 stream, 출력 크기를 넘는 run, 남는 바이트는 모두
+//   -1 / errno == EPROTO 로 거부되어야 함.
+START_TEST(test_rle_malformed) {
+    uint8_t src[64], enc[128], dec[64];
+    memset(src, 3, sizeof(src));
+    size_t n = codec_rle_encode(enc, src, sizeof(src));
+
+    errno = 0;
+    ck_assert_int_eq(codec_rle_decode(dec, sizeof(dec), enc, n - 1), -1);   // 잘림
+    ck_assert_int_eq(errno, EPROTO);
+    errno = 0;
+    ck_assert_int_eq(codec_rle_decode(dec, 32, enc, n), -1);                // run 이 넘침
+    ck_assert_int_eq(errno, EPROTO);
+    enc[n] = 0;
+    errno = 0;
+    ck_assert_int_eq(codec_rle_decode(dec, sizeof(dec), enc, n + 1), -1);   // 남는 바이트
+    ck_assert_int_eq(errno, EPROTO);
+}
+END_TEST
+
+// test_frame_key_and_delta:
+// - key frame 은 기준 없이, delta frame 은 이전 frame 을 기준으로
+//   slice 수와 무관하게 원본 그대로 복원되어야 함.
+// - 작은 영역만 바뀐 delta frame 은 key frame 보다 훨씬 작아야 함.
+START_TEST(test_frame_key_and_delta) {
+    size_t bytes = W * H;
+    uint8_t *prev = malloc(bytes), *cur = malloc(bytes), *scratch = malloc(bytes);
+    uint8_t *dec = malloc(bytes), *out = malloc(bytes);
+    size_t cap = codec_bound(bytes, CODEC_MAX_SLICES);
+    uint8_t *payload = malloc(cap);
+
+    fill_noise(prev, bytes, 2);
+    memcpy(cur, prev, bytes);
+    for (int y = 10; y < 20; y++)                     // 10x10 영역만 변경
+        memset(cur + y * W + 30, 0xAA, 10);
+
+    int slices[] = {1, 3, 8, H};
+    for (size_t k = 0; k < sizeof(slices) / sizeof(slices[0]); k++) {
+        ssize_t key = codec_encode_frame(payload, cap, prev, NULL, scratch, W, H, slices[k]);
+        ck_assert_int_gt(key, 0);
+        ck_assert_int_eq(codec_decode_frame(dec, NULL, W, H, payload, key), 0);
+        ck_assert_mem_eq(dec, prev, bytes);
+
+        ssize_t delta = codec_encode_frame(payload, cap, cur, prev, scratch, W, H, slices[k]);
+        ck_assert_int_gt(delta, 0);
+        ck_assert_int_lt(delta * 4, key);
+        ck_assert_int_eq(codec_decode_frame(out, dec, W, H, payload, delta), 0);
+        ck_assert_mem_eq(out, cur, bytes);
+    }
+
+    free(prev); free(cur); free(scratch); free(dec); free(out); free(payload);
+}
+END_TEST
+
+// test_frame_invalid:
+// - 잘못된 slice 수와 부족한 버퍼는 EINVAL / ENOBUFS,
+//   크기가 다른 frame 의 payload 는 EPROTO 로 거부되어야 함.
+START_TEST(test_frame_invalid) {
+    size_t bytes = W * H;
+    uint8_t *frame = calloc(1, bytes), *scratch = malloc(bytes), *dec = malloc(bytes);
+    size_t cap = codec_bound(bytes, 4);
+    uint8_t *payload = malloc(cap);
+
+    errno = 0;
+    ck_assert_int_eq(codec_encode_frame(payload, cap, frame, NULL, scratch, W, H, 0), -1);
+    ck_assert_int_eq(errno, EINVAL);
+    errno = 0;
+    ck_assert_int_eq(codec_encode_frame(payload, cap, frame, NULL, scratch, W, H, CODEC_MAX_SLICES + 1), -1);
+    ck_assert_int_eq(errno, EINVAL);
+    errno = 0;
+    ck_assert_int_eq(codec_encode_frame(payload, 16, frame, NULL, scratch, W, H, 4), -1);
+    ck_assert_int_eq(errno, ENOBUFS);
+
+    ssize_t n = codec_encode_frame(payload, cap, frame, NULL, scratch, W, H, 4);
+    ck_assert_int_gt(n, 0);
+    errno = 0;
+    ck_assert_int_eq(codec_decode_frame(dec, NULL, W, H - 1, payload, n), -1);
+    ck_assert_int_eq(errno, EPROTO);
+    errno = 0;
+    ck_assert_int_eq(codec_decode_frame(dec, NULL, W, H, payload, n - 1), -1);
+    ck_assert_int_eq(errno, EPROTO);
+
+    free(frame); free(scratch); free(dec); free(payload);
+}
+END_TEST
+
+Suite *codec_suite(void) {
+    Suite *s = suite_create("CodecModule");          // 스위트 생성
+    TCase *tc = tcase_create("Core");                // 테스트 케이스 그룹
+
+    // TEST_CASE 등록 순서
+    tcase_add_test(tc, test_rle_roundtrip);
+    tcase_add_test(tc, test_rle_incompressible);
+    tcase_add_test(tc, test_rle_malformed);
+    tcase_add_test(tc, test_frame_key_and_delta);
+    tcase_add_test(tc, test_frame_invalid);
+
+    suite_add_tcase(s, tc);                           // 스위트에 케이스 추가
+    return s;
+}
+
+int main(void) {
+    Suite *s = codec_suite();                         // 스위트 생성 호출
+    SRunner *sr = srunner_create(s);                  // 러너 생성
+    srunner_run_all(sr, CK_NORMAL);                   // 모든 테스트 실행
+
+    int failures = srunner_ntests_failed(sr);         // 실패 테스트 개수
+    srunner_free(sr);                                 // 리소스 해제
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
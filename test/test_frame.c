@@ -8,6 +8,8 @@
 #include <check.h>
 #include "frame.h"         // Frame API 인터페이스
 #include "frame_pool.h"    // FramePool API 인터페이스
+#include "mailbox.h"       // 최신 frame mailbox
+#include <pthread.h>
 
 // ================================
 // Frame 모듈 테스트
@@ -169,6 +171,129 @@ START_TEST(test_pool_counts_and_sizes) {
 }
 END_TEST
 
+// test_pool_limit_and_trim:
+// - limit 은 0 이면 EINVAL, pool 크기를 넘으면 pool 크기로 잘림
+// - peak 는 최근 최대 사용량을 돌려주고 현재 사용량부터 다시 잰다
+// - fp_trim 은 limit 이 쓸 수 있는 free 블록은 남기고 나머지의 page 를 돌려준다 (한 번만)
+START_TEST(test_pool_limit_and_trim) {
+    const size_t width = 256, height = 256; // 64 KB 블록: page 가 온전히 들어간다
+    FramePool *p = frame_pool_create(4, width, height, GRAY);
+    ck_assert_ptr_ne(p, NULL);
+    ck_assert_uint_eq(fp_get_limit(p), 4);
+
+    errno = 0;
+    ck_assert_int_eq(fp_set_limit(p, 0), -1);
+    ck_assert_int_eq(errno, EINVAL);
+    ck_assert_int_eq(fp_set_limit(p, 100), 0);
+    ck_assert_uint_eq(fp_get_limit(p), 4);
+
+    ck_assert_int_eq(fp_set_limit(p, 2), 0);
+    FrameBlock *b1 = fp_alloc(p, 1);
+    FrameBlock *b2 = fp_alloc(p, 1);
+    ck_assert_uint_eq(fp_take_peak(p), 2);
+    fp_release(p, b2);
+    ck_assert_uint_eq(fp_take_peak(p), 2);
+    ck_assert_uint_eq(fp_take_peak(p), 1);
+
+    // limit 2, 사용 1 → free 3 개 중 맨 앞 1 개만 남긴다
+    size_t freed = fp_trim(p);
+    ck_assert_uint_ge(freed, 2 * (width * height - 4096));
+    ck_assert_uint_le(freed, 2 * width * height);
+    ck_assert_uint_eq(fp_trim(p), 0);
+
+    // 올리면 trim 된 블록도 다시 쓸 수 있다 (내용은 0)
+    ck_assert_int_eq(fp_set_limit(p, 4), 0);
+    FrameBlock *more[3];
+    for (int i = 0; i < 3; i++) {
+        more[i] = fp_alloc(p, 1);
+        ck_assert_ptr_ne(more[i], NULL);
+        ((uint8_t *)more[i]->frame.data)[width * height / 2] = 1;
+    }
+    ck_assert_uint_eq(fp_used_count(p), 4);
+    for (int i = 0; i < 3; i++)
+        fp_release(p, more[i]);
+    fp_release(p, b1);
+
+    frame_pool_destroy(p);
+}
+END_TEST
+
+// ================================
+// FrameMailbox 테스트
+// ================================
+
+static void *mailbox_producer(void *arg) {
+    FrameMailbox *mb = arg;
+    for (int i = 0; i < 2000; i++) {
+        FrameBlock *b = fp_alloc(mb->pool, 1);
+        b->frame.seq = (size_t)i;
+        if (mailbox_put(mb, b) < 0)
+            fp_release(mb->pool, b);
+    }
+    mailbox_close(mb);
+    return NULL;
+}
+
+// test_mailbox_latest:
+// - put 이 이전 frame 을 밀어내면 pool 로 돌려주고 superseded 를 센다
+// - take 는 최신 frame 만, 비어 있으면 timeout 후 ETIMEDOUT
+// - close 후 put 은 ECANCELED, 남은 frame 은 가져갈 수 있고 그 뒤로는 ECANCELED
+// - producer/consumer thread: seq 는 늘기만 하고 끝나면 모든 블록이 돌아온다
+START_TEST(test_mailbox_latest) {
+    FramePool *p = frame_pool_create(3, 4, 4, GRAY);
+    FrameMailbox mb;
+    ck_assert_int_eq(mailbox_init(&mb, p), 0);
+
+    FrameBlock *a = fp_alloc(p, 1), *b = fp_alloc(p, 1);
+    ck_assert_int_eq(mailbox_put(&mb, a), 0);
+    ck_assert_int_eq(mailbox_put(&mb, b), 0);
+    ck_assert_uint_eq(fp_used_count(p), 1);
+    ck_assert_uint_eq(mailbox_superseded(&mb), 1);
+    ck_assert_ptr_eq(mailbox_take(&mb, 0), b);
+    errno = 0;
+    ck_assert_ptr_null(mailbox_take(&mb, 0));
+    ck_assert_int_eq(errno, ETIMEDOUT);
+    errno = 0;
+    ck_assert_ptr_null(mailbox_take(&mb, 20));
+    ck_assert_int_eq(errno, ETIMEDOUT);
+
+    ck_assert_int_eq(mailbox_put(&mb, a = fp_alloc(p, 1)), 0);
+    mailbox_close(&mb);
+    errno = 0;
+    ck_assert_int_eq(mailbox_put(&mb, b), -1);
+    ck_assert_int_eq(errno, ECANCELED);
+    ck_assert_ptr_eq(mailbox_take(&mb, MAILBOX_WAIT_FOREVER), a);
+    for (int i = 0; i < 2; i++) {
+        errno = 0;
+        ck_assert_ptr_null(mailbox_take(&mb, MAILBOX_WAIT_FOREVER));
+        ck_assert_int_eq(errno, ECANCELED);
+    }
+    fp_release(p, a);
+    fp_release(p, b);
+    mailbox_destroy(&mb);
+
+    ck_assert_int_eq(mailbox_init(&mb, p), 0);
+    pthread_t tid;
+    pthread_create(&tid, NULL, mailbox_producer, &mb);
+    long last = -1;
+    size_t taken = 0;
+    FrameBlock *f;
+    while ((f = mailbox_take(&mb, MAILBOX_WAIT_FOREVER)) != NULL) {
+        ck_assert_int_gt((long)f->frame.seq, last);
+        last = (long)f->frame.seq;
+        taken++;
+        fp_release(p, f);
+    }
+    ck_assert_int_eq(errno, ECANCELED);
+    pthread_join(tid, NULL);
+    ck_assert_uint_eq(taken + mailbox_superseded(&mb), 2000);
+    mailbox_destroy(&mb);
+    ck_assert_uint_eq(fp_used_count(p), 0);
+
+    frame_pool_destroy(p);
+}
+END_TEST
+
 // ================================
 // 테스트 스위트 및 실행 함수
 // ================================
@@ -184,6 +309,8 @@ Suite *frame_suite(void) {
     tcase_add_test(tc, test_pool_retain_multiple);
     tcase_add_test(tc, test_block_data_ptr);
     tcase_add_test(tc, test_pool_counts_and_sizes);
+    tcase_add_test(tc, test_pool_limit_and_trim);
+    tcase_add_test(tc, test_mailbox_latest);
 
     suite_add_tcase(s, tc);                           // 스위트에 케이스 추가
     return s;
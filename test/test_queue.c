@@ -0,0 +1,243 @@
+// test/test_queue.c
+// Check 프레임워크를 사용한 Queue (blocking / batch API) 모듈 단위 테스트
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <check.h>
+#include "queue.h"         // Queue API 인터페이스
+#include "util.h"          // now_ms
+
+#define ITEMS 10000
+
+// test_batch_fifo:
+// - enqueue_n 은 남은 자리만큼만 넣고 (앞쪽 prefix),
+// - dequeue_n 은 ring 경계를 넘어가도 FIFO 순서를 지켜야 함.
+START_TEST(test_batch_fifo) {
+    Queue *q = queue_init(5);
+    ck_assert_ptr_nonnull(q);
+    void *in[8], *out[8];
+    for (uintptr_t i = 0; i < 8; i++)
+        in[i] = (void *)(i + 1);
+
+    ck_assert_uint_eq(enqueue_n(q, in, 3, 0), 3);
+    ck_assert_uint_eq(dequeue_n(q, out, 2, 0), 2);   // head 이동
+    ck_assert_ptr_eq(out[0], in[0]);
+    ck_assert_ptr_eq(out[1], in[1]);
+
+    ck_assert_uint_eq(enqueue_n(q, in + 3, 5, 0), 4); // 자리 4 개 → wrap
+    ck_assert_int_eq(is_full(q), 1);
+    ck_assert_uint_eq(dequeue_n(q, out, 8, 0), 5);
+    for (int i = 0; i < 5; i++)
+        ck_assert_ptr_eq(out[i], in[i + 2]);
+
+    queue_destroy(q);
+}
+END_TEST
+
+// test_timeout:
+// - 빈 queue 의 dequeue 와 가득 찬 queue 의 enqueue 는 timeout 후
+//   NULL / -1, errno == ETIMEDOUT 으로 돌아와야 함 (0 이면 즉시).
+START_TEST(test_timeout) {
+    Queue *q = queue_init(1);
+    ck_assert_ptr_nonnull(q);
+
+    errno = 0;
+    ck_assert_ptr_null(dequeue_wait(q, 0));
+    ck_assert_int_eq(errno, ETIMEDOUT);
+
+    double t0 = now_ms();
+    errno = 0;
+    ck_assert_ptr_null(dequeue_wait(q, 30));
+    ck_assert_int_eq(errno, ETIMEDOUT);
+    ck_assert(now_ms() - t0 >= 29.0);
+
+    ck_assert_int_eq(enqueue_wait(q, q, 0), 0);
+    errno = 0;
+    ck_assert_int_eq(enqueue_wait(q, q, 10), -1);
+    ck_assert_int_eq(errno, ETIMEDOUT);
+
+    queue_destroy(q);
+}
+END_TEST
+
+// test_limit_and_peak:
+// - limit 을 낮추면 capacity 보다 먼저 가득 참, 올리면 다시 들어감
+// - peak 는 최근 최대 깊이를 돌려주고 현재 깊이부터 다시 잰다
+START_TEST(test_limit_and_peak) {
+    Queue *q = queue_init(8);
+    ck_assert_ptr_nonnull(q);
+
+    errno = 0;
+    ck_assert_int_eq(queue_set_limit(q, 0), -1);
+    ck_assert_int_eq(errno, EINVAL);
+
+    ck_assert_int_eq(queue_set_limit(q, 2), 0);
+    ck_assert_int_eq(enqueue_wait(q, q, 0), 0);
+    ck_assert_int_eq(enqueue_wait(q, q, 0), 0);
+    errno = 0;
+    ck_assert_int_eq(enqueue_wait(q, q, 0), -1);
+    ck_assert_int_eq(errno, ETIMEDOUT);
+
+    ck_assert_int_eq(queue_set_limit(q, 100), 0); // capacity 로 잘림
+    for (int i = 0; i < 6; i++)
+        ck_assert_int_eq(enqueue_wait(q, q, 0), 0);
+    ck_assert_int_eq(enqueue_wait(q, q, 0), -1);
+
+    for (int i = 0; i < 5; i++)
+        ck_assert_ptr_nonnull(dequeue_wait(q, 0));
+    ck_assert_uint_eq(queue_take_peak(q), 8);
+    ck_assert_uint_eq(queue_take_peak(q), 3);
+
+    queue_destroy(q);
+}
+END_TEST
+
+// test_policies:
+// - drop-newest: 가득 차면 바로 EAGAIN, 기존 item 은 그대로
+// - drop-oldest: 가장 오래된 item 을 drop 콜백으로 넘기고 받아들임
+// - latest-only: 쌓인 item 을 모두 내보내고 최신 하나만 남김
+// - 거절/축출은 모두 drop 카운터에 쌓인다
+static int dropped_items[8];
+static int ndropped;
+static void count_drop(void *item, void *ctx) {
+    (void)ctx;
+    dropped_items[ndropped++] = *(int *)item;
+}
+
+START_TEST(test_policies) {
+    int v[6] = {0, 1, 2, 3, 4, 5};
+    Queue *q = queue_init(2);
+    ck_assert_ptr_nonnull(q);
+    ck_assert_int_eq(queue_set_policy(q, QUEUE_DROP_OLDEST, NULL, NULL), -1);
+    ck_assert_int_eq(errno, EINVAL);
+
+    ck_assert_int_eq(queue_set_policy(q, QUEUE_DROP_NEWEST, NULL, NULL), 0);
+    ck_assert_int_eq(enqueue_wait(q, &v[0], QUEUE_WAIT_FOREVER), 0);
+    ck_assert_int_eq(enqueue_wait(q, &v[1], QUEUE_WAIT_FOREVER), 0);
+    errno = 0;
+    ck_assert_int_eq(enqueue_wait(q, &v[2], QUEUE_WAIT_FOREVER), -1);
+    ck_assert_int_eq(errno, EAGAIN);
+    ck_assert_uint_eq(queue_drop_count(q), 1);
+
+    ndropped = 0;
+    ck_assert_int_eq(queue_set_policy(q, QUEUE_DROP_OLDEST, count_drop, NULL), 0);
+    ck_assert_int_eq(enqueue_wait(q, &v[3], QUEUE_WAIT_FOREVER), 0);
+    ck_assert_int_eq(ndropped, 1);
+    ck_assert_int_eq(dropped_items[0], 0);
+    ck_assert_int_eq(*(int *)dequeue_wait(q, 0), 1);
+    ck_assert_int_eq(*(int *)dequeue_wait(q, 0), 3);
+
+    ck_assert_int_eq(queue_set_policy(q, QUEUE_LATEST_ONLY, count_drop, NULL), 0);
+    ck_assert_int_eq(enqueue_wait(q, &v[4], 0), 0);
+    ck_assert_int_eq(enqueue_wait(q, &v[5], 0), 0);
+    ck_assert_int_eq(ndropped, 2);
+    ck_assert_int_eq(dropped_items[1], 4);
+    ck_assert_int_eq(*(int *)dequeue_wait(q, 0), 5);
+    ck_assert_ptr_null(dequeue_wait(q, 0));
+    ck_assert_uint_eq(queue_drop_count(q), 3);
+
+    // done 이후에는 축출 없이 ECANCELED
+    queue_set_done(q);
+    errno = 0;
+    ck_assert_int_eq(enqueue_wait(q, &v[0], 0), -1);
+    ck_assert_int_eq(errno, ECANCELED);
+    ck_assert_int_eq(ndropped, 2);
+
+    queue_destroy(q);
+}
+END_TEST
+
+// test_done:
+// - done 이후 enqueue 는 ECANCELED,
+// - dequeue 는 남은 item 을 먼저 돌려준 뒤 ECANCELED.
+START_TEST(test_done) {
+    Queue *q = queue_init(4);
+    ck_assert_ptr_nonnull(q);
+    int a, b;
+    ck_assert_int_eq(enqueue_wait(q, &a, 0), 0);
+    ck_assert_int_eq(enqueue_wait(q, &b, 0), 0);
+    queue_set_done(q);
+
+    errno = 0;
+    ck_assert_int_eq(enqueue_wait(q, &a, QUEUE_WAIT_FOREVER), -1);
+    ck_assert_int_eq(errno, ECANCELED);
+    ck_assert_ptr_eq(dequeue_wait(q, QUEUE_WAIT_FOREVER), &a);
+    ck_assert_ptr_eq(dequeue_wait(q, QUEUE_WAIT_FOREVER), &b);
+    errno = 0;
+    ck_assert_ptr_null(dequeue_wait(q, QUEUE_WAIT_FOREVER));
+    ck_assert_int_eq(errno, ECANCELED);
+
+    queue_destroy(q);
+}
+END_TEST
+
+static void *producer(void *arg) {
+    Queue *q = arg;
+    void *batch[7];
+    uintptr_t next = 1;
+    while (next <= ITEMS) {
+        size_t n = 0;
+        while (n < 7 && next + n <= ITEMS) {
+            batch[n] = (void *)(next + n);
+            n++;
+        }
+        size_t done = 0;
+        while (done < n)                               // 일부만 들어가면 나머지를 다시
+            done += enqueue_n(q, batch + done, n - done, QUEUE_WAIT_FOREVER);
+        next += n;
+    }
+    queue_set_done(q);
+    return NULL;
+}
+
+// test_threads:
+// - producer 가 7 개씩, consumer 가 최대 5 개씩 옮겨도
+//   모든 item 이 순서대로 한 번씩 도착하고, done 으로 끝나야 함.
+START_TEST(test_threads) {
+    Queue *q = queue_init(16);
+    ck_assert_ptr_nonnull(q);
+    pthread_t tid;
+    ck_assert_int_eq(pthread_create(&tid, NULL, producer, q), 0);
+
+    uintptr_t expect = 1;
+    void *out[5];
+    size_t n;
+    while ((n = dequeue_n(q, out, 5, QUEUE_WAIT_FOREVER)) > 0)
+        for (size_t i = 0; i < n; i++)
+            ck_assert_uint_eq((uintptr_t)out[i], expect++);
+    ck_assert_int_eq(errno, ECANCELED);
+    ck_assert_uint_eq(expect, ITEMS + 1);
+
+    pthread_join(tid, NULL);
+    queue_destroy(q);
+}
+END_TEST
+
+Suite *queue_suite(void) {
+    Suite *s = suite_create("QueueModule");          // 스위트 생성
+    TCase *tc = tcase_create("Core");                // 테스트 케이스 그룹
+
+    // TEST_CASE 등록 순서
+    tcase_add_test(tc, test_batch_fifo);
+    tcase_add_test(tc, test_timeout);
+    tcase_add_test(tc, test_limit_and_peak);
+    tcase_add_test(tc, test_policies);
+    tcase_add_test(tc, test_done);
+    tcase_add_test(tc, test_threads);
+
+    suite_add_tcase(s, tc);                           // 스위트에 케이스 추가
+    return s;
+}
+
+int main(void) {
+    Suite *s = queue_suite();                         // 스위트 생성 호출
+    SRunner *sr = srunner_create(s);                  // 러너 생성
+    srunner_run_all(sr, CK_NORMAL);                   // 모든 테스트 실행
+
+    int failures = srunner_ntests_failed(sr);         // 실패 테스트 개수
+    srunner_free(sr);                                 // 리소스 해제
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
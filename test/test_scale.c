@@ -0,0 +1,84 @@
+// test/test_scale.c
+// Check 프레임워크를 사용한 Scale (nearest / bilinear / area) 모듈 단위 테스트
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <check.h>
+#include "scale.h"         // Scale API 인터페이스
+
+// test_area_upscale:
+// - AREA 확대는 출력 픽셀마다 원본 한 픽셀만 덮으므로 값이 그대로 복제되어야 함
+// - max_taps 가 2 여도 오른쪽 끝 픽셀은 한 tap: scratch 행 밖을 읽지 않아야 함
+//   (ASan 빌드에서 heap-buffer-overflow 로 드러나던 경우)
+START_TEST(test_area_upscale) {
+    const uint8_t src[4] = {10, 60, 110, 250};
+    uint8_t dst[8];
+    ck_assert_int_eq(scale_gray(src, 4, 1, dst, 8, 1, SCALE_AREA), 0);
+    for (int x = 0; x < 8; x++)
+        ck_assert_uint_eq(dst[x], src[x / 2]);
+
+    const int sw = 1920, sh = 1080, dw = 3840, dh = 2160;
+    uint8_t *big = malloc((size_t)sw * sh);
+    uint8_t *out = malloc((size_t)dw * dh);
+    ck_assert_ptr_nonnull(big);
+    ck_assert_ptr_nonnull(out);
+    for (int y = 0; y < sh; y++)
+        for (int x = 0; x < sw; x++)
+            big[(size_t)y * sw + x] = (uint8_t)(x + y);
+    ck_assert_int_eq(scale_gray(big, sw, sh, out, dw, dh, SCALE_AREA), 0);
+    for (int y = 0; y < dh; y += 7)
+    {
+        ck_assert_uint_eq(out[(size_t)y * dw], big[(size_t)(y / 2) * sw]);
+        ck_assert_uint_eq(out[(size_t)y * dw + dw - 1], big[(size_t)(y / 2) * sw + sw - 1]);
+    }
+    free(big);
+    free(out);
+}
+END_TEST
+
+// test_bilinear_edges:
+// - 일정한 영상은 어떤 크기로 바꿔도 일정해야 하고 (계수 합 = 1)
+// - 양 끝 픽셀은 원본 끝 값을 유지해야 함
+START_TEST(test_bilinear_edges) {
+    uint8_t src[5 * 3], dst[13 * 7];
+    memset(src, 77, sizeof(src));
+    ck_assert_int_eq(scale_gray(src, 5, 3, dst, 13, 7, SCALE_BILINEAR), 0);
+    for (size_t i = 0; i < sizeof(dst); i++)
+        ck_assert_uint_eq(dst[i], 77);
+
+    const uint8_t ramp[4] = {0, 80, 160, 240};
+    uint8_t wide[9];
+    ck_assert_int_eq(scale_gray(ramp, 4, 1, wide, 9, 1, SCALE_BILINEAR), 0);
+    ck_assert_uint_eq(wide[0], 0);
+    ck_assert_uint_eq(wide[8], 240);
+    for (int x = 1; x < 9; x++)
+        ck_assert_uint_le(wide[x - 1], wide[x]);
+}
+END_TEST
+
+// ================================
+// 테스트 스위트 및 실행 함수
+// ================================
+Suite *scale_suite(void) {
+    Suite *s = suite_create("ScaleModule");          // 스위트 생성
+    TCase *tc = tcase_create("Core");                // 테스트 케이스 그룹
+
+    // TEST_CASE 등록 순서
+    tcase_add_test(tc, test_area_upscale);
+    tcase_add_test(tc, test_bilinear_edges);
+
+    suite_add_tcase(s, tc);                           // 스위트에 케이스 추가
+    return s;
+}
+
+int main(void) {
+    Suite *s = scale_suite();                         // 스위트 생성 호출
+    SRunner *sr = srunner_create(s);                  // 러너 생성
+    srunner_run_all(sr, CK_NORMAL);                   // 모든 테스트 실행
+
+    int failures = srunner_ntests_failed(sr);         // 실패 테스트 개수
+    srunner_free(sr);                                 // 리소스 해제
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
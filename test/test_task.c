@@ -0,0 +1,213 @@
+// test/test_task.c
+// Check 프레임워크를 사용한 Work-stealing ThreadPool (task) 모듈 단위 테스트
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <check.h>
+#include "task.h"          // ThreadPool / TaskGroup API 인터페이스
+
+#define RANGE_BEGIN 3
+#define RANGE_END   10007
+#define OUTER_TASKS 8
+#define INNER_TASKS 16
+
+// 구간의 각 index 를 방문 횟수로 기록
+static void count_range(size_t begin, size_t end, void *ctx) {
+    atomic_int *hits = ctx;
+    for (size_t i = begin; i < end; i++)
+        atomic_fetch_add(&hits[i], 1);
+}
+
+// test_parallel_for_cover:
+// - worker 수 1~6, grain 0(균등 분할) 과 7 에서 [begin, end) 의 모든 index 를 정확히 한 번 방문
+// - 구간 밖 index 는 건드리지 않아야 함
+START_TEST(test_parallel_for_cover) {
+    static atomic_int hits[RANGE_END + 1];
+    const size_t grains[] = {0, 7};
+    for (size_t nw = 1; nw <= 6; nw++) {
+        ThreadPool *pool = tp_create(nw);
+        ck_assert_ptr_nonnull(pool);
+        ck_assert_uint_eq(tp_worker_count(pool), nw);
+        for (size_t g = 0; g < 2; g++) {
+            for (int i = 0; i <= RANGE_END; i++)
+                atomic_init(&hits[i], 0);
+            tp_parallel_for(pool, RANGE_BEGIN, RANGE_END, grains[g], count_range, hits);
+            for (int i = 0; i <= RANGE_END; i++)
+                ck_assert_int_eq(atomic_load(&hits[i]), i >= RANGE_BEGIN && i < RANGE_END);
+        }
+        tp_destroy(pool);
+    }
+}
+END_TEST
+
+typedef struct {
+    ThreadPool *pool;
+    atomic_int inner_done;   // 끝난 inner task 수
+    atomic_int outer_ok;     // inner 를 모두 join 한 outer task 수
+    atomic_int on_worker;    // worker 스레드에서 실행된 outer task 수
+} NestCtx;
+
+static void inner_task(void *arg) {
+    NestCtx *nc = *(NestCtx **)arg;
+    atomic_fetch_add(&nc->inner_done, 1);
+}
+
+// worker 안에서 다시 submit 하고 join: 대기 중에도 자기 deque 를 처리해야 deadlock 이 없다
+static void outer_task(void *arg) {
+    NestCtx *nc = *(NestCtx **)arg;
+    if (tp_current_worker() >= 0)
+        atomic_fetch_add(&nc->on_worker, 1);
+
+    TaskGroup inner;
+    tg_init(&inner);
+    int before = atomic_load(&nc->inner_done);
+    for (int i = 0; i < INNER_TASKS; i++)
+        tp_submit(nc->pool, &inner, inner_task, &nc, sizeof(nc));
+    tg_wait(nc->pool, &inner);
+    tg_destroy(&inner);
+    if (atomic_load(&nc->inner_done) - before >= INNER_TASKS)
+        atomic_fetch_add(&nc->outer_ok, 1);
+}
+
+// test_nested_groups:
+// - worker 에서 실행되는 task 가 tp_submit + tg_wait 로 하위 group 을 join 해도 끝나야 함
+// - worker 1 개(inner 가 모두 자기 deque 에 쌓임)와 여러 개 모두 확인
+START_TEST(test_nested_groups) {
+    for (size_t nw = 1; nw <= 6; nw += 5) {
+        NestCtx nc = {.pool = tp_create(nw)};
+        ck_assert_ptr_nonnull(nc.pool);
+        NestCtx *p = &nc;
+
+        TaskGroup outer;
+        tg_init(&outer);
+        for (int i = 0; i < OUTER_TASKS; i++)
+            ck_assert_int_eq(tp_submit(nc.pool, &outer, outer_task, &p, sizeof(p)), 0);
+        tg_wait(NULL, &outer);     // 호출자는 돕지 않는다: outer 는 모두 worker 에서 실행
+        tg_destroy(&outer);
+
+        ck_assert_int_eq(atomic_load(&nc.inner_done), OUTER_TASKS * INNER_TASKS);
+        ck_assert_int_eq(atomic_load(&nc.outer_ok), OUTER_TASKS);
+        ck_assert_int_eq(atomic_load(&nc.on_worker), OUTER_TASKS);
+        tp_destroy(nc.pool);
+    }
+}
+END_TEST
+
+typedef struct {
+    atomic_bool started;     // blocker 가 worker 에서 돌기 시작함
+    atomic_bool open;        // blocker 해제
+    atomic_int ran;          // 실행된 count task 수
+    int where;               // overflow task 가 실행된 worker (-1: 호출자)
+    atomic_bool overflow_ran;
+} FullCtx;
+
+static void blocker_task(void *arg) {
+    FullCtx *fc = *(FullCtx **)arg;
+    atomic_store(&fc->started, true);
+    while (!atomic_load(&fc->open))
+        sched_yield();
+}
+
+static void tally_task(void *arg) {
+    FullCtx *fc = *(FullCtx **)arg;
+    atomic_fetch_add(&fc->ran, 1);
+}
+
+static void overflow_task(void *arg) {
+    FullCtx *fc = *(FullCtx **)arg;
+    fc->where = tp_current_worker();
+    atomic_store(&fc->overflow_ran, true);
+}
+
+// test_full_deque_inline:
+// - 유일한 worker 가 막혀 있는 동안 deque 를 TP_DEQUE_CAPACITY 개로 채우면
+//   다음 tp_submit 은 호출자 스레드에서 바로 실행되고 반환되어야 함 (backpressure)
+// - 해제 후에는 밀려 있던 task 가 모두 실행되어야 함
+START_TEST(test_full_deque_inline) {
+    ThreadPool *pool = tp_create(1);
+    ck_assert_ptr_nonnull(pool);
+    FullCtx fc = {.where = -2};
+    FullCtx *p = &fc;
+    TaskGroup group;
+    tg_init(&group);
+
+    ck_assert_int_eq(tp_submit(pool, &group, blocker_task, &p, sizeof(p)), 0);
+    while (!atomic_load(&fc.started))
+        sched_yield();
+
+    for (int i = 0; i < TP_DEQUE_CAPACITY; i++)
+        ck_assert_int_eq(tp_submit(pool, &group, tally_task, &p, sizeof(p)), 0);
+    ck_assert_int_eq(tp_submit(pool, &group, overflow_task, &p, sizeof(p)), 0);
+    ck_assert(atomic_load(&fc.overflow_ran));
+    ck_assert_int_eq(fc.where, -1);
+    ck_assert_int_eq(atomic_load(&fc.ran), 0);
+
+    atomic_store(&fc.open, true);
+    tg_wait(pool, &group);
+    tg_destroy(&group);
+    ck_assert_int_eq(atomic_load(&fc.ran), TP_DEQUE_CAPACITY);
+    tp_destroy(pool);
+}
+END_TEST
+
+typedef struct {
+    pthread_t caller;
+    int calls;
+    int on_caller;
+    size_t begin, end;
+} SerialCtx;
+
+static void serial_range(size_t begin, size_t end, void *ctx) {
+    SerialCtx *sc = ctx;
+    sc->calls++;
+    sc->on_caller += pthread_equal(pthread_self(), sc->caller) != 0;
+    sc->begin = begin;
+    sc->end = end;
+}
+
+// test_parallel_for_no_pool:
+// - pool 이 NULL 이면 grain 과 관계없이 호출자 스레드에서 전체 구간을 한 번에 처리
+START_TEST(test_parallel_for_no_pool) {
+    SerialCtx sc = {.caller = pthread_self()};
+    tp_parallel_for(NULL, 5, 1005, 10, serial_range, &sc);
+    ck_assert_int_eq(sc.calls, 1);
+    ck_assert_int_eq(sc.on_caller, 1);
+    ck_assert_uint_eq(sc.begin, 5);
+    ck_assert_uint_eq(sc.end, 1005);
+
+    // 빈 구간은 호출하지 않음
+    tp_parallel_for(NULL, 7, 7, 0, serial_range, &sc);
+    ck_assert_int_eq(sc.calls, 1);
+}
+END_TEST
+
+// ================================
+// 테스트 스위트 및 실행 함수
+// ================================
+Suite *task_suite(void) {
+    Suite *s = suite_create("TaskModule");           // 스위트 생성
+    TCase *tc = tcase_create("Core");                // 테스트 케이스 그룹
+    tcase_set_timeout(tc, 30);                       // deadlock 은 timeout 으로 실패
+
+    // TEST_CASE 등록 순서
+    tcase_add_test(tc, test_parallel_for_cover);
+    tcase_add_test(tc, test_nested_groups);
+    tcase_add_test(tc, test_full_deque_inline);
+    tcase_add_test(tc, test_parallel_for_no_pool);
+
+    suite_add_tcase(s, tc);                           // 스위트에 케이스 추가
+    return s;
+}
+
+int main(void) {
+    Suite *s = task_suite();                          // 스위트 생성 호출
+    SRunner *sr = srunner_create(s);                  // 러너 생성
+    srunner_run_all(sr, CK_NORMAL);                   // 모든 테스트 실행
+
+    int failures = srunner_ntests_failed(sr);         // 실패 테스트 개수
+    srunner_free(sr);                                 // 리소스 해제
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,334 @@
+/*
+ * @file tbb_verify.c
+ * @brief Check the integrity of a .tbb recording.
+ *
+ * Locates every record through the side index (or, with -s or when the
+ * index is missing or damaged, by walking the record headers), then checks
+ * the records in parallel on the worker pool: frame magic, agreement with
+ * the index entry, bounds against the file size and the CRC-32C of header
+ * and payload. Consecutive bad records are reported as one range.
+ *
+ * usage: tbb_verify [-j threads] [-s] file.tbb
+ * exit:  0 clean, 1 corruption found, 2 usage or I/O error
+ */
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "container.h"
+#include "task.h"
+#include "util.h"
+
+typedef enum
+{
+  REC_OK = 0,
+  REC_BAD_CRC,
+  REC_BAD_HEADER,
+  REC_INDEX_MISMATCH,
+  REC_TRUNCATED,
+} RecStatus;
+
+static const char *status_name[] = {
+    [REC_OK] = "ok",
+    [REC_BAD_CRC] = "crc mismatch",
+    [REC_BAD_HEADER] = "bad frame header",
+    [REC_INDEX_MISMATCH] = "header differs from index",
+    [REC_TRUNCATED] = "truncated",
+};
+
+typedef struct Record
+{
+  uint64_t offset;       // TbbFrameHeader 위치
+  uint64_t seq;          // index (또는 header) 의 seq
+  uint32_t payload_size; // index (또는 header) 의 크기
+  uint32_t crc;          // index 의 crc (scan 이면 header 의 것)
+  uint8_t status;        // RecStatus
+} Record;
+
+typedef struct Verify
+{
+  int fd;
+  uint64_t file_size;
+  bool check_crc;
+  bool from_index;
+  Record *recs;
+  size_t nrecs;
+} Verify;
+
+static ssize_t pread_all(int fd, void *buf, size_t size, uint64_t off)
+{
+  size_t done = 0;
+  while (done < size)
+  {
+    ssize_t n = pread(fd, (uint8_t *)buf + done, size - done, (off_t)(off + done));
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    if (n == 0)
+      break;
+    done += n;
+  }
+  return (ssize_t)done;
+}
+
+static int push_record(Verify *v, size_t *cap, Record r)
+{
+  if (v->nrecs == *cap)
+  {
+    size_t ncap = *cap ? *cap * 2 : 1024;
+    Record *p = realloc(v->recs, ncap * sizeof(*p));
+    if (!p)
+      return -1;
+    v->recs = p;
+    *cap = ncap;
+  }
+  v->recs[v->nrecs++] = r;
+  return 0;
+}
+
+// index 에서 record 목록을 읽는다. index 가 없거나 깨졌으면 -1
+static int load_index(Verify *v, const char *path)
+{
+  char idx_path[4096];
+  if (snprintf(idx_path, sizeof(idx_path), "%s%s", path, TBB_INDEX_SUFFIX) >= (int)sizeof(idx_path))
+    return -1;
+  FILE *f = fopen(idx_path, "rb");
+  if (!f)
+    return -1;
+
+  TbbIndexHeader ih;
+  size_t cap = 0;
+  int ret = -1;
+  if (fread(&ih, sizeof(ih), 1, f) != 1 || ih.magic != TBB_INDEX_MAGIC ||
+      ih.version != TBB_VERSION || ih.entry_size != sizeof(TbbIndexEntry))
+    goto out;
+
+  TbbIndexEntry e;
+  while (fread(&e, sizeof(e), 1, f) == 1)
+  {
+    Record r = {.offset = e.offset, .seq = e.seq, .payload_size = e.payload_size, .crc = e.crc};
+    if (push_record(v, &cap, r) < 0)
+      goto out;
+  }
+  ret = 0;
+out:
+  fclose(f);
+  return ret;
+}
+
+// header 를 따라가며 record 목록을 만든다. 읽을 수 없는 꼬리는 마지막 항목으로 남긴다
+static int scan_records(Verify *v, uint64_t start)
+{
+  size_t cap = 0;
+  uint64_t off = start;
+
+  while (off < v->file_size)
+  {
+    TbbFrameHeader fh;
+    Record r = {.offset = off};
+    ssize_t n = pread_all(v->fd, &fh, sizeof(fh), off);
+    if (n < 0)
+      return -1;
+    if ((size_t)n < sizeof(fh))
+      r.status = REC_TRUNCATED;
+    else if (fh.magic != TBB_FRAME_MAGIC)
+      r.status = REC_BAD_HEADER;
+    if (r.status != REC_OK)
+      return push_record(v, &cap, r); // 이후 record 경계를 알 수 없다
+
+    r.seq = fh.seq;
+    r.payload_size = fh.payload_size;
+    r.crc = fh.crc;
+    if (push_record(v, &cap, r) < 0)
+      return -1;
+    off += sizeof(fh) + fh.payload_size;
+  }
+  return 0;
+}
+
+static void verify_range(size_t begin, size_t end, void *ctx)
+{
+  Verify *v = ctx;
+  uint8_t *buf = NULL;
+  size_t buf_cap = 0;
+
+  for (size_t i = begin; i < end; i++)
+  {
+    Record *r = &v->recs[i];
+    if (r->status != REC_OK)
+      continue;
+
+    TbbFrameHeader fh;
+    if (r->offset + sizeof(fh) > v->file_size ||
+        pread_all(v->fd, &fh, sizeof(fh), r->offset) != (ssize_t)sizeof(fh))
+    {
+      r->status = REC_TRUNCATED;
+      continue;
+    }
+    if (fh.magic != TBB_FRAME_MAGIC)
+    {
+      r->status = REC_BAD_HEADER;
+      continue;
+    }
+    if (v->from_index &&
+        (fh.seq != r->seq || fh.payload_size != r->payload_size || fh.crc != r->crc))
+    {
+      r->status = REC_INDEX_MISMATCH;
+      continue;
+    }
+    if (r->offset + sizeof(fh) + fh.payload_size > v->file_size)
+    {
+      r->status = REC_TRUNCATED;
+      continue;
+    }
+    if (!v->check_crc)
+      continue;
+
+    if (fh.payload_size > buf_cap)
+    {
+      free(buf);
+      buf_cap = fh.payload_size;
+      buf = malloc(buf_cap);
+      if (!buf)
+      {
+        buf_cap = 0;
+        r->status = REC_TRUNCATED;
+        continue;
+      }
+    }
+    if (pread_all(v->fd, buf, fh.payload_size, r->offset + sizeof(fh)) != (ssize_t)fh.payload_size)
+      r->status = REC_TRUNCATED;
+    else if (tbb_record_crc(&fh, buf) != fh.crc)
+      r->status = REC_BAD_CRC;
+  }
+  free(buf);
+}
+
+static size_t report(const Verify *v)
+{
+  size_t bad = 0;
+  for (size_t i = 0; i < v->nrecs;)
+  {
+    uint8_t st = v->recs[i].status;
+    size_t j = i;
+    while (j + 1 < v->nrecs && v->recs[j + 1].status == st)
+      j++;
+    if (st != REC_OK)
+    {
+      printf("records %zu-%zu (seq %llu-%llu, offset %llu): %s\n", i, j,
+             (unsigned long long)v->recs[i].seq, (unsigned long long)v->recs[j].seq,
+             (unsigned long long)v->recs[i].offset, status_name[st]);
+      bad += j - i + 1;
+    }
+    i = j + 1;
+  }
+  return bad;
+}
+
+static void usage(const char *prog)
+{
+  fprintf(stderr, "usage: %s [-j threads] [-s] file.tbb\n"
+                  "  -j N  worker threads (0: online CPUs, default)\n"
+                  "  -s    ignore the index and walk the record headers\n",
+          prog);
+}
+
+int main(int argc, char **argv)
+{
+  int nthreads = 0;
+  bool scan = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "j:sh")) != -1)
+  {
+    switch (opt)
+    {
+    case 'j':
+      nthreads = atoi(optarg);
+      break;
+    case 's':
+      scan = true;
+      break;
+    default:
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (optind != argc - 1)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+  const char *path = argv[optind];
+
+  Verify v = {0};
+  v.fd = open(path, O_RDONLY);
+  struct stat st;
+  if (v.fd < 0 || fstat(v.fd, &st) < 0)
+  {
+    perror(path);
+    return 2;
+  }
+  v.file_size = (uint64_t)st.st_size;
+
+  TbbFileHeader hdr;
+  if (pread_all(v.fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) || hdr.magic != TBB_FILE_MAGIC ||
+      hdr.version != TBB_VERSION || hdr.header_size < sizeof(hdr))
+  {
+    fprintf(stderr, "%s: not a .tbb recording\n", path);
+    return 2;
+  }
+  v.check_crc = (hdr.flags & TBB_FILE_CRC32C) != 0;
+  if (!v.check_crc)
+    printf("%s: recorded without checksums, checking structure only\n", path);
+
+  v.from_index = !scan && load_index(&v, path) == 0;
+  if (!v.from_index)
+  {
+    if (!scan)
+      printf("%s%s: missing or damaged, walking record headers\n", path, TBB_INDEX_SUFFIX);
+    free(v.recs);
+    v.recs = NULL;
+    v.nrecs = 0;
+    if (scan_records(&v, hdr.header_size) < 0)
+    {
+      perror("scan");
+      return 2;
+    }
+  }
+
+  ThreadPool *pool = tp_create(nthreads > 0 ? (size_t)nthreads : 0);
+  if (!pool)
+  {
+    perror("tp_create");
+    return 2;
+  }
+  double t0 = now_ms();
+  tp_parallel_for(pool, 0, v.nrecs, 0, verify_range, &v);
+  double ms = now_ms() - t0;
+  size_t workers = tp_worker_count(pool);
+  tp_destroy(pool);
+
+  size_t bad = report(&v);
+
+  // index 에 없는 record 가 data 끝에 남아 있으면 알린다
+  if (v.from_index && v.nrecs > 0)
+  {
+    const Record *last = &v.recs[v.nrecs - 1];
+    uint64_t end = last->offset + sizeof(TbbFrameHeader) + last->payload_size;
+    if (last->status == REC_OK && end < v.file_size)
+      printf("%llu bytes after the last indexed record (offset %llu) are not covered by the index\n",
+             (unsigned long long)(v.file_size - end), (unsigned long long)end);
+  }
+
+  printf("%s: %zu records, %zu bad, %.1f MB in %.1f ms (%.0f MB/s, %zu threads)\n", path, v.nrecs,
+         bad, v.file_size / 1e6, ms, ms > 0 ? v.file_size / 1e3 / ms : 0.0, workers);
+
+  free(v.recs);
+  close(v.fd);
+  return bad ? 1 : 0;
+}